@@ -0,0 +1,48 @@
+from PYB11Generator import *
+
+@PYB11template("VA")
+class ConformingMesh:
+    """A conforming mesh assembled from independently clipped cells (polygons/polyhedra).
+
+Vertices closer than the welding tolerance are shared, and faces (edges in 2D)
+between neighboring cells are stored once.  The connectivity is stored in
+compressed sparse row form: the entries of item i run from offsets[i] to
+offsets[i + 1].  Each face is oriented outward from its first cell; cellFaces
+lists the faces a cell owns as f and those it does not as ~f (= -f - 1).
+faceCells holds the (first, second) cells of each face, with second = -1 on the
+boundary."""
+
+    PYB11typedefs = """
+    using Vector = typename %(VA)s::VECTOR;
+"""
+
+    #---------------------------------------------------------------------------
+    # Constructors
+    #---------------------------------------------------------------------------
+    def pyinit0(self):
+        "Default constructor"
+
+    #---------------------------------------------------------------------------
+    # Methods
+    #---------------------------------------------------------------------------
+    @PYB11const
+    def numCells(self):
+        "Number of cells"
+        return "size_t"
+
+    @PYB11const
+    def numFaces(self):
+        "Number of faces"
+        return "size_t"
+
+    #---------------------------------------------------------------------------
+    # Attributes
+    #---------------------------------------------------------------------------
+    points = PYB11readwrite()
+    cellVertexOffsets = PYB11readwrite()
+    cellVertices = PYB11readwrite()
+    cellFaceOffsets = PYB11readwrite()
+    cellFaces = PYB11readwrite()
+    faceVertexOffsets = PYB11readwrite()
+    faceVertices = PYB11readwrite()
+    faceCells = PYB11readwrite()
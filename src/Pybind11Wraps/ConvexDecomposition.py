@@ -0,0 +1,35 @@
+from PYB11Generator import *
+
+@PYB11template("VA")
+class ConvexDecomposition:
+    """A (possibly non-convex) polygon/polyhedron broken into convex parts.
+
+Each part is stored as the list of planes bounding it (as used by clipPolygon
+and clipPolyhedron), along with its bounding box.  Build these once with
+convexDecomposition(poly) and reuse them with intersect to cut many targets by
+the same tool shape."""
+
+    PYB11typedefs = """
+    using Vector = typename %(VA)s::VECTOR;
+"""
+
+    #---------------------------------------------------------------------------
+    # Constructors
+    #---------------------------------------------------------------------------
+    def pyinit0(self):
+        "Default constructor"
+
+    #---------------------------------------------------------------------------
+    # Methods
+    #---------------------------------------------------------------------------
+    @PYB11const
+    def size(self):
+        "Number of convex parts"
+        return "size_t"
+
+    #---------------------------------------------------------------------------
+    # Attributes
+    #---------------------------------------------------------------------------
+    parts = PYB11readwrite()
+    xmin = PYB11readwrite()
+    xmax = PYB11readwrite()
@@ -0,0 +1,28 @@
+from PYB11Generator import *
+
+@PYB11template("VA")
+class CutFace:
+    """The face (edge in 2D) created by a clipping plane, as it survives on the
+clipped polyhedron (polygon).
+
+loops holds the vertex index loops of the face in the clipped result: a convex
+cut gives a single loop, while a non-convex cut may give several.  In 2D each
+loop is a single cut edge (pair of vertex indices).  These are returned by
+clipPolygonCutFaces and clipPolyhedronCutFaces, one per clipping plane."""
+
+    PYB11typedefs = """
+    using Vector = typename %(VA)s::VECTOR;
+"""
+
+    #---------------------------------------------------------------------------
+    # Constructors
+    #---------------------------------------------------------------------------
+    def pyinit0(self):
+        "Default constructor"
+
+    #---------------------------------------------------------------------------
+    # Attributes
+    #---------------------------------------------------------------------------
+    loops = PYB11readwrite()
+    area = PYB11readwrite()
+    centroid = PYB11readwrite()
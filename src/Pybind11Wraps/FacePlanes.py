@@ -0,0 +1,49 @@
+from PYB11Generator import *
+
+@PYB11template("VA")
+class FacePlanes:
+    """The face planes (edges in 2D) of a polygon/polyhedron, cached for repeated queries.
+
+Along with the planes (normals pointing inward, as used by clipPolygon and
+clipPolyhedron, and IDs giving the extractFaces index of each face) this holds
+the vertices, faces, face areas, edge directions (3D only), bounding box,
+volume, and convexity of the cell.  Build it once per cell with
+facePlanes(poly) and reuse it with convexOverlap, containsPoints, and
+signedDistances."""
+
+    PYB11typedefs = """
+    using Vector = typename %(VA)s::VECTOR;
+"""
+
+    #---------------------------------------------------------------------------
+    # Constructors
+    #---------------------------------------------------------------------------
+    def pyinit0(self):
+        "Default constructor"
+
+    #---------------------------------------------------------------------------
+    # Methods
+    #---------------------------------------------------------------------------
+    @PYB11const
+    def size(self):
+        "Number of faces"
+        return "size_t"
+
+    @PYB11const
+    def shadow(self, axis="const Vector&"):
+        "Area (length in 2D) of the shadow of the (convex) cell across a unit axis"
+        return "double"
+
+    #---------------------------------------------------------------------------
+    # Attributes
+    #---------------------------------------------------------------------------
+    dimension = PYB11readwrite()
+    points = PYB11readwrite()
+    faces = PYB11readwrite()
+    planes = PYB11readwrite()
+    areas = PYB11readwrite()
+    edges = PYB11readwrite()
+    xmin = PYB11readwrite()
+    xmax = PYB11readwrite()
+    volume = PYB11readwrite()
+    convex = PYB11readwrite()
@@ -13,6 +13,7 @@ PYB11includes = ['"polyclipper2d.hh"',
                  '"polyclipper_vector2d.hh"',
                  '"polyclipper_vector3d.hh"',
                  '"polyclipper_plane.hh"',
+                 '"polyclipper_response.hh"',
                  '"polyclipper_serialize.hh"']
 
 PYB11namespaces = ["PolyClipper"]
@@ -22,6 +23,14 @@ using Polygon = std::vector<PolyClipper::Vertex2d<>>;
 using Polyhedron = std::vector<PolyClipper::Vertex3d<>>;
 using Plane2d = PolyClipper::Plane<PolyClipper::internal::VectorAdapter<PolyClipper::Vector2d>>;
 using Plane3d = PolyClipper::Plane<PolyClipper::internal::VectorAdapter<PolyClipper::Vector3d>>;
+using CutFace2d = PolyClipper::CutFace<PolyClipper::internal::VectorAdapter<PolyClipper::Vector2d>>;
+using CutFace3d = PolyClipper::CutFace<PolyClipper::internal::VectorAdapter<PolyClipper::Vector3d>>;
+using ConvexDecomposition2d = PolyClipper::ConvexDecomposition<PolyClipper::internal::VectorAdapter<PolyClipper::Vector2d>>;
+using ConvexDecomposition3d = PolyClipper::ConvexDecomposition<PolyClipper::internal::VectorAdapter<PolyClipper::Vector3d>>;
+using ConformingMesh2d = PolyClipper::ConformingMesh<PolyClipper::internal::VectorAdapter<PolyClipper::Vector2d>>;
+using ConformingMesh3d = PolyClipper::ConformingMesh<PolyClipper::internal::VectorAdapter<PolyClipper::Vector3d>>;
+using FacePlanes2d = PolyClipper::FacePlanes<PolyClipper::internal::VectorAdapter<PolyClipper::Vector2d>>;
+using FacePlanes3d = PolyClipper::FacePlanes<PolyClipper::internal::VectorAdapter<PolyClipper::Vector3d>>;
 """
 
 #-------------------------------------------------------------------------------
@@ -32,6 +41,11 @@ from Vector3d import *
 from Vertex2d import *
 from Vertex3d import *
 from Plane import *
+from CutFace import *
+from ConvexDecomposition import *
+from ConformingMesh import *
+from FacePlanes import *
+from VolumeResponse import *
 
 #-------------------------------------------------------------------------------
 # Polygon & Polyhedron
@@ -50,6 +64,30 @@ vector_of_char = PYB11_bind_vector("char", opaque=True, local=True)
 Plane2d = PYB11TemplateClass(Plane, template_parameters="internal::VectorAdapter<Vector2d>")
 Plane3d = PYB11TemplateClass(Plane, template_parameters="internal::VectorAdapter<Vector3d>")
 
+#-------------------------------------------------------------------------------
+# CutFace
+#-------------------------------------------------------------------------------
+CutFace2d = PYB11TemplateClass(CutFace, template_parameters="internal::VectorAdapter<Vector2d>")
+CutFace3d = PYB11TemplateClass(CutFace, template_parameters="internal::VectorAdapter<Vector3d>")
+
+#-------------------------------------------------------------------------------
+# ConvexDecomposition
+#-------------------------------------------------------------------------------
+ConvexDecomposition2d = PYB11TemplateClass(ConvexDecomposition, template_parameters="internal::VectorAdapter<Vector2d>")
+ConvexDecomposition3d = PYB11TemplateClass(ConvexDecomposition, template_parameters="internal::VectorAdapter<Vector3d>")
+
+#-------------------------------------------------------------------------------
+# ConformingMesh
+#-------------------------------------------------------------------------------
+ConformingMesh2d = PYB11TemplateClass(ConformingMesh, template_parameters="internal::VectorAdapter<Vector2d>")
+ConformingMesh3d = PYB11TemplateClass(ConformingMesh, template_parameters="internal::VectorAdapter<Vector3d>")
+
+#-------------------------------------------------------------------------------
+# FacePlanes
+#-------------------------------------------------------------------------------
+FacePlanes2d = PYB11TemplateClass(FacePlanes, template_parameters="internal::VectorAdapter<Vector2d>")
+FacePlanes3d = PYB11TemplateClass(FacePlanes, template_parameters="internal::VectorAdapter<Vector3d>")
+
 #-------------------------------------------------------------------------------
 # Polygon methods.
 #-------------------------------------------------------------------------------
@@ -59,6 +97,20 @@ def initializePolygon(poly = "Polygon&",
     "Initialize a PolyClipper::Polygon from vertex positions and vertex neighbors."
     return "void"
 
+def polygonFromHalfspaces(poly = "Polygon&",
+                          planes = "const std::vector<Plane2d>&",
+                          interiorPoint = "const Vector2d&"):
+    """Build the PolyClipper::Polygon bounded by a set of planes, given a point strictly inside all of
+them, by a convex hull of the dual points."""
+    return "void"
+
+@PYB11pycppname("convexHull")
+def convexHullPolygon(poly = "Polygon&",
+                      points = "const std::vector<Vector2d>&"):
+    """Build the convex hull of a set of points as a PolyClipper::Polygon.  Each vertex has its ID set to
+the index of its point."""
+    return "void"
+
 @PYB11cppname("polygon2string<>")
 def polygon2string(poly = "Polygon&"):
     "Return a formatted string representation for a PolyClipper::Polygon."
@@ -75,16 +127,216 @@ def momentsPolygon(poly = "const Polygon&"):
     "Compute the zeroth and first moment of a PolyClipper::Polygon."
     return "py::tuple"
 
+@PYB11implementation("""[](const Polygon& self) {
+                                                  double zerothMoment, totalArea;
+                                                  Vector2d firstMoment;
+                                                  std::vector<double> faceAreas;
+                                                  std::vector<Vector2d> faceCentroids, faceNormals;
+                                                  surfaceMoments(zerothMoment, firstMoment, totalArea, faceAreas, faceCentroids, faceNormals, self);
+                                                  return py::make_tuple(zerothMoment, firstMoment, totalArea, faceAreas, faceCentroids, faceNormals);
+                                                }""")
+@PYB11pycppname("surfaceMoments")
+def surfaceMomentsPolygon(poly = "const Polygon&"):
+    """Compute the moments and perimeter of a PolyClipper::Polygon, with the size, centroid, and outward
+unit normal of each edge:
+  (zeroth, first, total, [edge sizes], [edge centroids], [edge normals])"""
+    return "py::tuple"
+
+@PYB11implementation("""[](const Polygon& self, py::function f, const int degree) {
+                                                  QuadratureBatch batch;
+                                                  const auto rule = simplexQuadratureRule(2, degree);
+                                                  return integrate(self,
+                                                                   [&](const std::vector<double>& x, const std::vector<double>& y, std::vector<double>& values) {
+                                                                     values = f(x, y).cast<std::vector<double>>();
+                                                                   },
+                                                                   rule, batch);
+                                                }""")
+@PYB11pycppname("integrate")
+def integratePolygon(poly = "const Polygon&",
+                     f = "py::function",
+                     degree = ("const int", "2")):
+    """Integrate f over a PolyClipper::Polygon with a triangle rule exact to the given degree.
+f is called once as f([x], [y]) with all the quadrature points, and returns the list of values."""
+    return "double"
+
+@PYB11implementation("""[](const std::vector<Polygon>& polys, py::function f, const int degree) {
+                                                  QuadratureBatch batch;
+                                                  std::vector<double> results;
+                                                  const auto rule = simplexQuadratureRule(2, degree);
+                                                  integrate(results, polys,
+                                                            [&](const std::vector<double>& x, const std::vector<double>& y, std::vector<double>& values) {
+                                                              values = f(x, y).cast<std::vector<double>>();
+                                                            },
+                                                            rule, batch);
+                                                  return results;
+                                                }""")
+@PYB11pycppname("integrate")
+def integratePolygons(polys = "const std::vector<Polygon>&",
+                      f = "py::function",
+                      degree = ("const int", "2")):
+    """Integrate f over each of a list of PolyClipper::Polygons, calling f once for the points of all of them."""
+    return "std::vector<double>"
+
+@PYB11implementation("""[](const Polygon& self) {
+                                                  double zerothMoment;
+                                                  Vector2d firstMoment;
+                                                  rzMoments(zerothMoment, firstMoment, self);
+                                                  return py::make_tuple(zerothMoment, firstMoment);
+                                                }""")
+def rzMoments(poly = "const Polygon&"):
+    """Compute the axisymmetric (RZ) moments of a PolyClipper::Polygon, taking y as the radius:
+(volume of revolution, r weighted centroid)."""
+    return "py::tuple"
+
+@PYB11implementation("""[](const std::vector<Polygon>& polys) {
+                                                  std::vector<double> zerothMoments;
+                                                  std::vector<Vector2d> firstMoments;
+                                                  rzMoments(zerothMoments, firstMoments, polys);
+                                                  return py::make_tuple(zerothMoments, firstMoments);
+                                                }""")
+@PYB11pycppname("rzMoments")
+def rzMomentsBatch(polys = "const std::vector<Polygon>&"):
+    "Compute the RZ moments of a list of PolyClipper::Polygons, returning ([zeroth moments], [first moments])."
+    return "py::tuple"
+
+@PYB11implementation("""[](const Polygon& poly, const std::vector<Plane2d>& planes) {
+                                                  double zerothMoment;
+                                                  Vector2d firstMoment;
+                                                  clippedRZMoments(zerothMoment, firstMoment, poly, planes);
+                                                  return py::make_tuple(zerothMoment, firstMoment);
+                                                }""")
+def clippedRZMoments(poly = "const Polygon&",
+                     planes = "const std::vector<Plane2d>&"):
+    "Clip a copy of a PolyClipper::Polygon by planes, returning just the RZ moments of the result."
+    return "py::tuple"
+
+@PYB11implementation("""[](const Polygon& poly, const std::vector<std::vector<Plane2d>>& planeSets) {
+                                                  std::vector<double> zerothMoments;
+                                                  std::vector<Vector2d> firstMoments;
+                                                  clippedRZMoments(zerothMoments, firstMoments, poly, planeSets);
+                                                  return py::make_tuple(zerothMoments, firstMoments);
+                                                }""")
+@PYB11pycppname("clippedRZMoments")
+def clippedRZMomentsBatch(poly = "const Polygon&",
+                          planeSets = "const std::vector<std::vector<Plane2d>>&"):
+    """Clip a PolyClipper::Polygon by each set of planes, returning the RZ moments of each result as
+([zeroth moments], [first moments])."""
+    return "py::tuple"
+
 def clipPolygon(poly = "Polygon&",
                 planes = "const std::vector<Plane2d>&"):
     "Clip a PolyClipper::Polygon with a collection of planes."
     return "void"
 
+@PYB11implementation("""[](Polygon& poly, const std::vector<Plane2d>& planes) {
+                                                  std::vector<CutFace2d> cutFaces;
+                                                  clipPolygon(poly, planes, cutFaces);
+                                                  return cutFaces;
+                                                }""")
+def clipPolygonCutFaces(poly = "Polygon&",
+                        planes = "const std::vector<Plane2d>&"):
+    """Clip a PolyClipper::Polygon with a collection of planes, returning the edge(s)
+created by each plane as a CutFace2d (one per plane)."""
+    return "std::vector<CutFace2d>"
+
+@PYB11implementation("""[](const Polygon& poly,
+                           const std::vector<Plane2d>& planes,
+                           const double tol) {
+                                                  std::vector<Plane2d> result;
+                                                  std::vector<int> planeMap;
+                                                  simplifyPlanes(result, planeMap, poly, planes, tol);
+                                                  return py::make_tuple(result, planeMap);
+                                                }""")
+@PYB11pycppname("simplifyPlanes")
+def simplifyPlanesPolygon(poly = "const Polygon&",
+                          planes = "const std::vector<Plane2d>&",
+                          tol = "const double"):
+    """Reduce a set of planes for clipping a PolyClipper::Polygon, merging planes coplanar within tol and
+dropping redundant ones.  Returns ([planes], [index of the plane each input plane maps to, or -1])."""
+    return "py::tuple"
+
+@PYB11pycppname("intersectsHalfspaces")
+def intersectsHalfspacesPolygon(poly = "const Polygon&",
+                                planes = "const std::vector<Plane2d>&"):
+    "Check whether clipping a PolyClipper::Polygon by planes would leave a non-zero area."
+    return "bool"
+
+@PYB11pycppname("clipByVertexField")
+def clipByVertexFieldPolygon(poly = "Polygon&",
+                             field = "const std::vector<double>&",
+                             ID = ("const int", "std::numeric_limits<int>::min()")):
+    """Clip a PolyClipper::Polygon by a scalar field sampled at its vertices, keeping the region
+where the field (linearly interpolated along the edges) is positive."""
+    return "void"
+
+@PYB11implementation("""[](std::vector<Polygon> cells,
+                           std::vector<std::vector<int>> cellVertices,
+                           std::vector<Vector2d> points,
+                           const Plane2d& plane) {
+                                                  clipMesh(cells, cellVertices, points, plane);
+                                                  return py::make_tuple(cells, cellVertices, points);
+                                                }""")
+@PYB11pycppname("clipMesh")
+def clipMeshPolygon(cells = "std::vector<Polygon>",
+                    cellVertices = "std::vector<std::vector<int>>",
+                    points = "std::vector<Vector2d>",
+                    plane = "const Plane2d&"):
+    """Clip every cell of a mesh (cells, with the global IDs of their vertices in cellVertices indexing
+points) by a plane, intersecting each crossing edge once.  Returns the conforming
+(cells, cellVertices, points), with the new points appended."""
+    return "py::tuple"
+
+@PYB11implementation("""[](const std::vector<Polygon>& cells,
+                           const double tol) {
+                                                  ConformingMesh2d result;
+                                                  assembleMesh(result, cells, tol);
+                                                  return result;
+                                                }""")
+@PYB11pycppname("assembleMesh")
+def assembleMeshPolygon(cells = "const std::vector<Polygon>&",
+                        tol = "const double"):
+    """Assemble a conforming mesh from independently clipped Polygons, welding vertices closer than tol
+and sharing the edges between neighboring cells.  Returns a ConformingMesh2d."""
+    return "ConformingMesh2d"
+
+@PYB11implementation("""[](std::vector<Polygon> polys,
+                           const double tol) {
+                                                  std::vector<std::vector<int>> vertexClasses;
+                                                  weldVertices(polys, tol, vertexClasses);
+                                                  return py::make_tuple(polys, vertexClasses);
+                                                }""")
+@PYB11pycppname("weldVertices")
+def weldVerticesPolygon(polys = "std::vector<Polygon>",
+                        tol = "const double"):
+    """Weld the vertices of a set of Polygons closer than tol, snapping each to the first vertex of its
+class.  Returns the welded ([Polygons], [vertex classes])."""
+    return "py::tuple"
+
+@PYB11implementation("""[](Polygon& poly,
+                           const double tol) {
+                                                  std::vector<int> vertexMap;
+                                                  collapseDegenerates(poly, tol, vertexMap);
+                                                  return vertexMap;
+                                                }""")
 @PYB11pycppname("collapseDegenerates")
 def collapseDegeneratesPolygon(poly = "Polygon&",
                                tol = "const double"):
-    "Collapse edges in a PolyClipper::Polygon below the given tolerance."
-    return "void"
+    """Collapse edges in a PolyClipper::Polygon below the given tolerance, returning the vertex
+of the result each input vertex was merged into (-1 if removed)."""
+    return "std::vector<int>"
+
+@PYB11implementation("""[](const Polygon& self) {
+                                                  std::vector<Polygon> components;
+                                                  std::vector<double> zerothMoments;
+                                                  std::vector<Vector2d> firstMoments;
+                                                  splitComponents(components, zerothMoments, firstMoments, self);
+                                                  return py::make_tuple(components, zerothMoments, firstMoments);
+                                                }""")
+@PYB11pycppname("splitComponents")
+def splitComponentsPolygon(poly = "const Polygon&"):
+    """Split a PolyClipper::Polygon into its connected components, returning
+([Polygons], [zeroth moments], [first moments])."""
+    return "py::tuple"
 
 def extractFaces(poly = "const Polygon&"):
     "Compute the faces (as pairs of vertex indices) for the Polygon"
@@ -102,6 +354,229 @@ The result is returned as a vector<vector<int>>, where each inner vector is a tr
 ints representing vertex indices in the input Polygon."""
     return "std::vector<std::vector<int>>"
 
+@PYB11pycppname("findPlaneForVolumeFraction")
+def findPlaneForVolumeFractionPolygon(poly = "const Polygon&",
+                                      normal = "const Vector2d&",
+                                      fraction = "const double"):
+    """Find the plane distance such that clipping the Polygon by Plane2d(dist, normal)
+retains the given fraction of the area."""
+    return "double"
+
+@PYB11implementation("""[](const Polygon& poly, const std::vector<Plane2d>& planes) {
+                                                  double zerothMoment;
+                                                  Vector2d firstMoment;
+                                                  std::vector<double> dzeroth_ddist, dfirst_dnormal;
+                                                  std::vector<Vector2d> dzeroth_dnormal, dfirst_ddist;
+                                                  clippedMomentsWithGradient(zerothMoment, firstMoment,
+                                                                             dzeroth_ddist, dzeroth_dnormal,
+                                                                             dfirst_ddist, dfirst_dnormal,
+                                                                             poly, planes);
+                                                  return py::make_tuple(zerothMoment, firstMoment,
+                                                                        dzeroth_ddist, dzeroth_dnormal,
+                                                                        dfirst_ddist, dfirst_dnormal);
+                                                }""")
+@PYB11pycppname("clippedMomentsWithGradient")
+def clippedMomentsWithGradientPolygon(poly = "const Polygon&",
+                                    planes = "const std::vector<Plane2d>&"):
+    """Clip a copy of a PolyClipper::Polygon by planes, returning the moments of the result and their
+derivatives with respect to each plane's distance and normal:
+  (zeroth, first, dzeroth_ddist, dzeroth_dnormal, dfirst_ddist, dfirst_dnormal)"""
+    return "py::tuple"
+
+@PYB11implementation("""[](const Polygon& poly, const Plane2d& plane) {
+                                                  Polygon above(poly), below;
+                                                  splitPolygon(above, below, plane);
+                                                  return py::make_tuple(above, below);
+                                                }""")
+def splitPolygon(poly = "const Polygon&",
+                 plane = "const Plane2d&"):
+    "Split a PolyClipper::Polygon by a plane, returning the (above, below) pieces."
+    return "py::tuple"
+
+@PYB11implementation("""[](const Polygon& poly,
+                           const std::vector<int>& order,
+                           const std::vector<Vector2d>& normals,
+                           const std::vector<double>& fractions) {
+                                                  std::vector<Polygon> result;
+                                                  nestedDissection(result, poly, order, normals, fractions);
+                                                  return result;
+                                                }""")
+@PYB11pycppname("nestedDissection")
+def nestedDissectionPolygon(poly = "const Polygon&",
+                          order = "const std::vector<int>&",
+                          normals = "const std::vector<Vector2d>&",
+                          fractions = "const std::vector<double>&"):
+    """Onion-skin reconstruction of a multi-material PolyClipper::Polygon.
+Materials are peeled off in the given order, and the result is a list with the Polygon
+of each material (indexed by material)."""
+    return "std::vector<Polygon>"
+
+@PYB11implementation("""[](const Polygon& poly,
+                           const std::vector<int>& order,
+                           const std::vector<Vector2d>& normals,
+                           const std::vector<double>& fractions) {
+                                                  std::vector<double> zerothMoments;
+                                                  std::vector<Vector2d> firstMoments;
+                                                  nestedDissectionMoments(zerothMoments, firstMoments, poly, order, normals, fractions);
+                                                  return py::make_tuple(zerothMoments, firstMoments);
+                                                }""")
+@PYB11pycppname("nestedDissectionMoments")
+def nestedDissectionMomentsPolygon(poly = "const Polygon&",
+                                 order = "const std::vector<int>&",
+                                 normals = "const std::vector<Vector2d>&",
+                                 fractions = "const std::vector<double>&"):
+    "Moments only version of nestedDissection, returning ([zeroth moments], [first moments])."
+    return "py::tuple"
+
+@PYB11implementation("""[](const Polygon& poly,
+                           const std::vector<Plane2d>& planes) {
+                                                  std::vector<Polygon> result;
+                                                  subtractConvex(result, poly, planes);
+                                                  return result;
+                                                }""")
+@PYB11pycppname("subtractConvex")
+def subtractConvexPolygon(poly = "const Polygon&",
+                        planes = "const std::vector<Plane2d>&"):
+    """Subtract the convex region above all the planes from a PolyClipper::Polygon, returning the
+disjoint pieces outside it: piece k lies below plane k and above planes 0..k-1."""
+    return "std::vector<Polygon>"
+
+@PYB11implementation("""[](const Polygon& poly,
+                           const std::vector<Plane2d>& planes) {
+                                                  std::vector<double> zerothMoments;
+                                                  std::vector<Vector2d> firstMoments;
+                                                  subtractConvexMoments(zerothMoments, firstMoments, poly, planes);
+                                                  return py::make_tuple(zerothMoments, firstMoments);
+                                                }""")
+@PYB11pycppname("subtractConvexMoments")
+def subtractConvexMomentsPolygon(poly = "const Polygon&",
+                               planes = "const std::vector<Plane2d>&"):
+    "Moments only version of subtractConvex, returning ([zeroth moments], [first moments])."
+    return "py::tuple"
+
+@PYB11implementation("""[](const Polygon& poly) {
+                                                  ConvexDecomposition2d result;
+                                                  convexDecomposition(result, poly);
+                                                  return result;
+                                                }""")
+@PYB11pycppname("convexDecomposition")
+def convexDecompositionPolygon(poly = "const Polygon&"):
+    "Break a (possibly non-convex) PolyClipper::Polygon into convex parts, returning a ConvexDecomposition2d."
+    return "ConvexDecomposition2d"
+
+@PYB11implementation("""[](const Polygon& poly,
+                           const ConvexDecomposition2d& tool) {
+                                                  std::vector<Polygon> result;
+                                                  intersect(result, poly, tool);
+                                                  return result;
+                                                }""")
+@PYB11pycppname("intersect")
+def intersectPolygon(poly = "const Polygon&",
+                     tool = "const ConvexDecomposition2d&"):
+    """Intersect a PolyClipper::Polygon with a (possibly non-convex) tool given by its convex decomposition,
+returning the disjoint pieces of the intersection."""
+    return "std::vector<Polygon>"
+
+@PYB11implementation("""[](const Polygon& poly,
+                           const Polygon& tool) {
+                                                  std::vector<Polygon> result;
+                                                  intersect(result, poly, tool);
+                                                  return result;
+                                                }""")
+@PYB11pycppname("intersect")
+def intersectPolygons(poly = "const Polygon&",
+                      tool = "const Polygon&"):
+    "Intersect two (possibly non-convex) PolyClipper::Polygons, returning the disjoint pieces of the intersection."
+    return "std::vector<Polygon>"
+
+@PYB11implementation("""[](const Polygon& poly,
+                           const ConvexDecomposition2d& tool) {
+                                                  double zerothMoment;
+                                                  Vector2d firstMoment;
+                                                  intersectMoments(zerothMoment, firstMoment, poly, tool);
+                                                  return py::make_tuple(zerothMoment, firstMoment);
+                                                }""")
+@PYB11pycppname("intersectMoments")
+def intersectMomentsPolygon(poly = "const Polygon&",
+                            tool = "const ConvexDecomposition2d&"):
+    "Moments only version of intersect, returning (zeroth moment, first moment) summed over the pieces."
+    return "py::tuple"
+
+@PYB11implementation("""[](const Polygon& poly) {
+                                                  FacePlanes2d result;
+                                                  facePlanes(result, poly);
+                                                  return result;
+                                                }""")
+@PYB11pycppname("facePlanes")
+def facePlanesPolygon(poly = "const Polygon&"):
+    "Cache the face planes of a PolyClipper::Polygon, returning a FacePlanes2d."
+    return "FacePlanes2d"
+
+@PYB11implementation("""[](const FacePlanes2d& a,
+                           const FacePlanes2d& b) {
+                                                  double volumeBound;
+                                                  const auto result = convexOverlap(volumeBound, a, b);
+                                                  return py::make_tuple(result, volumeBound);
+                                                }""")
+@PYB11pycppname("convexOverlap")
+def convexOverlapPolygon(a = "const FacePlanes2d&",
+                         b = "const FacePlanes2d&"):
+    """Test two convex cells (given by their FacePlanes2d) for overlap by separating axes,
+returning (overlap, upper bound on the area of the intersection)."""
+    return "py::tuple"
+
+@PYB11implementation("""[](const FacePlanes2d& cell,
+                           const std::vector<double>& x,
+                           const std::vector<double>& y) {
+                                                  std::vector<int> result;
+                                                  containsPoints(result, cell, x, y, std::vector<double>());
+                                                  return result;
+                                                }""")
+@PYB11pycppname("containsPoints")
+def containsPointsPolygon(cell = "const FacePlanes2d&",
+                          x = "const std::vector<double>&",
+                          y = "const std::vector<double>&"):
+    "Check whether each of a batch of points (x, y) lies in a cell (given by its FacePlanes2d), returning 1 or 0 per point."
+    return "std::vector<int>"
+
+@PYB11implementation("""[](const FacePlanes2d& cell,
+                           const std::vector<double>& x,
+                           const std::vector<double>& y) {
+                                                  std::vector<double> result;
+                                                  signedDistances(result, cell, x, y, std::vector<double>());
+                                                  return result;
+                                                }""")
+@PYB11pycppname("signedDistances")
+def signedDistancesPolygon(cell = "const FacePlanes2d&",
+                           x = "const std::vector<double>&",
+                           y = "const std::vector<double>&"):
+    """Compute the signed distance (positive inside) of each of a batch of points (x, y) to the boundary of a cell
+(given by its FacePlanes2d)."""
+    return "std::vector<double>"
+
+@PYB11pycppname("volumeResponse")
+def volumeResponsePolygon(poly = "const Polygon&",
+                        normal = "const Vector2d&"):
+    "Build the VolumeResponse of a PolyClipper::Polygon for clipping planes with the given normal."
+    return "VolumeResponse"
+
+@PYB11implementation("""[](const Polygon& poly,
+                           const std::vector<Vector2d>& displacements,
+                           const std::vector<std::vector<Plane2d>>& donors) {
+                                                  std::vector<double> zerothMoments;
+                                                  std::vector<Vector2d> firstMoments;
+                                                  fluxVolumes(zerothMoments, firstMoments, poly, displacements, donors);
+                                                  return py::make_tuple(zerothMoments, firstMoments);
+                                                }""")
+@PYB11pycppname("fluxVolumes")
+def fluxVolumesPolygon(poly = "const Polygon&",
+                       displacements = "const std::vector<Vector2d>&",
+                       donors = "const std::vector<std::vector<Plane2d>>&"):
+    """Compute the signed areas swept by each edge of a PolyClipper::Polygon moving with the vertex
+displacements, intersected with each donor cell (given as a set of planes).
+Returns ([zeroth moments], [first moments]) indexed by [edge*len(donors) + donor]."""
+    return "py::tuple"
+
 #-------------------------------------------------------------------------------
 # Polyhedron methods.
 #-------------------------------------------------------------------------------
@@ -111,6 +586,20 @@ def initializePolyhedron(poly = "Polyhedron&",
     "Initialize a PolyClipper::Polyhedron from vertex positions and vertex neighbors."
     return "void"
 
+def polyhedronFromHalfspaces(poly = "Polyhedron&",
+                             planes = "const std::vector<Plane3d>&",
+                             interiorPoint = "const Vector3d&"):
+    """Build the PolyClipper::Polyhedron bounded by a set of planes, given a point strictly inside all of
+them, by a convex hull of the dual points."""
+    return "void"
+
+@PYB11pycppname("convexHull")
+def convexHullPolyhedron(poly = "Polyhedron&",
+                         points = "const std::vector<Vector3d>&"):
+    """Build the convex hull of a set of points as a PolyClipper::Polyhedron.  Each vertex has its ID set to
+the index of its point."""
+    return "void"
+
 @PYB11cppname("polyhedron2string<>")
 def polyhedron2string(poly = "Polyhedron&"):
     "Return a formatted string representation for a PolyClipper::Polyhedron."
@@ -127,16 +616,170 @@ def momentsPolyhedron(poly = "const Polyhedron&"):
     "Compute the zeroth and first moment of a PolyClipper::Polyhedron."
     return "py::tuple"
 
+@PYB11implementation("""[](const Polyhedron& self) {
+                                                     double zerothMoment, totalArea;
+                                                     Vector3d firstMoment;
+                                                     std::vector<double> faceAreas;
+                                                     std::vector<Vector3d> faceCentroids, faceNormals;
+                                                     surfaceMoments(zerothMoment, firstMoment, totalArea, faceAreas, faceCentroids, faceNormals, self);
+                                                     return py::make_tuple(zerothMoment, firstMoment, totalArea, faceAreas, faceCentroids, faceNormals);
+                                                   }""")
+@PYB11pycppname("surfaceMoments")
+def surfaceMomentsPolyhedron(poly = "const Polyhedron&"):
+    """Compute the moments and surface area of a PolyClipper::Polyhedron, with the size, centroid, and outward
+unit normal of each face:
+  (zeroth, first, total, [face sizes], [face centroids], [face normals])"""
+    return "py::tuple"
+
+@PYB11implementation("""[](const Polyhedron& self, py::function f, const int degree) {
+                                                     QuadratureBatch batch;
+                                                     const auto rule = simplexQuadratureRule(3, degree);
+                                                     return integrate(self,
+                                                                      [&](const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& z, std::vector<double>& values) {
+                                                                        values = f(x, y, z).cast<std::vector<double>>();
+                                                                      },
+                                                                      rule, batch);
+                                                   }""")
+@PYB11pycppname("integrate")
+def integratePolyhedron(poly = "const Polyhedron&",
+                        f = "py::function",
+                        degree = ("const int", "2")):
+    """Integrate f over a PolyClipper::Polyhedron with a tetrahedron rule exact to the given degree.
+f is called once as f([x], [y], [z]) with all the quadrature points, and returns the list of values."""
+    return "double"
+
+@PYB11implementation("""[](const std::vector<Polyhedron>& polys, py::function f, const int degree) {
+                                                     QuadratureBatch batch;
+                                                     std::vector<double> results;
+                                                     const auto rule = simplexQuadratureRule(3, degree);
+                                                     integrate(results, polys,
+                                                               [&](const std::vector<double>& x, const std::vector<double>& y, const std::vector<double>& z, std::vector<double>& values) {
+                                                                 values = f(x, y, z).cast<std::vector<double>>();
+                                                               },
+                                                               rule, batch);
+                                                     return results;
+                                                   }""")
+@PYB11pycppname("integrate")
+def integratePolyhedra(polys = "const std::vector<Polyhedron>&",
+                       f = "py::function",
+                       degree = ("const int", "2")):
+    """Integrate f over each of a list of PolyClipper::Polyhedra, calling f once for the points of all of them."""
+    return "std::vector<double>"
+
 def clipPolyhedron(poly = "Polyhedron&",
                    planes = "const std::vector<Plane3d>&"):
     "Clip a PolyClipper::Polyhedron with a collection of planes."
     return "void"
 
+@PYB11implementation("""[](Polyhedron& poly, const std::vector<Plane3d>& planes) {
+                                                     std::vector<CutFace3d> cutFaces;
+                                                     clipPolyhedron(poly, planes, cutFaces);
+                                                     return cutFaces;
+                                                   }""")
+def clipPolyhedronCutFaces(poly = "Polyhedron&",
+                           planes = "const std::vector<Plane3d>&"):
+    """Clip a PolyClipper::Polyhedron with a collection of planes, returning the face
+created by each plane as a CutFace3d (one per plane)."""
+    return "std::vector<CutFace3d>"
+
+@PYB11implementation("""[](const Polyhedron& poly,
+                           const std::vector<Plane3d>& planes,
+                           const double tol) {
+                                                  std::vector<Plane3d> result;
+                                                  std::vector<int> planeMap;
+                                                  simplifyPlanes(result, planeMap, poly, planes, tol);
+                                                  return py::make_tuple(result, planeMap);
+                                                }""")
+@PYB11pycppname("simplifyPlanes")
+def simplifyPlanesPolyhedron(poly = "const Polyhedron&",
+                             planes = "const std::vector<Plane3d>&",
+                             tol = "const double"):
+    """Reduce a set of planes for clipping a PolyClipper::Polyhedron, merging planes coplanar within tol and
+dropping redundant ones.  Returns ([planes], [index of the plane each input plane maps to, or -1])."""
+    return "py::tuple"
+
+@PYB11pycppname("intersectsHalfspaces")
+def intersectsHalfspacesPolyhedron(poly = "const Polyhedron&",
+                                   planes = "const std::vector<Plane3d>&"):
+    "Check whether clipping a PolyClipper::Polyhedron by planes would leave a non-zero volume."
+    return "bool"
+
+@PYB11pycppname("clipByVertexField")
+def clipByVertexFieldPolyhedron(poly = "Polyhedron&",
+                                field = "const std::vector<double>&",
+                                ID = ("const int", "std::numeric_limits<int>::min()")):
+    """Clip a PolyClipper::Polyhedron by a scalar field sampled at its vertices, keeping the region
+where the field (linearly interpolated along the edges) is positive."""
+    return "void"
+
+@PYB11implementation("""[](std::vector<Polyhedron> cells,
+                           std::vector<std::vector<int>> cellVertices,
+                           std::vector<Vector3d> points,
+                           const Plane3d& plane) {
+                                                  clipMesh(cells, cellVertices, points, plane);
+                                                  return py::make_tuple(cells, cellVertices, points);
+                                                }""")
+@PYB11pycppname("clipMesh")
+def clipMeshPolyhedron(cells = "std::vector<Polyhedron>",
+                       cellVertices = "std::vector<std::vector<int>>",
+                       points = "std::vector<Vector3d>",
+                       plane = "const Plane3d&"):
+    """Clip every cell of a mesh (cells, with the global IDs of their vertices in cellVertices indexing
+points) by a plane, intersecting each crossing edge once.  Returns the conforming
+(cells, cellVertices, points), with the new points appended."""
+    return "py::tuple"
+
+@PYB11implementation("""[](const std::vector<Polyhedron>& cells,
+                           const double tol) {
+                                                  ConformingMesh3d result;
+                                                  assembleMesh(result, cells, tol);
+                                                  return result;
+                                                }""")
+@PYB11pycppname("assembleMesh")
+def assembleMeshPolyhedron(cells = "const std::vector<Polyhedron>&",
+                           tol = "const double"):
+    """Assemble a conforming mesh from independently clipped Polyhedrons, welding vertices closer than tol
+and sharing the faces between neighboring cells.  Returns a ConformingMesh3d."""
+    return "ConformingMesh3d"
+
+@PYB11implementation("""[](std::vector<Polyhedron> polys,
+                           const double tol) {
+                                                  std::vector<std::vector<int>> vertexClasses;
+                                                  weldVertices(polys, tol, vertexClasses);
+                                                  return py::make_tuple(polys, vertexClasses);
+                                                }""")
+@PYB11pycppname("weldVertices")
+def weldVerticesPolyhedron(polys = "std::vector<Polyhedron>",
+                           tol = "const double"):
+    """Weld the vertices of a set of Polyhedrons closer than tol, snapping each to the first vertex of its
+class.  Returns the welded ([Polyhedrons], [vertex classes])."""
+    return "py::tuple"
+
+@PYB11implementation("""[](Polyhedron& poly,
+                           const double tol) {
+                                                  std::vector<int> vertexMap;
+                                                  collapseDegenerates(poly, tol, vertexMap);
+                                                  return vertexMap;
+                                                }""")
 @PYB11pycppname("collapseDegenerates")
 def collapseDegeneratesPolyhedron(poly = "Polyhedron&",
                                   tol = "const double"):
-    "Collapse edges in a PolyClipper::Polyhedron below the given tolerance."
-    return "void"
+    """Collapse edges in a PolyClipper::Polyhedron below the given tolerance, returning the vertex
+of the result each input vertex was merged into (-1 if removed)."""
+    return "std::vector<int>"
+
+@PYB11implementation("""[](const Polyhedron& self) {
+                                                  std::vector<Polyhedron> components;
+                                                  std::vector<double> zerothMoments;
+                                                  std::vector<Vector3d> firstMoments;
+                                                  splitComponents(components, zerothMoments, firstMoments, self);
+                                                  return py::make_tuple(components, zerothMoments, firstMoments);
+                                                }""")
+@PYB11pycppname("splitComponents")
+def splitComponentsPolyhedron(poly = "const Polyhedron&"):
+    """Split a PolyClipper::Polyhedron into its connected components, returning
+([Polyhedrons], [zeroth moments], [first moments])."""
+    return "py::tuple"
 
 @PYB11pycppname("extractFaces")
 def extractFacesPolyhedron(poly = "const Polyhedron&"):
@@ -156,6 +799,247 @@ The result is returned as a vector<vector<int>>, where each inner vector is a se
 ints representing vertex indices in the input Polyhedron."""
     return "std::vector<std::vector<int>>"
 
+@PYB11implementation("""[](const Polyhedron& self, const double tol) {
+                                                  std::vector<Vector3d> points;
+                                                  std::vector<int> tets;
+                                                  splitIntoTetrahedra(points, tets, self, tol);
+                                                  return py::make_tuple(points, tets);
+                                                }""")
+def splitIntoTetrahedraWithPoints(poly = "const Polyhedron&",
+                                  tol = ("const double", "0.0")):
+    """Split a general (possibly non-convex) PolyClipper::Polyhedron into tetrahedra.
+The result is returned as a tuple ([points], [tet indices]), where points begins with the
+Polyhedron vertex positions and may have cut points appended, and each four consecutive
+tet indices refer to points."""
+    return "py::tuple"
+
+@PYB11pycppname("findPlaneForVolumeFraction")
+def findPlaneForVolumeFractionPolyhedron(poly = "const Polyhedron&",
+                                         normal = "const Vector3d&",
+                                         fraction = "const double"):
+    """Find the plane distance such that clipping the Polyhedron by Plane3d(dist, normal)
+retains the given fraction of the volume."""
+    return "double"
+
+@PYB11implementation("""[](const Polyhedron& poly, const std::vector<Plane3d>& planes) {
+                                                  double zerothMoment;
+                                                  Vector3d firstMoment;
+                                                  std::vector<double> dzeroth_ddist, dfirst_dnormal;
+                                                  std::vector<Vector3d> dzeroth_dnormal, dfirst_ddist;
+                                                  clippedMomentsWithGradient(zerothMoment, firstMoment,
+                                                                             dzeroth_ddist, dzeroth_dnormal,
+                                                                             dfirst_ddist, dfirst_dnormal,
+                                                                             poly, planes);
+                                                  return py::make_tuple(zerothMoment, firstMoment,
+                                                                        dzeroth_ddist, dzeroth_dnormal,
+                                                                        dfirst_ddist, dfirst_dnormal);
+                                                }""")
+@PYB11pycppname("clippedMomentsWithGradient")
+def clippedMomentsWithGradientPolyhedron(poly = "const Polyhedron&",
+                                    planes = "const std::vector<Plane3d>&"):
+    """Clip a copy of a PolyClipper::Polyhedron by planes, returning the moments of the result and their
+derivatives with respect to each plane's distance and normal:
+  (zeroth, first, dzeroth_ddist, dzeroth_dnormal, dfirst_ddist, dfirst_dnormal)"""
+    return "py::tuple"
+
+@PYB11implementation("""[](const Polyhedron& poly, const Plane3d& plane) {
+                                                  Polyhedron above(poly), below;
+                                                  splitPolyhedron(above, below, plane);
+                                                  return py::make_tuple(above, below);
+                                                }""")
+def splitPolyhedron(poly = "const Polyhedron&",
+                 plane = "const Plane3d&"):
+    "Split a PolyClipper::Polyhedron by a plane, returning the (above, below) pieces."
+    return "py::tuple"
+
+@PYB11implementation("""[](const Polyhedron& poly,
+                           const std::vector<int>& order,
+                           const std::vector<Vector3d>& normals,
+                           const std::vector<double>& fractions) {
+                                                  std::vector<Polyhedron> result;
+                                                  nestedDissection(result, poly, order, normals, fractions);
+                                                  return result;
+                                                }""")
+@PYB11pycppname("nestedDissection")
+def nestedDissectionPolyhedron(poly = "const Polyhedron&",
+                          order = "const std::vector<int>&",
+                          normals = "const std::vector<Vector3d>&",
+                          fractions = "const std::vector<double>&"):
+    """Onion-skin reconstruction of a multi-material PolyClipper::Polyhedron.
+Materials are peeled off in the given order, and the result is a list with the Polyhedron
+of each material (indexed by material)."""
+    return "std::vector<Polyhedron>"
+
+@PYB11implementation("""[](const Polyhedron& poly,
+                           const std::vector<int>& order,
+                           const std::vector<Vector3d>& normals,
+                           const std::vector<double>& fractions) {
+                                                  std::vector<double> zerothMoments;
+                                                  std::vector<Vector3d> firstMoments;
+                                                  nestedDissectionMoments(zerothMoments, firstMoments, poly, order, normals, fractions);
+                                                  return py::make_tuple(zerothMoments, firstMoments);
+                                                }""")
+@PYB11pycppname("nestedDissectionMoments")
+def nestedDissectionMomentsPolyhedron(poly = "const Polyhedron&",
+                                 order = "const std::vector<int>&",
+                                 normals = "const std::vector<Vector3d>&",
+                                 fractions = "const std::vector<double>&"):
+    "Moments only version of nestedDissection, returning ([zeroth moments], [first moments])."
+    return "py::tuple"
+
+@PYB11implementation("""[](const Polyhedron& poly,
+                           const std::vector<Plane3d>& planes) {
+                                                  std::vector<Polyhedron> result;
+                                                  subtractConvex(result, poly, planes);
+                                                  return result;
+                                                }""")
+@PYB11pycppname("subtractConvex")
+def subtractConvexPolyhedron(poly = "const Polyhedron&",
+                        planes = "const std::vector<Plane3d>&"):
+    """Subtract the convex region above all the planes from a PolyClipper::Polyhedron, returning the
+disjoint pieces outside it: piece k lies below plane k and above planes 0..k-1."""
+    return "std::vector<Polyhedron>"
+
+@PYB11implementation("""[](const Polyhedron& poly,
+                           const std::vector<Plane3d>& planes) {
+                                                  std::vector<double> zerothMoments;
+                                                  std::vector<Vector3d> firstMoments;
+                                                  subtractConvexMoments(zerothMoments, firstMoments, poly, planes);
+                                                  return py::make_tuple(zerothMoments, firstMoments);
+                                                }""")
+@PYB11pycppname("subtractConvexMoments")
+def subtractConvexMomentsPolyhedron(poly = "const Polyhedron&",
+                               planes = "const std::vector<Plane3d>&"):
+    "Moments only version of subtractConvex, returning ([zeroth moments], [first moments])."
+    return "py::tuple"
+
+@PYB11implementation("""[](const Polyhedron& poly) {
+                                                  ConvexDecomposition3d result;
+                                                  convexDecomposition(result, poly);
+                                                  return result;
+                                                }""")
+@PYB11pycppname("convexDecomposition")
+def convexDecompositionPolyhedron(poly = "const Polyhedron&"):
+    "Break a (possibly non-convex) PolyClipper::Polyhedron into convex parts, returning a ConvexDecomposition3d."
+    return "ConvexDecomposition3d"
+
+@PYB11implementation("""[](const Polyhedron& poly,
+                           const ConvexDecomposition3d& tool) {
+                                                  std::vector<Polyhedron> result;
+                                                  intersect(result, poly, tool);
+                                                  return result;
+                                                }""")
+@PYB11pycppname("intersect")
+def intersectPolyhedron(poly = "const Polyhedron&",
+                        tool = "const ConvexDecomposition3d&"):
+    """Intersect a PolyClipper::Polyhedron with a (possibly non-convex) tool given by its convex decomposition,
+returning the disjoint pieces of the intersection."""
+    return "std::vector<Polyhedron>"
+
+@PYB11implementation("""[](const Polyhedron& poly,
+                           const Polyhedron& tool) {
+                                                  std::vector<Polyhedron> result;
+                                                  intersect(result, poly, tool);
+                                                  return result;
+                                                }""")
+@PYB11pycppname("intersect")
+def intersectPolyhedra(poly = "const Polyhedron&",
+                       tool = "const Polyhedron&"):
+    "Intersect two (possibly non-convex) PolyClipper::Polyhedrons, returning the disjoint pieces of the intersection."
+    return "std::vector<Polyhedron>"
+
+@PYB11implementation("""[](const Polyhedron& poly,
+                           const ConvexDecomposition3d& tool) {
+                                                  double zerothMoment;
+                                                  Vector3d firstMoment;
+                                                  intersectMoments(zerothMoment, firstMoment, poly, tool);
+                                                  return py::make_tuple(zerothMoment, firstMoment);
+                                                }""")
+@PYB11pycppname("intersectMoments")
+def intersectMomentsPolyhedron(poly = "const Polyhedron&",
+                               tool = "const ConvexDecomposition3d&"):
+    "Moments only version of intersect, returning (zeroth moment, first moment) summed over the pieces."
+    return "py::tuple"
+
+@PYB11implementation("""[](const Polyhedron& poly) {
+                                                  FacePlanes3d result;
+                                                  facePlanes(result, poly);
+                                                  return result;
+                                                }""")
+@PYB11pycppname("facePlanes")
+def facePlanesPolyhedron(poly = "const Polyhedron&"):
+    "Cache the face planes of a PolyClipper::Polyhedron, returning a FacePlanes3d."
+    return "FacePlanes3d"
+
+@PYB11implementation("""[](const FacePlanes3d& a,
+                           const FacePlanes3d& b) {
+                                                  double volumeBound;
+                                                  const auto result = convexOverlap(volumeBound, a, b);
+                                                  return py::make_tuple(result, volumeBound);
+                                                }""")
+@PYB11pycppname("convexOverlap")
+def convexOverlapPolyhedron(a = "const FacePlanes3d&",
+                            b = "const FacePlanes3d&"):
+    """Test two convex cells (given by their FacePlanes3d) for overlap by separating axes,
+returning (overlap, upper bound on the volume of the intersection)."""
+    return "py::tuple"
+
+@PYB11implementation("""[](const FacePlanes3d& cell,
+                           const std::vector<double>& x,
+                           const std::vector<double>& y,
+                           const std::vector<double>& z) {
+                                                  std::vector<int> result;
+                                                  containsPoints(result, cell, x, y, z);
+                                                  return result;
+                                                }""")
+@PYB11pycppname("containsPoints")
+def containsPointsPolyhedron(cell = "const FacePlanes3d&",
+                             x = "const std::vector<double>&",
+                             y = "const std::vector<double>&",
+                             z = "const std::vector<double>&"):
+    "Check whether each of a batch of points (x, y, z) lies in a cell (given by its FacePlanes3d), returning 1 or 0 per point."
+    return "std::vector<int>"
+
+@PYB11implementation("""[](const FacePlanes3d& cell,
+                           const std::vector<double>& x,
+                           const std::vector<double>& y,
+                           const std::vector<double>& z) {
+                                                  std::vector<double> result;
+                                                  signedDistances(result, cell, x, y, z);
+                                                  return result;
+                                                }""")
+@PYB11pycppname("signedDistances")
+def signedDistancesPolyhedron(cell = "const FacePlanes3d&",
+                              x = "const std::vector<double>&",
+                              y = "const std::vector<double>&",
+                              z = "const std::vector<double>&"):
+    """Compute the signed distance (positive inside) of each of a batch of points (x, y, z) to the boundary of a cell
+(given by its FacePlanes3d)."""
+    return "std::vector<double>"
+
+@PYB11pycppname("volumeResponse")
+def volumeResponsePolyhedron(poly = "const Polyhedron&",
+                        normal = "const Vector3d&"):
+    "Build the VolumeResponse of a PolyClipper::Polyhedron for clipping planes with the given normal."
+    return "VolumeResponse"
+
+@PYB11implementation("""[](const Polyhedron& poly,
+                           const std::vector<Vector3d>& displacements,
+                           const std::vector<std::vector<Plane3d>>& donors) {
+                                                     std::vector<double> zerothMoments;
+                                                     std::vector<Vector3d> firstMoments;
+                                                     fluxVolumes(zerothMoments, firstMoments, poly, displacements, donors);
+                                                     return py::make_tuple(zerothMoments, firstMoments);
+                                                   }""")
+@PYB11pycppname("fluxVolumes")
+def fluxVolumesPolyhedron(poly = "const Polyhedron&",
+                          displacements = "const std::vector<Vector3d>&",
+                          donors = "const std::vector<std::vector<Plane3d>>&"):
+    """Compute the signed volumes swept by each face of a PolyClipper::Polyhedron moving with the vertex
+displacements, intersected with each donor cell (given as a set of planes).
+Returns ([zeroth moments], [first moments]) indexed by [face*len(donors) + donor]."""
+    return "py::tuple"
+
 #-------------------------------------------------------------------------------
 # Serialization
 #-------------------------------------------------------------------------------
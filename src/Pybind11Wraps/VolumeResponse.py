@@ -0,0 +1,55 @@
+from PYB11Generator import *
+
+class VolumeResponse:
+    """The volume (area in 2D) retained by clipping a Polyhedron (Polygon) with a
+plane of fixed normal, as a function of the plane distance.
+
+This is piecewise polynomial (cubic for polyhedra, quadratic for polygons)
+between the heights of the vertices along the normal, so once built it can be
+evaluated, differentiated, and inverted without clipping.  Construct these
+with volumeResponse(poly, normal)."""
+
+    #---------------------------------------------------------------------------
+    # Constructors
+    #---------------------------------------------------------------------------
+    def pyinit0(self):
+        "Default constructor"
+
+    #---------------------------------------------------------------------------
+    # Methods
+    #---------------------------------------------------------------------------
+    @PYB11const
+    def size(self):
+        "Number of polynomial intervals"
+        return "size_t"
+
+    @PYB11const
+    def totalVolume(self):
+        "The full volume (plane below every vertex)"
+        return "double"
+
+    @PYB11const
+    def volume(self,
+               dist = "const double"):
+        "Volume retained above the plane with distance dist"
+        return "double"
+
+    @PYB11const
+    def derivative(self,
+                   dist = "const double"):
+        "Derivative of the retained volume with respect to the plane distance (the cut face area)"
+        return "double"
+
+    @PYB11const
+    def inverse(self,
+                vol = "const double"):
+        "Plane distance which retains the volume vol"
+        return "double"
+
+    #---------------------------------------------------------------------------
+    # Attributes
+    #---------------------------------------------------------------------------
+    degree = PYB11readwrite()
+    offset = PYB11readwrite()
+    breaks = PYB11readwrite()
+    coeffs = PYB11readwrite()
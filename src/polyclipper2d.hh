@@ -28,6 +28,9 @@
 #include "polyclipper_vector2d.hh"
 #include "polyclipper_utilities.hh"
 #include "polyclipper_serialize.hh"
+#include "polyclipper_response.hh"
+#include "polyclipper_quadrature.hh"
+#include "polyclipper_faceplanes.hh"
 
 #include <cmath>
 #include <string>
@@ -74,6 +77,23 @@ void initializePolygon(std::vector<Vertex2d<VA>>& poly,
                        const std::vector<typename VA::VECTOR>& positions,
                        const std::vector<std::vector<int>>& neighbors);
 
+//------------------------------------------------------------------------------
+// Build the polygon bounded by a set of planes, given a point strictly inside
+// all of them.  The vertices list the IDs of their planes in clips.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+void polygonFromHalfspaces(std::vector<Vertex2d<VA>>& poly,
+                           const std::vector<Plane<VA>>& planes,
+                           const typename VA::VECTOR& interiorPoint);
+
+//------------------------------------------------------------------------------
+// Build the convex hull of a set of points as a polygon.  Each vertex has its
+// ID set to the index of its point.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+void convexHull(std::vector<Vertex2d<VA>>& poly,
+                const std::vector<typename VA::VECTOR>& points);
+
 //------------------------------------------------------------------------------
 // Return a nicely formatted string representing the polygon.
 //------------------------------------------------------------------------------
@@ -87,6 +107,63 @@ template<typename VA = internal::VectorAdapter<Vector2d>>
 void moments(double& zerothMoment, typename VA::VECTOR& firstMoment,
              const std::vector<Vertex2d<VA>>& polygon);
 
+//------------------------------------------------------------------------------
+// Compute the perimeter of a Polygon, along with the length, midpoint, and
+// outward unit normal of each edge (in extractFaces order).
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+void surfaceMoments(double& totalLength,
+                    std::vector<double>& edgeLengths,
+                    std::vector<typename VA::VECTOR>& edgeCentroids,
+                    std::vector<typename VA::VECTOR>& edgeNormals,
+                    const std::vector<Vertex2d<VA>>& polygon);
+
+//------------------------------------------------------------------------------
+// Fused version of moments and surfaceMoments, sharing one pass over the edges.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+void surfaceMoments(double& zerothMoment,
+                    typename VA::VECTOR& firstMoment,
+                    double& totalLength,
+                    std::vector<double>& edgeLengths,
+                    std::vector<typename VA::VECTOR>& edgeCentroids,
+                    std::vector<typename VA::VECTOR>& edgeNormals,
+                    const std::vector<Vertex2d<VA>>& polygon);
+
+//------------------------------------------------------------------------------
+// Compute the axisymmetric (RZ) moments of a Polygon, taking y as the radius:
+// the volume of revolution (2 pi int r dA), and r weighted centroid.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+void rzMoments(double& zerothMoment, typename VA::VECTOR& firstMoment,
+               const std::vector<Vertex2d<VA>>& polygon);
+
+//------------------------------------------------------------------------------
+// RZ moments of a batch of polygons.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+void rzMoments(std::vector<double>& zerothMoments,
+               std::vector<typename VA::VECTOR>& firstMoments,
+               const std::vector<std::vector<Vertex2d<VA>>>& polygons);
+
+//------------------------------------------------------------------------------
+// Clip a copy of a polygon by planes, returning only the RZ moments.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+void clippedRZMoments(double& zerothMoment, typename VA::VECTOR& firstMoment,
+                      const std::vector<Vertex2d<VA>>& polygon,
+                      const std::vector<Plane<VA>>& planes);
+
+//------------------------------------------------------------------------------
+// Batched clippedRZMoments: the RZ moments of the polygon clipped by each set
+// of planes in turn.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+void clippedRZMoments(std::vector<double>& zerothMoments,
+                      std::vector<typename VA::VECTOR>& firstMoments,
+                      const std::vector<Vertex2d<VA>>& polygon,
+                      const std::vector<std::vector<Plane<VA>>>& planeSets);
+
 //------------------------------------------------------------------------------
 // Clip a polygon by planes.
 //------------------------------------------------------------------------------
@@ -94,6 +171,78 @@ template<typename VA = internal::VectorAdapter<Vector2d>>
 void clipPolygon(std::vector<Vertex2d<VA>>& poly,
                  const std::vector<Plane<VA>>& planes);
 
+//------------------------------------------------------------------------------
+// Clip a polygon by planes, also returning the edge(s) created by each plane
+// (cutFaces[k] for planes[k]) as they survive on the clipped polygon.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+void clipPolygon(std::vector<Vertex2d<VA>>& poly,
+                 const std::vector<Plane<VA>>& planes,
+                 std::vector<CutFace<VA>>& cutFaces);
+
+//------------------------------------------------------------------------------
+// Reduce a set of planes for clipping a polygon: merge planes coplanar within
+// tol over the polygon, and drop planes that are redundant for it.  planeMap
+// gives the index in result each input plane was merged into (-1 if dropped).
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+void simplifyPlanes(std::vector<Plane<VA>>& result,
+                    std::vector<int>& planeMap,
+                    const std::vector<Vertex2d<VA>>& poly,
+                    const std::vector<Plane<VA>>& planes,
+                    const double tol);
+
+//------------------------------------------------------------------------------
+// Check whether clipping a polygon by planes would leave a non-zero area,
+// without building the clipped polygon.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+bool intersectsHalfspaces(const std::vector<Vertex2d<VA>>& poly,
+                          const std::vector<Plane<VA>>& planes);
+
+//------------------------------------------------------------------------------
+// Clip a polygon by a scalar field sampled at its vertices (field[i] for
+// vertex i), keeping the region where the field (linearly interpolated along
+// the edges) is positive.  New vertices are labeled with the clip ID.  A
+// nonlinear field may only cut a convex polygon.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+void clipByVertexField(std::vector<Vertex2d<VA>>& poly,
+                       const std::vector<double>& field,
+                       const int ID = std::numeric_limits<int>::min());
+
+//------------------------------------------------------------------------------
+// Clip every cell of a polygonal mesh by a plane.  Cell c lists the global IDs
+// of its vertices in cellVertices[c], indexing the mesh points.  Each edge
+// crossing the plane is intersected once, appending the new point to points,
+// so the clipped cells conform: cellVertices is updated to the global IDs of
+// the clipped cells' vertices.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+void clipMesh(std::vector<std::vector<Vertex2d<VA>>>& cells,
+              std::vector<std::vector<int>>& cellVertices,
+              std::vector<typename VA::VECTOR>& points,
+              const Plane<VA>& plane);
+
+//------------------------------------------------------------------------------
+// Assemble a conforming mesh from independently clipped cells.  Vertices
+// closer than tol are welded, and edges with the same welded vertices are
+// shared between the cells on either side.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+void assembleMesh(ConformingMesh<VA>& mesh,
+                  const std::vector<std::vector<Vertex2d<VA>>>& cells,
+                  const double tol);
+
+//------------------------------------------------------------------------------
+// Weld the vertices of a set of polygons closer than tol, moving each to the
+// first vertex of its class.  Returns the number of classes.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+int weldVertices(std::vector<std::vector<Vertex2d<VA>>>& polys,
+                 const double tol,
+                 std::vector<std::vector<int>>& vertexClasses);
+
 //------------------------------------------------------------------------------
 // Collapse degenerate vertices.
 //------------------------------------------------------------------------------
@@ -101,6 +250,33 @@ template<typename VA = internal::VectorAdapter<Vector2d>>
 void collapseDegenerates(std::vector<Vertex2d<VA>>& poly,
                          const double tol);
 
+//------------------------------------------------------------------------------
+// Collapse degenerate vertices, reporting the vertex of the result each input
+// vertex was merged into (-1 if removed).
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+void collapseDegenerates(std::vector<Vertex2d<VA>>& poly,
+                         const double tol,
+                         std::vector<int>& vertexMap);
+
+//------------------------------------------------------------------------------
+// Label the connected components of a polygon (such as the pieces left by
+// clipping a non-convex polygon), returning the number of components.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+int splitComponents(std::vector<int>& componentIDs,
+                    const std::vector<Vertex2d<VA>>& poly);
+
+//------------------------------------------------------------------------------
+// Split a polygon into its connected components, each compacted as a separate
+// polygon, along with the moments of each component.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+void splitComponents(std::vector<std::vector<Vertex2d<VA>>>& components,
+                     std::vector<double>& zerothMoments,
+                     std::vector<typename VA::VECTOR>& firstMoments,
+                     const std::vector<Vertex2d<VA>>& poly);
+
 //------------------------------------------------------------------------------
 // Return the vertices ordered in faces.
 //------------------------------------------------------------------------------
@@ -121,6 +297,182 @@ template<typename VA = internal::VectorAdapter<Vector2d>>
 std::vector<std::vector<int>> splitIntoTriangles(const std::vector<Vertex2d<VA>>& poly,
                                                  const double tol = 0.0);
 
+//------------------------------------------------------------------------------
+// Split a general (possibly non-convex, possibly with holes) polygon into
+// triangles, written as flat triples of vertex indices into tris.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+void splitIntoTriangles(std::vector<int>& tris,
+                        const std::vector<Vertex2d<VA>>& poly,
+                        const double tol = 0.0);
+
+//------------------------------------------------------------------------------
+// Find the plane distance (for the given unit normal) such that clipping the
+// polygon by Plane(dist, normal) retains the given fraction of its area.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+double findPlaneForVolumeFraction(const std::vector<Vertex2d<VA>>& poly,
+                                  const typename VA::VECTOR& normal,
+                                  const double fraction);
+
+//------------------------------------------------------------------------------
+// Build the piecewise quadratic area retained by clipping with a plane of the
+// given normal, as a function of the plane distance.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+VolumeResponse volumeResponse(const std::vector<Vertex2d<VA>>& poly,
+                              const typename VA::VECTOR& normal);
+
+//------------------------------------------------------------------------------
+// Clip a polygon by planes and return the moments of the result, along with
+// the derivatives of those moments with respect to each plane's distance and
+// normal.  The normal derivatives of the first moment are stored row-major,
+// i.e., dfirst_dnormal[k*2*2 + 2*i + j] = d(firstMoment_i)/d(normal_j) for plane k.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+void clippedMomentsWithGradient(double& zerothMoment,
+                                typename VA::VECTOR& firstMoment,
+                                std::vector<double>& dzeroth_ddist,
+                                std::vector<typename VA::VECTOR>& dzeroth_dnormal,
+                                std::vector<typename VA::VECTOR>& dfirst_ddist,
+                                std::vector<double>& dfirst_dnormal,
+                                const std::vector<Vertex2d<VA>>& poly,
+                                const std::vector<Plane<VA>>& planes);
+
+//------------------------------------------------------------------------------
+// Split a polygon by a plane: poly retains the portion above the plane (as
+// clipPolygon), while below receives the portion beneath it.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+void splitPolygon(std::vector<Vertex2d<VA>>& poly,
+                  std::vector<Vertex2d<VA>>& below,
+                  const Plane<VA>& plane);
+
+//------------------------------------------------------------------------------
+// Onion-skin (nested dissection) reconstruction of a multi-material polygon.
+// Materials are peeled off in the given order, each above a plane with the
+// material's normal enclosing its area fraction of the original polygon.
+// The final material in the order receives the remainder.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+void nestedDissection(std::vector<std::vector<Vertex2d<VA>>>& materialPolys,
+                      const std::vector<Vertex2d<VA>>& poly,
+                      const std::vector<int>& order,
+                      const std::vector<typename VA::VECTOR>& normals,
+                      const std::vector<double>& fractions);
+
+//------------------------------------------------------------------------------
+// Moments only version of nestedDissection.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+void nestedDissectionMoments(std::vector<double>& zerothMoments,
+                             std::vector<typename VA::VECTOR>& firstMoments,
+                             const std::vector<Vertex2d<VA>>& poly,
+                             const std::vector<int>& order,
+                             const std::vector<typename VA::VECTOR>& normals,
+                             const std::vector<double>& fractions);
+
+//------------------------------------------------------------------------------
+// Subtract a convex region (the intersection of the half-spaces above the
+// planes) from a polygon, returning the disjoint pieces outside it.  Piece k
+// lies below plane k and above planes 0, ..., k-1 (and may be empty).
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+void subtractConvex(std::vector<std::vector<Vertex2d<VA>>>& pieces,
+                    const std::vector<Vertex2d<VA>>& poly,
+                    const std::vector<Plane<VA>>& planes);
+
+//------------------------------------------------------------------------------
+// Moments only version of subtractConvex.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+void subtractConvexMoments(std::vector<double>& zerothMoments,
+                           std::vector<typename VA::VECTOR>& firstMoments,
+                           const std::vector<Vertex2d<VA>>& poly,
+                           const std::vector<Plane<VA>>& planes);
+
+//------------------------------------------------------------------------------
+// Break a (possibly non-convex) polygon into convex parts, caching the planes
+// bounding each part so it can be used to intersect many targets.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+void convexDecomposition(ConvexDecomposition<VA>& decomposition,
+                         const std::vector<Vertex2d<VA>>& poly);
+
+//------------------------------------------------------------------------------
+// Intersect a polygon with a (possibly non-convex) tool given by its convex
+// decomposition, returning the disjoint pieces of the intersection (at most
+// one per convex part of the tool).
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+void intersect(std::vector<std::vector<Vertex2d<VA>>>& pieces,
+               const std::vector<Vertex2d<VA>>& poly,
+               const ConvexDecomposition<VA>& tool);
+
+//------------------------------------------------------------------------------
+// Intersect two (possibly non-convex) polygons.  This decomposes the tool on
+// each call, so build a ConvexDecomposition directly to reuse it.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+void intersect(std::vector<std::vector<Vertex2d<VA>>>& pieces,
+               const std::vector<Vertex2d<VA>>& poly,
+               const std::vector<Vertex2d<VA>>& tool);
+
+//------------------------------------------------------------------------------
+// Moments only version of intersect, summed over the pieces.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+void intersectMoments(double& zerothMoment,
+                      typename VA::VECTOR& firstMoment,
+                      const std::vector<Vertex2d<VA>>& poly,
+                      const ConvexDecomposition<VA>& tool);
+
+//------------------------------------------------------------------------------
+// Cache the face planes of a polygon, to test it against many others (see
+// convexOverlap in polyclipper_faceplanes.hh).
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+void facePlanes(FacePlanes<VA>& cell,
+                const std::vector<Vertex2d<VA>>& poly);
+
+//------------------------------------------------------------------------------
+// Compute the signed areas (and centroids) swept by each edge of a polygon
+// moving with the given vertex displacements, intersected with each of a set
+// of convex donor cells described by their planes.  Results are stored as
+// [edge*ndonors + donor], with edges in extractFaces order, and are positive
+// for motion along the outward edge normal.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>>
+void fluxVolumes(std::vector<double>& zerothMoments,
+                 std::vector<typename VA::VECTOR>& firstMoments,
+                 const std::vector<Vertex2d<VA>>& poly,
+                 const std::vector<typename VA::VECTOR>& displacements,
+                 const std::vector<std::vector<Plane<VA>>>& donors);
+
+//------------------------------------------------------------------------------
+// Integrate a function over a polygon using the given triangle rule.
+// The integrand is called once on the whole batch of points as
+//   integrand(x, y, values)
+// with x, y, values std::vector<double>s, and must fill values.  The batch
+// holds the point storage, and can be reused between calls.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>, typename Integrand>
+double integrate(const std::vector<Vertex2d<VA>>& poly,
+                 Integrand&& integrand,
+                 const QuadratureRule& rule,
+                 QuadratureBatch& batch);
+
+//------------------------------------------------------------------------------
+// Integrate a function over each of a set of polygons, evaluating the
+// integrand once for the points of all of them.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector2d>, typename Integrand>
+void integrate(std::vector<double>& results,
+               const std::vector<std::vector<Vertex2d<VA>>>& polys,
+               Integrand&& integrand,
+               const QuadratureRule& rule,
+               QuadratureBatch& batch);
+
 }
 
 #include "polyclipper2dImpl.hh"
@@ -113,6 +113,134 @@ intersect(const typename VA::VECTOR& a,            // line-segment begin
   return result;
 }
 
+//------------------------------------------------------------------------------
+// Fraction of a triangle's area lying above the height t, given the heights of
+// its three vertices sorted in ascending order (a <= b <= c).  Each branch only
+// divides by knot intervals that are non-empty when the branch is taken.
+//------------------------------------------------------------------------------
+inline
+double
+triangleFractionAbove(const double a, const double b, const double c,
+                      const double t) {
+  if (t <= a) return 1.0;
+  if (t >= c) return 0.0;
+  if (t <= b) {
+    const auto x = t - a;
+    return 1.0 - x*x/((b - a)*(c - a));
+  }
+  const auto x = c - t;
+  return x*x/((c - a)*(c - b));
+}
+
+//------------------------------------------------------------------------------
+// The polynomial form of triangleFractionAbove on its piece'th knot interval
+// (0 for [a, b], 1 for [b, c]), as coefficients in x = t - h0.
+//------------------------------------------------------------------------------
+inline
+void
+triangleFractionAbovePolynomial(double* coeffs,
+                                const double a, const double b, const double c,
+                                const int piece, const double h0) {
+  if (piece == 0) {
+    const auto s = h0 - a;
+    const auto Dinv = 1.0/((b - a)*(c - a));
+    coeffs[0] = 1.0 - s*s*Dinv;
+    coeffs[1] = -2.0*s*Dinv;
+    coeffs[2] = -Dinv;
+  } else {
+    const auto r = c - h0;
+    const auto Dinv = 1.0/((c - a)*(c - b));
+    coeffs[0] = r*r*Dinv;
+    coeffs[1] = -2.0*r*Dinv;
+    coeffs[2] = Dinv;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Decompose a polygon into the signed fan of triangles used by moments, and
+// record the sorted heights (relative to the first vertex) of each triangle
+// along the given direction.  Triangle heights are stored as consecutive
+// triples in heights, with their signed areas in areas.
+//------------------------------------------------------------------------------
+template<typename VA>
+inline
+void
+triangleHeights(std::vector<double>& heights,
+                std::vector<double>& areas,
+                const std::vector<Vertex2d<VA>>& polygon,
+                const typename VA::VECTOR& normal) {
+  heights.clear();
+  areas.clear();
+  if (polygon.size() > 2) {
+    const auto& p0 = polygon[0].position;
+    for (const auto& v1: polygon) {
+      const auto& v2 = polygon[v1.neighbors.second];
+      const auto triA = 0.5*VA::crossmag(VA::sub(v1.position, p0), VA::sub(v2.position, p0));
+      if (triA != 0.0) {
+        double h[3] = {0.0,
+                       VA::dot(normal, VA::sub(v1.position, p0)),
+                       VA::dot(normal, VA::sub(v2.position, p0))};
+        std::sort(h, h + 3);
+        heights.insert(heights.end(), h, h + 3);
+        areas.push_back(triA);
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Append the quadrature points for a polygon to a batch, mapping the rule onto
+// the signed triangle fan used by moments.
+//------------------------------------------------------------------------------
+template<typename VA>
+inline
+void
+appendQuadraturePoints(QuadratureBatch& batch,
+                       const std::vector<Vertex2d<VA>>& polygon,
+                       const QuadratureRule& rule) {
+  PCASSERT(rule.dimension == 2);
+  batch.offsets.push_back(batch.size());
+  if (polygon.size() < 3) return;
+  const auto npts = rule.size();
+  const auto& origin = polygon[0].position;
+  for (const auto& v1: polygon) {
+    const auto p1 = VA::sub(v1.position, origin);
+    const auto p2 = VA::sub(polygon[v1.neighbors.second].position, origin);
+    const auto dA = 0.5*VA::crossmag(p1, p2);
+    if (dA != 0.0) {
+      for (auto i = 0u; i < npts; ++i) {
+        const auto* b = &rule.barycentric[3u*i];
+        const auto p = VA::add(origin, VA::add(VA::mul(p1, b[1]), VA::mul(p2, b[2])));
+        batch.x.push_back(VA::x(p));
+        batch.y.push_back(VA::y(p));
+        batch.weights.push_back(rule.weights[i]*dA);
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Build the triangle (a, b, c) as a polygon, swapping b & c if needed to make
+// it counter-clockwise.  Returns the signed area of (a, b, c).
+//------------------------------------------------------------------------------
+template<typename VA>
+inline
+double
+initializeTriangle(std::vector<Vertex2d<VA>>& poly,
+                   const typename VA::VECTOR& a,
+                   const typename VA::VECTOR& b,
+                   const typename VA::VECTOR& c) {
+  const auto area = 0.5*VA::crossmag(VA::sub(b, a), VA::sub(c, a));
+  poly.assign(3, Vertex2d<VA>());
+  poly[0].position = a;
+  poly[1].position = (area >= 0.0 ? b : c);
+  poly[2].position = (area >= 0.0 ? c : b);
+  poly[0].neighbors = {2, 1};
+  poly[1].neighbors = {0, 2};
+  poly[2].neighbors = {1, 0};
+  return area;
+}
+
 }              // internal namespace methods
 
 //------------------------------------------------------------------------------
@@ -135,6 +263,156 @@ initializePolygon(std::vector<Vertex2d<VA>>& poly,
   }
 }
 
+namespace internal {
+
+//------------------------------------------------------------------------------
+// Monotone chain: the convex hull of a set of points, returned as the indices
+// of its vertices in counter-clockwise order.  Points within tol of a hull
+// edge are treated as lying on it and left out.  Returns fewer than three
+// vertices if the points are degenerate (collinear).
+//------------------------------------------------------------------------------
+template<typename VA>
+vector<int>
+convexHullVertices(const vector<typename VA::VECTOR>& points,
+                   const double tol) {
+  const int n = points.size();
+  vector<int> order(n);
+  for (auto i = 0; i < n; ++i) order[i] = i;
+  std::sort(order.begin(), order.end(), [&](const int a, const int b) {
+      return (VA::x(points[a]) < VA::x(points[b]) or
+              (VA::x(points[a]) == VA::x(points[b]) and VA::y(points[a]) < VA::y(points[b])));
+    });
+
+  // Pop the last vertex while it isn't strictly left of the new edge.
+  vector<int> hull;
+  auto addPoint = [&](const int i, const size_t nmin) {
+    while (hull.size() >= nmin) {
+      const auto& a = points[hull[hull.size() - 2]];
+      const auto& b = points[hull.back()];
+      const auto ac = VA::sub(points[i], a);
+      if (VA::crossmag(VA::sub(b, a), ac) > tol*VA::magnitude(ac)) break;
+      hull.pop_back();
+    }
+    hull.push_back(i);
+  };
+  for (auto k = 0; k < n; ++k) addPoint(order[k], 2u);
+  const auto nlower = hull.size() + 1u;
+  for (auto k = n - 2; k >= 0; --k) addPoint(order[k], nlower);
+  if (not hull.empty()) hull.pop_back();
+  return hull;
+}
+
+//------------------------------------------------------------------------------
+// Check whether a polygon is convex: every vertex on or above the line of each
+// edge, to a tolerance relative to the size of the polygon.
+//------------------------------------------------------------------------------
+template<typename VA>
+bool
+isConvex(const std::vector<Vertex2d<VA>>& poly) {
+  const int n = poly.size();
+  if (n < 3) return true;
+  auto xmin = poly[0].position, xmax = poly[0].position;
+  for (const auto& v: poly) {
+    VA::x(xmin) = std::min(VA::x(xmin), VA::x(v.position));
+    VA::y(xmin) = std::min(VA::y(xmin), VA::y(v.position));
+    VA::x(xmax) = std::max(VA::x(xmax), VA::x(v.position));
+    VA::y(xmax) = std::max(VA::y(xmax), VA::y(v.position));
+  }
+  const auto tol = 1.0e-10*VA::magnitude(VA::sub(xmax, xmin));
+  for (const auto& v: poly) {
+    const auto edge = VA::sub(poly[v.neighbors.second].position, v.position);
+    const auto len = VA::magnitude(edge);
+    if (len <= tol) continue;
+    const auto normal = VA::Vector(-VA::y(edge)/len, VA::x(edge)/len);
+    for (const auto& w: poly) {
+      if (VA::dot(normal, VA::sub(w.position, v.position)) < -tol) return false;
+    }
+  }
+  return true;
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Build the polygon bounded by a set of planes (half-planes) around an
+// interior point.  Moving the origin to the interior point, the plane (d, n)
+// becomes q.x <= 1 with the dual point q = -n/h, where h > 0 is the height of
+// the interior point above the plane.  The vertices of the polygon are then
+// the (polar) duals of the edges of the convex hull of the dual points, in the
+// same counter-clockwise order, while dual points inside the hull are
+// redundant planes.
+//------------------------------------------------------------------------------
+template<typename VA>
+void
+polygonFromHalfspaces(std::vector<Vertex2d<VA>>& poly,
+                      const std::vector<Plane<VA>>& planes,
+                      const typename VA::VECTOR& interiorPoint) {
+  using Vector = typename VA::VECTOR;
+  poly.clear();
+  const int nplanes = planes.size();
+
+  // The dual points.
+  vector<Vector> dual(nplanes);
+  auto qmax = 0.0;
+  for (auto k = 0; k < nplanes; ++k) {
+    const auto h = planes[k].dist + VA::dot(planes[k].normal, interiorPoint);
+    if (h <= 0.0) return;
+    dual[k] = VA::div(VA::neg(planes[k].normal), h);
+    qmax = std::max(qmax, VA::magnitude(dual[k]));
+  }
+  const auto hull = internal::convexHullVertices<VA>(dual, 1.0e-10*qmax);
+  const int n = hull.size();
+  if (n < 3) return;
+
+  // Each edge of the dual hull gives a vertex, which must be finite (the
+  // origin strictly inside the hull).
+  poly.resize(n);
+  for (auto i = 0; i < n; ++i) {
+    const auto a = hull[i], b = hull[(i + 1) % n];
+    const auto edge = VA::sub(dual[b], dual[a]);
+    const auto normal = VA::Vector(VA::y(edge), -VA::x(edge));
+    const auto c = VA::dot(normal, dual[a]);
+    if (c <= 1.0e-10*qmax*VA::magnitude(normal)) {
+      poly.clear();
+      return;
+    }
+    poly[i].position = VA::add(interiorPoint, VA::div(normal, c));
+    poly[i].neighbors = {(i - 1 + n) % n, (i + 1) % n};
+    poly[i].ID = i;
+    poly[i].clips.insert(planes[a].ID);
+    poly[i].clips.insert(planes[b].ID);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Build the convex hull of a set of points, with a monotone chain.  Points
+// within a small tolerance (relative to the extent of the points) of the hull
+// edges are left out.
+//------------------------------------------------------------------------------
+template<typename VA>
+void
+convexHull(std::vector<Vertex2d<VA>>& poly,
+           const std::vector<typename VA::VECTOR>& points) {
+  poly.clear();
+  if (points.empty()) return;
+  auto xmin = points[0], xmax = points[0];
+  for (const auto& p: points) {
+    VA::x(xmin) = std::min(VA::x(xmin), VA::x(p));
+    VA::y(xmin) = std::min(VA::y(xmin), VA::y(p));
+    VA::x(xmax) = std::max(VA::x(xmax), VA::x(p));
+    VA::y(xmax) = std::max(VA::y(xmax), VA::y(p));
+  }
+  const auto hull = internal::convexHullVertices<VA>(points, 1.0e-10*VA::magnitude(VA::sub(xmax, xmin)));
+  const int n = hull.size();
+  if (n < 3) return;
+  poly.resize(n);
+  for (auto i = 0; i < n; ++i) {
+    poly[i].position = points[hull[i]];
+    poly[i].neighbors = {(i - 1 + n) % n, (i + 1) % n};
+    poly[i].ID = hull[i];
+  }
+}
+
 //------------------------------------------------------------------------------
 // Return a nicely formatted string representing the polygon.
 //------------------------------------------------------------------------------
@@ -219,11 +497,195 @@ void moments(double& zerothMoment, typename VA::VECTOR& firstMoment,
 }
 
 //------------------------------------------------------------------------------
-// Clip a polygon by planes.
+// Compute the perimeter moments of a Polygon, optionally fused with the area
+// moments (zerothMoment == nullptr skips those).
 //------------------------------------------------------------------------------
+namespace internal {
+
 template<typename VA>
-void clipPolygon(std::vector<Vertex2d<VA>>& polygon,
-                 const std::vector<Plane<VA>>& planes) {
+void surfaceMomentsImpl(double* zerothMoment,
+                        typename VA::VECTOR* firstMoment,
+                        double& totalLength,
+                        std::vector<double>& edgeLengths,
+                        std::vector<typename VA::VECTOR>& edgeCentroids,
+                        std::vector<typename VA::VECTOR>& edgeNormals,
+                        const std::vector<Vertex2d<VA>>& polygon) {
+
+  const double nearlyZero = 1.0e-15;
+  const auto computeArea = zerothMoment != nullptr;
+
+  // Clear the result for accumulation.
+  totalLength = 0.0;
+  edgeLengths.clear();
+  edgeCentroids.clear();
+  edgeNormals.clear();
+  if (computeArea) {
+    *zerothMoment = 0.0;
+    *firstMoment = VA::Vector(0.0, 0.0);
+  }
+  if (polygon.size() < 3) return;       // Require at least a triangle
+
+  const auto edges = extractFaces(polygon);
+  const auto nedges = edges.size();
+  edgeLengths.resize(nedges);
+  edgeCentroids.resize(nedges);
+  edgeNormals.resize(nedges);
+  const auto& p0 = polygon[0].position;
+  for (auto k = 0u; k < nedges; ++k) {
+    const auto& p1 = polygon[edges[k][0]].position;
+    const auto& p2 = polygon[edges[k][1]].position;
+    const auto dp = VA::sub(p2, p1);
+    edgeLengths[k] = VA::magnitude(dp);
+    edgeCentroids[k] = VA::mul(VA::add(p1, p2), 0.5);
+    edgeNormals[k] = VA::unitVector(VA::Vector(VA::y(dp), -VA::x(dp)));
+    totalLength += edgeLengths[k];
+
+    // Area moments, as in moments.
+    if (computeArea) {
+      const auto triA = VA::crossmag(VA::sub(p1, p0), VA::sub(p2, p0));
+      *zerothMoment += triA;
+      VA::iadd(*firstMoment, VA::mul(VA::sub(VA::add(p1, p2), VA::mul(p0, 2.0)), triA));
+    }
+  }
+  if (computeArea) {
+    VA::idiv(*firstMoment, 3.0*std::max(nearlyZero, *zerothMoment));
+    VA::iadd(*firstMoment, p0);
+    *zerothMoment *= 0.5;
+  }
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Compute the perimeter moments of a Polygon.
+//------------------------------------------------------------------------------
+template<typename VA>
+void surfaceMoments(double& totalLength,
+                    std::vector<double>& edgeLengths,
+                    std::vector<typename VA::VECTOR>& edgeCentroids,
+                    std::vector<typename VA::VECTOR>& edgeNormals,
+                    const std::vector<Vertex2d<VA>>& polygon) {
+  internal::surfaceMomentsImpl(static_cast<double*>(nullptr), static_cast<typename VA::VECTOR*>(nullptr),
+                               totalLength, edgeLengths, edgeCentroids, edgeNormals, polygon);
+}
+
+//------------------------------------------------------------------------------
+// Compute the area and perimeter moments of a Polygon together.
+//------------------------------------------------------------------------------
+template<typename VA>
+void surfaceMoments(double& zerothMoment,
+                    typename VA::VECTOR& firstMoment,
+                    double& totalLength,
+                    std::vector<double>& edgeLengths,
+                    std::vector<typename VA::VECTOR>& edgeCentroids,
+                    std::vector<typename VA::VECTOR>& edgeNormals,
+                    const std::vector<Vertex2d<VA>>& polygon) {
+  internal::surfaceMomentsImpl(&zerothMoment, &firstMoment,
+                               totalLength, edgeLengths, edgeCentroids, edgeNormals, polygon);
+}
+
+//------------------------------------------------------------------------------
+// Compute the axisymmetric (RZ) zeroth and first moments of a Polygon.
+// We walk the same triangle fan as moments, integrating exactly with the
+// radius r = y over each triangle:
+//   int r dA   = A/3  (r0 + r1 + r2)
+//   int x r dA = A/12 [(x0 + x1 + x2)(r0 + r1 + r2) + x0 r0 + x1 r1 + x2 r2]
+// with x measured relative to the fan origin.
+//------------------------------------------------------------------------------
+template<typename VA>
+void rzMoments(double& zerothMoment, typename VA::VECTOR& firstMoment,
+               const std::vector<Vertex2d<VA>>& polygon) {
+
+  const double nearlyZero = 1.0e-15;
+  const double pi = std::acos(-1.0);
+
+  // Clear the result for accumulation.
+  zerothMoment = 0.0;
+  double xmom = 0.0, rmom = 0.0;
+  firstMoment = VA::Vector(0.0, 0.0);
+
+  // Walk the polygon, and add up our results triangle by triangle.
+  if (polygon.size() > 2) {             // Require at least a triangle
+    const auto& p0 = polygon[0].position;
+    const auto r0 = VA::y(p0);
+    for (const auto& v1: polygon) {
+      const auto& p1 = v1.position;
+      const auto& p2 = polygon[v1.neighbors.second].position;
+      const auto triA = VA::crossmag(VA::sub(p1, p0), VA::sub(p2, p0));   // 2A
+      const auto x1 = VA::x(p1) - VA::x(p0), x2 = VA::x(p2) - VA::x(p0);
+      const auto r1 = VA::y(p1), r2 = VA::y(p2);
+      const auto rsum = r0 + r1 + r2;
+      zerothMoment += triA*rsum;                                            // 6x
+      xmom += triA*((x1 + x2)*rsum + x1*r1 + x2*r2);                        // 24x
+      rmom += triA*(rsum*rsum + r0*r0 + r1*r1 + r2*r2);                     // 24x
+    }
+    firstMoment = VA::Vector(VA::x(p0) + xmom/(4.0*std::max(nearlyZero, zerothMoment)),
+                             rmom/(4.0*std::max(nearlyZero, zerothMoment)));
+    zerothMoment *= pi/3.0;                                                 // 2 pi int r dA
+  }
+}
+
+//------------------------------------------------------------------------------
+// Compute the RZ moments of a batch of polygons.
+//------------------------------------------------------------------------------
+template<typename VA>
+void rzMoments(std::vector<double>& zerothMoments,
+               std::vector<typename VA::VECTOR>& firstMoments,
+               const std::vector<std::vector<Vertex2d<VA>>>& polygons) {
+  const auto n = polygons.size();
+  zerothMoments.resize(n);
+  firstMoments.resize(n);
+  for (auto k = 0u; k < n; ++k) rzMoments(zerothMoments[k], firstMoments[k], polygons[k]);
+}
+
+//------------------------------------------------------------------------------
+// Clip a copy of a polygon and return the RZ moments of the result.
+//------------------------------------------------------------------------------
+template<typename VA>
+void clippedRZMoments(double& zerothMoment, typename VA::VECTOR& firstMoment,
+                      const std::vector<Vertex2d<VA>>& polygon,
+                      const std::vector<Plane<VA>>& planes) {
+  auto clipped = polygon;
+  clipPolygon(clipped, planes);
+  rzMoments(zerothMoment, firstMoment, clipped);
+}
+
+//------------------------------------------------------------------------------
+// Batched version of clippedRZMoments: clip a polygon by each set of planes,
+// reusing a single work polygon.
+//------------------------------------------------------------------------------
+template<typename VA>
+void clippedRZMoments(std::vector<double>& zerothMoments,
+                      std::vector<typename VA::VECTOR>& firstMoments,
+                      const std::vector<Vertex2d<VA>>& polygon,
+                      const std::vector<std::vector<Plane<VA>>>& planeSets) {
+  const auto n = planeSets.size();
+  zerothMoments.resize(n);
+  firstMoments.resize(n);
+  std::vector<Vertex2d<VA>> clipped;
+  for (auto k = 0u; k < n; ++k) {
+    clipped = polygon;
+    clipPolygon(clipped, planeSets[k]);
+    rzMoments(zerothMoments[k], firstMoments[k], clipped);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Clip a polygon by planes, optionally tracking the edges created by each
+// plane (cutFaces == nullptr skips all of that bookkeeping).  If field is
+// given we instead make a single pass (with one plane, used only for its ID)
+// classifying the vertices by the field values and interpolating them along
+// the edges.  If meshCut is also given the polygon is a mesh cell, and the
+// new vertices take the shared points on its edges by global ID.
+//------------------------------------------------------------------------------
+namespace internal {
+
+template<typename VA>
+void clipPolygonImpl(std::vector<Vertex2d<VA>>& polygon,
+                     const std::vector<Plane<VA>>& planes,
+                     std::vector<CutFace<VA>>* cutFaces,
+                     const std::vector<double>* field,
+                     MeshCut<VA>* meshCut) {
 
   // Useful types.
   using Vector = typename VA::VECTOR;
@@ -240,12 +702,19 @@ void clipPolygon(std::vector<Vertex2d<VA>>& polygon,
 #endif
 
   // Check the input.
+  PCASSERT(field == nullptr or (planes.size() == 1u and field->size() == polygon.size()));
+  PCASSERT(meshCut == nullptr or (field != nullptr and meshCut->ids.size() == polygon.size()));
   double V0;
   Vector C0;
   moments(V0, C0, polygon);
   if (V0 < nearlyZero) polygon.clear();
   // cerr << "Initial polygon: " << polygon2string(polygon) << " " << V0 << endl;
 
+  // Prepare the cut edges (pairs of vertex indices) for each plane.
+  const auto trackCutFaces = cutFaces != nullptr;
+  std::map<std::pair<int, int>, int> edgeVertices;
+  if (trackCutFaces) cutFaces->assign(planes.size(), CutFace<VA>());
+
   // Find the bounding box of the polygon.
   auto xmin = std::numeric_limits<double>::max(), xmax = std::numeric_limits<double>::lowest();
   auto ymin = std::numeric_limits<double>::max(), ymax = std::numeric_limits<double>::lowest();
@@ -264,7 +733,7 @@ void clipPolygon(std::vector<Vertex2d<VA>>& polygon,
     // cerr << "Clip plane: " << plane.dist << " " << VA::str(plane.normal) << endl;
 
     // First check against the bounding box.
-    auto boxcomp = internal::compare(plane, xmin, ymin, xmax, ymax);
+    auto boxcomp = field == nullptr ? internal::compare(plane, xmin, ymin, xmax, ymax) : 0;
     auto above = boxcomp ==  1;
     auto below = boxcomp == -1;
     PCASSERT2(not (above and below), internal::dumpSerializedState(initial_state));
@@ -273,8 +742,9 @@ void clipPolygon(std::vector<Vertex2d<VA>>& polygon,
     if (not (above or below)) {
       above = true;
       below = true;
-      for (auto& v: polygon) {
-        v.comp = internal::compare<VA>(plane, v.position);
+      for (auto i = 0u; i < polygon.size(); ++i) {
+        auto& v = polygon[i];
+        v.comp = (field == nullptr ? internal::compare<VA>(plane, v.position) : internal::compare((*field)[i]));
         if (v.comp == 1) {
           below = false;
         } else if (v.comp == -1) {
@@ -296,6 +766,7 @@ void clipPolygon(std::vector<Vertex2d<VA>>& polygon,
       // Insert any new vertices.
       vector<int> hangingVertices;
       int vprev, vnext, vnew;
+      edgeVertices.clear();
       const auto nverts0 = polygon.size();
       for (auto v = 0; v < nverts0; ++v) {
         std::tie(vprev, vnext) = polygon[v].neighbors;
@@ -312,12 +783,26 @@ void clipPolygon(std::vector<Vertex2d<VA>>& polygon,
         if ((polygon[v].comp)*(polygon[vnext].comp) == -1) {
           // This pair straddles the plane and creates a new vertex.
           vnew = polygon.size();
-          polygon.push_back(Vertex(internal::segmentPlaneIntersection(polygon[v].position,
-                                                                      polygon[vnext].position,
-                                                                      plane),
-                                   2));         // 2 indicates new vertex
+          if (meshCut != nullptr) {
+            const auto& ids = meshCut->ids;
+            meshCut->ids.push_back(polygon[v].comp == -1 ?
+                                   meshCut->edgePoint(ids[v], ids[vnext]) :
+                                   meshCut->edgePoint(ids[vnext], ids[v]));
+            polygon.push_back(Vertex(meshCut->points[meshCut->ids.back()], 2));
+          } else {
+            polygon.push_back(Vertex(field == nullptr ?
+                                     internal::segmentPlaneIntersection(polygon[v].position,
+                                                                        polygon[vnext].position,
+                                                                        plane) :
+                                     internal::segmentFieldIntersection<VA>(polygon[v].position,
+                                                                            polygon[vnext].position,
+                                                                            (*field)[v],
+                                                                            (*field)[vnext]),
+                                     2));         // 2 indicates new vertex
+          }
           polygon[vnew].neighbors = {v, vnext};
           polygon[vnew].clips.insert(plane.ID);
+          if (trackCutFaces) edgeVertices[std::make_pair(std::min(v, vnext), std::max(v, vnext))] = vnew;
           // Patch up clip info for existing clips
           if (polygon[v].comp == -1) {
             for (const auto cp: polygon[v].clips) {
@@ -348,20 +833,93 @@ void clipPolygon(std::vector<Vertex2d<VA>>& polygon,
       // Look for any topology links to clipped nodes we need to patch.
       const auto nverts = polygon.size();
       size_t i, j;
+      vector<int> cutStarts, cutEnds;
       for (i = 0u; i < nverts; ++i) {
         if (polygon[i].comp == 0 or polygon[i].comp == 2) {
 
           // Make sure this vertex links to surviving neighbors.
           j = polygon[i].neighbors.first;
+          if (polygon[j].comp == -1) cutEnds.push_back(i);
           while (polygon[j].comp == -1 and j != i) j = polygon[j].neighbors.first;
           polygon[i].neighbors.first = j;
             
+          // Relinking past clipped vertices forward starts a new cut edge.
           j = polygon[i].neighbors.second;
+          if (polygon[j].comp == -1) cutStarts.push_back(i);
           while (polygon[j].comp == -1 and j != i) j = polygon[j].neighbors.second;
           polygon[i].neighbors.second = j;
         }
       }
 
+      // If a non-convex polygon is cut more than once, walking the old loop can
+      // bridge separate pieces across clipped notches.  The cut edges run along
+      // the plane in the direction (n_y, -n_x) (keeping the retained side to
+      // their left), so sorting along that direction pairs each start with its
+      // end.  We only trust the pairing if starts and ends strictly alternate.
+      // A field clip passes the gradient of a linear field as the plane normal,
+      // while a nonlinear field has no such direction (a zero normal).  Cutting
+      // a convex polygon more than once is then a saddle, and walking the old
+      // loop keeps the retained runs connected.  Clipping by -field would do
+      // the same for the complement, so the two would overlap: instead we only
+      // keep the runs connected if the mean field is positive, and otherwise
+      // close each run on itself.
+      if (field != nullptr and VA::magnitude2(plane.normal) == 0.0) {
+        auto fieldSum = 0.0;
+        for (const auto f: *field) fieldSum += f;
+        if (fieldSum <= 0.0 and cutStarts.size() > 1u and cutStarts.size() == cutEnds.size()) {
+          std::vector<bool> runFirst(nverts, false);
+          for (const auto k: cutEnds) runFirst[k] = true;
+          const auto ncuts = cutStarts.size();
+          auto separate = true;
+          for (auto k = 0u; k < ncuts and separate; ++k) {
+            j = cutStarts[k];
+            while (not runFirst[j]) j = polygon[j].neighbors.first;
+            separate = int(j) != cutStarts[k];
+            cutEnds[k] = j;
+          }
+          if (separate) {
+            for (auto k = 0u; k < ncuts; ++k) {
+              polygon[cutStarts[k]].neighbors.second = cutEnds[k];
+              polygon[cutEnds[k]].neighbors.first = cutStarts[k];
+            }
+          }
+        }
+      } else if (cutStarts.size() > 1u and cutStarts.size() == cutEnds.size()) {
+        const auto direction = VA::Vector(VA::y(plane.normal), -VA::x(plane.normal));
+        auto along = [&](const int a, const int b) { return VA::dot(polygon[a].position, direction) < VA::dot(polygon[b].position, direction); };
+        std::sort(cutStarts.begin(), cutStarts.end(), along);
+        std::sort(cutEnds.begin(), cutEnds.end(), along);
+        const auto ncuts = cutStarts.size();
+        auto alternate = true;
+        for (auto k = 0u; k < ncuts and alternate; ++k) {
+          alternate = (cutStarts[k] != cutEnds[k] and
+                       not along(cutEnds[k], cutStarts[k]) and
+                       (k + 1u == ncuts or not along(cutStarts[k + 1u], cutEnds[k])));
+        }
+        if (alternate) {
+          for (auto k = 0u; k < ncuts; ++k) {
+            polygon[cutStarts[k]].neighbors.second = cutEnds[k];
+            polygon[cutEnds[k]].neighbors.first = cutStarts[k];
+          }
+        }
+      }
+
+      if (trackCutFaces) {
+        // Clip the edges from prior planes.
+        for (auto kprev = 0; kprev < kplane - 1; ++kprev) {
+          auto& loops = (*cutFaces)[kprev].loops;
+          for (auto& loop: loops) internal::clipVertexLoop(loop, polygon, edgeVertices, false);
+          loops.erase(std::remove_if(loops.begin(), loops.end(), [](const vector<int>& loop) { return loop.size() < 2u; }), loops.end());
+        }
+
+        // Add the new edges for this plane.
+        for (const auto istart: cutStarts) {
+          if (polygon[istart].neighbors.second != istart) {
+            (*cutFaces)[kplane - 1].loops.push_back(vector<int>({istart, polygon[istart].neighbors.second}));
+          }
+        }
+      }
+
       // // For each hanging vertex, link to the neighbors that survive the clipping.
       // // If there are more than two hanging vertices, we've clipped a non-convex face and need to check
       // // how to hook up each section, possibly resulting in new faces.
@@ -431,6 +989,15 @@ void clipPolygon(std::vector<Vertex2d<VA>>& polygon,
         }
       }
 
+      // Renumber the cut edges.
+      if (trackCutFaces) {
+        for (auto kprev = 0; kprev < kplane; ++kprev) {
+          for (auto& loop: (*cutFaces)[kprev].loops) {
+            for (auto& iv: loop) iv = polygon[iv].ID;
+          }
+        }
+      }
+
       // Find the vertices to remove, and renumber the neighbors.
       if (nkill > 0u) {
         vector<int> verts2kill;
@@ -443,6 +1010,7 @@ void clipPolygon(std::vector<Vertex2d<VA>>& polygon,
           }
         }
         internal::removeElements(polygon, verts2kill);
+        if (meshCut != nullptr) internal::removeElements(meshCut->ids, verts2kill);
       }
 
       // cerr << "After compression: " << polygon2string(polygon) << endl;
@@ -468,69 +1036,455 @@ void clipPolygon(std::vector<Vertex2d<VA>>& polygon,
       }
     }
   }
+  if (meshCut != nullptr and polygon.empty()) meshCut->ids.clear();
+
+  // Measure the surviving cut edges.  We use the signed length along the plane
+  // direction, so any edges bridged across a non-convex notch cancel.
+  if (trackCutFaces) {
+    for (auto kp = 0u; kp < nplanes; ++kp) {
+      auto& cutFace = (*cutFaces)[kp];
+      if (polygon.empty()) cutFace.loops.clear();
+      const auto direction = VA::Vector(VA::y(planes[kp].normal), -VA::x(planes[kp].normal));
+      cutFace.area = 0.0;
+      cutFace.centroid = VA::Vector(0.0, 0.0);
+      for (const auto& loop: cutFace.loops) {
+        const auto& p0 = polygon[loop[0]].position;
+        const auto& p1 = polygon[loop[1]].position;
+        const auto dL = VA::dot(VA::sub(p1, p0), direction);
+        cutFace.area += dL;
+        VA::iadd(cutFace.centroid, VA::mul(VA::add(p0, p1), dL));
+      }
+      VA::imul(cutFace.centroid, internal::safeInv(2.0*cutFace.area));
+    }
+  }
+}
+
 }
 
 //------------------------------------------------------------------------------
-// Collapse degenerate vertices.
+// Clip a polygon by planes.
+//------------------------------------------------------------------------------
+template<typename VA>
+void clipPolygon(std::vector<Vertex2d<VA>>& polygon,
+                 const std::vector<Plane<VA>>& planes) {
+  internal::clipPolygonImpl(polygon, planes, static_cast<std::vector<CutFace<VA>>*>(nullptr), static_cast<const std::vector<double>*>(nullptr), static_cast<internal::MeshCut<VA>*>(nullptr));
+}
+
+//------------------------------------------------------------------------------
+// Clip a polygon by planes, returning the cut edges.
+//------------------------------------------------------------------------------
+template<typename VA>
+void clipPolygon(std::vector<Vertex2d<VA>>& polygon,
+                 const std::vector<Plane<VA>>& planes,
+                 std::vector<CutFace<VA>>& cutFaces) {
+  internal::clipPolygonImpl(polygon, planes, &cutFaces, static_cast<const std::vector<double>*>(nullptr), static_cast<internal::MeshCut<VA>*>(nullptr));
+}
+
+//------------------------------------------------------------------------------
+// Reduce a set of planes for clipping a polygon.  Two planes are merged if their
+// signed distances differ by less than tol at every vertex of the polygon, in
+// which case the first is kept.  A merged plane is then needed only if it cuts
+// more than tol into the convex hull of the polygon above the other planes,
+// which we check without clipping: the dual hull about an interior point prunes
+// most of them, and a small linear program checks each of the rest.  If the
+// result is empty we can't tell which planes are needed, and keep them all.
+//------------------------------------------------------------------------------
+template<typename VA>
+void simplifyPlanes(std::vector<Plane<VA>>& result,
+                    std::vector<int>& planeMap,
+                    const std::vector<Vertex2d<VA>>& poly,
+                    const std::vector<Plane<VA>>& planes,
+                    const double tol) {
+  const int nplanes = planes.size();
+  const int nverts = poly.size();
+  result.clear();
+  planeMap.assign(nplanes, -1);
+  if (nverts == 0) return;
+
+  // Merge the coplanar planes.
+  vector<double> dist(nplanes*nverts);
+  for (auto k = 0; k < nplanes; ++k) {
+    for (auto i = 0; i < nverts; ++i) dist[k*nverts + i] = planes[k].dist + VA::dot(planes[k].normal, poly[i].position);
+  }
+  vector<int> rep(nplanes);
+  vector<Plane<VA>> merged;
+  for (auto k = 0; k < nplanes; ++k) {
+    rep[k] = k;
+    for (auto j = 0; j < k and rep[k] == k; ++j) {
+      if (rep[j] == j and VA::dot(planes[j].normal, planes[k].normal) > 0.0) {
+        auto i = 0;
+        while (i < nverts and std::abs(dist[k*nverts + i] - dist[j*nverts + i]) < tol) ++i;
+        if (i == nverts) rep[k] = j;
+      }
+    }
+    if (rep[k] == k) merged.push_back(planes[k]);
+  }
+
+  // Planes above every vertex are redundant, while one below every vertex
+  // leaves nothing.
+  const int nmerged = merged.size();
+  vector<int> mergedIndex(nplanes, -1), resultIndex(nmerged, -1), redundant(nmerged, 0);
+  auto empty = false;
+  for (auto k = 0, m = 0; k < nplanes; ++k) {
+    if (rep[k] == k) {
+      mergedIndex[k] = m;
+      const auto minmax = std::minmax_element(&dist[k*nverts], &dist[(k + 1)*nverts]);
+      redundant[m] = (*minmax.first >= -tol);
+      empty = empty or (*minmax.second <= 0.0);
+      ++m;
+    }
+  }
+
+  // Check the rest over the convex hull of the polygon.
+  if (not empty) {
+    vector<typename VA::VECTOR> points;
+    for (const auto& v: poly) points.push_back(v.position);
+    vector<Vertex2d<VA>> hull;
+    convexHull(hull, points);
+    vector<Plane<VA>> bounds;
+    auto xmin = poly[0].position, xmax = poly[0].position;
+    for (const auto& v: hull) {
+      const auto edge = VA::sub(hull[v.neighbors.second].position, v.position);
+      bounds.push_back(Plane<VA>(v.position, VA::unitVector(VA::Vector(-VA::y(edge), VA::x(edge)))));
+      VA::x(xmin) = std::min(VA::x(xmin), VA::x(v.position));
+      VA::y(xmin) = std::min(VA::y(xmin), VA::y(v.position));
+      VA::x(xmax) = std::max(VA::x(xmax), VA::x(v.position));
+      VA::y(xmax) = std::max(VA::y(xmax), VA::y(v.position));
+    }
+    const auto center = VA::mul(VA::add(xmin, xmax), 0.5);
+    const auto halfWidth = 0.5*std::max(VA::x(xmax) - VA::x(xmin), VA::y(xmax) - VA::y(xmin));
+
+    // About an interior point, a plane (or bound) is needed only if its dual
+    // point is a vertex of the dual hull, which leaves just a few for the
+    // linear programs.
+    const int nbounds = bounds.size();
+    vector<Plane<VA>> active(bounds);
+    vector<int> activeIndex(nbounds, -1);
+    for (auto m = 0; m < nmerged; ++m) {
+      if (not redundant[m]) {
+        active.push_back(merged[m]);
+        activeIndex.push_back(m);
+      }
+    }
+    auto x0 = center;
+    double radius;
+    empty = (hull.size() < 3 or
+             not internal::inscribedBall(x0, radius, active, center, halfWidth, 2));
+    if (not empty and radius > tol) {
+      vector<typename VA::VECTOR> dual;
+      auto qmax = 0.0;
+      for (const auto& plane: active) {
+        dual.push_back(VA::div(VA::neg(plane.normal), plane.dist + VA::dot(plane.normal, x0)));
+        qmax = std::max(qmax, VA::magnitude(dual.back()));
+      }
+      const auto vertices = internal::convexHullVertices<VA>(dual, 1.0e-10*qmax);
+      if (vertices.size() >= 3u) {
+        vector<int> onHull(active.size(), 0);
+        for (const auto i: vertices) onHull[i] = 1;
+        bounds.clear();
+        for (auto i = 0; i < int(active.size()); ++i) {
+          if (i < nbounds and onHull[i]) bounds.push_back(active[i]);
+          if (i >= nbounds and not onHull[i]) redundant[activeIndex[i]] = 1;
+        }
+      }
+    }
+    empty = (empty or
+             not internal::flagRedundantPlanes(redundant, merged, bounds, center, halfWidth, 2, tol));
+  }
+  for (auto m = 0; m < nmerged; ++m) {
+    if (empty or not redundant[m]) {
+      resultIndex[m] = result.size();
+      result.push_back(merged[m]);
+    }
+  }
+  for (auto k = 0; k < nplanes; ++k) planeMap[k] = resultIndex[mergedIndex[rep[k]]];
+}
+
+//------------------------------------------------------------------------------
+// Check whether clipping a polygon by planes leaves a non-zero area.  Most
+// queries are answered by the vertex distances alone: the result is empty if
+// every vertex is below any one plane, and not if some vertex is above all of
+// them.  Otherwise a convex polygon is the region above its edges, so we look
+// for a disk above both its edges and the planes by linear programming.  A
+// non-convex polygon falls back to clipping a copy.
+//------------------------------------------------------------------------------
+template<typename VA>
+bool intersectsHalfspaces(const std::vector<Vertex2d<VA>>& poly,
+                          const std::vector<Plane<VA>>& planes) {
+  const int nverts = poly.size();
+  if (nverts < 3) return false;
+  auto xmin = poly[0].position, xmax = poly[0].position;
+  for (const auto& v: poly) {
+    VA::x(xmin) = std::min(VA::x(xmin), VA::x(v.position));
+    VA::y(xmin) = std::min(VA::y(xmin), VA::y(v.position));
+    VA::x(xmax) = std::max(VA::x(xmax), VA::x(v.position));
+    VA::y(xmax) = std::max(VA::y(xmax), VA::y(v.position));
+  }
+  const auto extent = VA::magnitude(VA::sub(xmax, xmin));
+  if (extent == 0.0) return false;
+  const auto tol = 1.0e-10*extent;
+
+  // Check the vertices against each plane.
+  vector<double> minDist(nverts, std::numeric_limits<double>::max());
+  for (const auto& plane: planes) {
+    auto maxDist = std::numeric_limits<double>::lowest();
+    for (auto i = 0; i < nverts; ++i) {
+      const auto di = plane.dist + VA::dot(plane.normal, poly[i].position);
+      maxDist = std::max(maxDist, di);
+      minDist[i] = std::min(minDist[i], di);
+    }
+    if (maxDist <= tol) return false;
+  }
+  for (auto i = 0; i < nverts; ++i) {
+    if (minDist[i] > tol) return true;
+  }
+
+  // Collect the edge planes, checking the polygon is convex.
+  vector<Plane<VA>> halfspaces(planes);
+  auto convex = true;
+  for (auto i = 0; i < nverts and convex; ++i) {
+    const auto& p = poly[i].position;
+    const auto edge = VA::sub(poly[poly[i].neighbors.second].position, p);
+    const auto len = VA::magnitude(edge);
+    if (len <= tol) continue;
+    halfspaces.push_back(Plane<VA>(p, VA::Vector(-VA::y(edge)/len, VA::x(edge)/len)));
+    for (auto j = 0; j < nverts and convex; ++j) convex = halfspaces.back().dist + VA::dot(halfspaces.back().normal, poly[j].position) >= -tol;
+  }
+  if (not convex) {
+    auto clipped = poly;
+    clipPolygon(clipped, planes);
+    double area;
+    typename VA::VECTOR centroid;
+    moments(area, centroid, clipped);
+    return area > tol*extent;
+  }
+  const auto center = VA::mul(VA::add(xmin, xmax), 0.5);
+  const auto halfWidth = 0.5*std::max(VA::x(xmax) - VA::x(xmin), VA::y(xmax) - VA::y(xmin));
+  return internal::planesEncloseVolume(halfspaces, center, halfWidth, 2, tol);
+}
+
+//------------------------------------------------------------------------------
+// Clip a polygon by a field sampled at its vertices.
+//------------------------------------------------------------------------------
+template<typename VA>
+void clipByVertexField(std::vector<Vertex2d<VA>>& polygon,
+                       const std::vector<double>& field,
+                       const int ID) {
+  // A linear field is the distance to a plane, whose normal lets the clip pair
+  // up the cut edges of a non-convex polygon.  A nonlinear field has no such
+  // direction, and walking the old loop only keeps the cut edges inside a
+  // convex polygon.
+  auto normal = VA::Vector(0.0, 0.0);
+  if (internal::linearFieldGradient<VA>(normal, polygon, field, 2) and
+      VA::magnitude2(normal) > 0.0) normal = VA::unitVector(normal);
+  PCASSERT2(VA::magnitude2(normal) > 0.0 or
+            not internal::fieldChangesSign(field) or
+            internal::isConvex(polygon),
+            "clipByVertexField: a nonlinear field can only cut a convex polygon");
+  internal::clipPolygonImpl(polygon,
+                            std::vector<Plane<VA>>(1, Plane<VA>(0.0, normal, ID)),
+                            static_cast<std::vector<CutFace<VA>>*>(nullptr),
+                            &field,
+                            static_cast<internal::MeshCut<VA>*>(nullptr));
+}
+
+//------------------------------------------------------------------------------
+// Clip a mesh by a plane.  We compute the signed distance of each mesh point
+// once, and each cell is clipped classifying its vertices by the distances of
+// their global IDs.  The new point on each crossing edge is computed by the
+// first cell to cut it and cached by its (clipped, surviving) pair of global
+// IDs, so the other cells sharing the edge reuse the same point.
+//------------------------------------------------------------------------------
+template<typename VA>
+void clipMesh(std::vector<std::vector<Vertex2d<VA>>>& cells,
+              std::vector<std::vector<int>>& cellVertices,
+              std::vector<typename VA::VECTOR>& points,
+              const Plane<VA>& plane) {
+  const auto ncells = cells.size();
+  PCASSERT(cellVertices.size() == ncells);
+  const auto npoints = points.size();
+  vector<double> dist(npoints), field;
+  for (auto k = 0u; k < npoints; ++k) dist[k] = plane.dist + VA::dot(plane.normal, points[k]);
+  internal::MeshCut<VA> meshCut(points, dist);
+  const vector<Plane<VA>> planes(1, plane);
+  for (auto c = 0u; c < ncells; ++c) {
+    auto& ids = cellVertices[c];
+    const auto n = ids.size();
+    PCASSERT(cells[c].size() == n);
+    field.resize(n);
+    for (auto i = 0u; i < n; ++i) field[i] = dist[ids[i]];
+    meshCut.ids.swap(ids);
+    internal::clipPolygonImpl(cells[c], planes, static_cast<std::vector<CutFace<VA>>*>(nullptr), &field, &meshCut);
+    meshCut.ids.swap(ids);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Assemble a conforming mesh from independent polygons.  All the vertices are
+// welded to the first member of their class within tol (found with a spatial
+// hash), each class taking the position of that member.  Edges are then matched by their (sorted) pair of welded
+// vertices: the first cell to see an edge owns it, and the second is recorded
+// as its neighbor.
+//------------------------------------------------------------------------------
+template<typename VA>
+void assembleMesh(ConformingMesh<VA>& mesh,
+                  const std::vector<std::vector<Vertex2d<VA>>>& cells,
+                  const double tol) {
+  mesh = ConformingMesh<VA>();
+  const auto ncells = cells.size();
+
+  // Weld the vertices.
+  vector<typename VA::VECTOR> positions;
+  for (const auto& cell: cells) {
+    for (const auto& v: cell) positions.push_back(v.position);
+  }
+  vector<int> labels;
+  internal::weldPoints<VA>(labels, mesh.points, positions, tol);
+
+  // Walk the edges of each cell.
+  map<std::pair<int, int>, int> edgeIDs;
+  mesh.cellVertexOffsets.push_back(0);
+  mesh.cellFaceOffsets.push_back(0);
+  mesh.faceVertexOffsets.push_back(0);
+  auto offset = 0;
+  for (auto c = 0u; c < ncells; ++c) {
+    const auto& cell = cells[c];
+    const auto n = cell.size();
+    for (auto i = 0u; i < n; ++i) mesh.cellVertices.push_back(labels[offset + i]);
+    for (auto i = 0u; i < n; ++i) {
+      const auto a = labels[offset + i], b = labels[offset + cell[i].neighbors.second];
+      if (a == b) continue;
+      const auto key = std::make_pair(std::min(a, b), std::max(a, b));
+      const auto itr = edgeIDs.find(key);
+      if (itr == edgeIDs.end()) {
+        const int f = mesh.faceCells.size()/2;
+        edgeIDs[key] = f;
+        mesh.faceVertices.push_back(a);
+        mesh.faceVertices.push_back(b);
+        mesh.faceVertexOffsets.push_back(mesh.faceVertices.size());
+        mesh.faceCells.push_back(c);
+        mesh.faceCells.push_back(-1);
+        mesh.cellFaces.push_back(f);
+      } else {
+        const auto f = itr->second;
+        PCASSERT2(mesh.faceCells[2*f + 1] == -1, "assembleMesh: edge shared by more than two cells");
+        mesh.faceCells[2*f + 1] = c;
+        mesh.cellFaces.push_back(~f);
+      }
+    }
+    mesh.cellVertexOffsets.push_back(mesh.cellVertices.size());
+    mesh.cellFaceOffsets.push_back(mesh.cellFaces.size());
+    offset += n;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Weld the vertices of a set of polygons.  Each vertex joins the class of the
+// nearest earlier class representative within tol (found with a spatial hash)
+// and is snapped to it, so vertices in the same class end up with identical
+// positions, and never more than tol from where they started.
+//------------------------------------------------------------------------------
+template<typename VA>
+int weldVertices(std::vector<std::vector<Vertex2d<VA>>>& polys,
+                 const double tol,
+                 std::vector<std::vector<int>>& vertexClasses) {
+  vector<typename VA::VECTOR> positions, representatives;
+  for (const auto& poly: polys) {
+    for (const auto& v: poly) positions.push_back(v.position);
+  }
+  vector<int> labels;
+  const auto nclasses = internal::weldPoints<VA>(labels, representatives, positions, tol);
+  vertexClasses.resize(polys.size());
+  auto k = 0;
+  for (auto i = 0u; i < polys.size(); ++i) {
+    auto& poly = polys[i];
+    vertexClasses[i].resize(poly.size());
+    for (auto j = 0u; j < poly.size(); ++j) {
+      vertexClasses[i][j] = labels[k];
+      poly[j].position = representatives[labels[k]];
+      ++k;
+    }
+  }
+  return nclasses;
+}
+
+//------------------------------------------------------------------------------
+// Collapse degenerate vertices.  We walk each ring once, merging each vertex
+// into the current cluster if it is within tol of the first vertex of that
+// cluster, so a finely sampled curve is thinned rather than collapsed.  The
+// first vertex takes the clips of its cluster and links across the edge
+// leaving it, and a ring left with fewer than three clusters is removed.
+// vertexMap reports the output vertex each input vertex was merged into (-1
+// if removed).
 //------------------------------------------------------------------------------
 template<typename VA>
 void collapseDegenerates(std::vector<Vertex2d<VA>>& polygon,
-                         const double tol) {
+                         const double tol,
+                         std::vector<int>& vertexMap) {
 
   using VertexType = Vertex2d<VA>;
 
   const auto tol2 = tol*tol;
-  auto n = polygon.size();
+  const int n = polygon.size();
+  vertexMap.resize(n);
+  for (auto i = 0; i < n; ++i) vertexMap[i] = i;
   if (n > 0) {
 
-    // Set the initial ID's the vertices.
-    for (auto i = 0; i < n; ++i) polygon[i].ID = i;
-
-    // Walk the polygon removing degenerate edges until we make a sweep without
-    // removing any.
-    auto done = false;
+    // Walk each ring from its lowest indexed vertex, merging each vertex into
+    // the current cluster if it is within tol of the first vertex of the
+    // cluster, and otherwise starting a new one.  The last cluster of the ring
+    // may also merge into the first.
+    for (auto i = 0; i < n; ++i) vertexMap[i] = -1;
+    vector<int> ring;
     auto active = false;
-    while (not done) {
-      done = true;
-      for (auto i = 0; i < n; ++i) {
-        if (polygon[i].ID >= 0) {
-          auto j = polygon[i].neighbors.second;
-          PCASSERT(j != i);
-          PCASSERT(polygon[j].ID >= 0);
-          // if (j==i) throw std::logic_error("got vertex and neighbor identical in collapseDegenerates");
-          // if (polygon[j].ID < 0) throw std::logic_error("polygon[j].ID is negative in collapseDegenerates");
-          if (VA::magnitude2(VA::sub(polygon[i].position, polygon[j].position)) < tol2) {
-            done = false;
+    for (auto i = 0; i < n; ++i) {
+      if (vertexMap[i] == -1) {
+        ring.clear();
+        auto j = i;
+        do {
+          PCASSERT(polygon[j].neighbors.second != j);
+          ring.push_back(j);
+          vertexMap[j] = j;
+          j = polygon[j].neighbors.second;
+        } while (j != i and vertexMap[j] == -1);
+        PCASSERT(j == i);
+        const int m = ring.size();
+        auto r = i;
+        for (auto k = 1; k < m; ++k) {
+          j = ring[k];
+          if (VA::magnitude2(VA::sub(polygon[r].position, polygon[j].position)) < tol2) {
+            vertexMap[j] = r;
             active = true;
-            polygon[j].ID = -1;
-            int numAttempts = 0;
-            while (polygon[j].ID < 0) {
-              polygon[i].clips.insert(polygon[j].clips.begin(), polygon[j].clips.end());
-              j = polygon[j].neighbors.second;
-              ++numAttempts;
-              // With the clang-xlf compiler, it's possible to get an infinite loop
-              // here if the neighbor patter of the input polygon is bad. It would
-              // be better to verify that the neighbor pattern is valid before attempting
-              // to collapse degenerates. This is a workaround.
-              if (numAttempts > 100) {
-                 /*
-                 for (int k=0; k<n; ++k) {
-                     std::cout << "  orig k = " << k << ", ID = " << copyPoly[k].ID
-                       << ", n first = " << copyPoly[k].neighbors.first
-                       << ", n second = " << copyPoly[k].neighbors.second
-                       << ", pos = ("
-                       << std::scientific << std::setprecision(15) << copyPoly[k].position.x
-                       << ", "
-                       << std::scientific << std::setprecision(15) << copyPoly[k].position.y
-                       << ") " << std::endl;
-                 }
-                 */
-
-                 throw std::logic_error("too many attempts in collapseDegenerates");
-              }
+          } else {
+            r = j;
+          }
+        }
+        if (r != i and VA::magnitude2(VA::sub(polygon[r].position, polygon[i].position)) < tol2) {
+          for (auto k = m - 1; k > 0 and vertexMap[ring[k]] == r; --k) vertexMap[ring[k]] = i;
+          active = true;
+        }
+
+        // Relink the clusters around the ring, dropping the ring if fewer than
+        // three are left.
+        auto nclusters = 0;
+        for (const auto k: ring) {
+          polygon[k].ID = -1;
+          if (vertexMap[k] == k) ++nclusters;
+        }
+        if (nclusters < 3) {
+          for (const auto k: ring) vertexMap[k] = k;
+          active = true;
+        } else {
+          for (auto k = 0; k < m; ++k) {
+            j = ring[k];
+            r = vertexMap[j];
+            if (r != j) polygon[r].clips.insert(polygon[j].clips.begin(), polygon[j].clips.end());
+            const auto rnext = vertexMap[ring[(k + 1) % m]];
+            if (rnext != r) {
+              polygon[r].neighbors.second = rnext;
+              polygon[rnext].neighbors.first = r;
+              polygon[r].ID = 0;
             }
-            polygon[i].neighbors.second = j;
-            polygon[j].neighbors.first  = i;
           }
         }
       }
@@ -538,23 +1492,26 @@ void collapseDegenerates(std::vector<Vertex2d<VA>>& polygon,
 
     if (active) {
 
-      // Renumber the nodes assuming we're going to clear out the degenerates.
-      auto offset = 0;
+      // Renumber the surviving clusters and clear out the rest.
+      auto nnew = 0;
       for (auto i = 0; i < n; ++i) {
-        if (polygon[i].ID == -1) {
-          --offset;
-        } else {
-          polygon[i].ID += offset;
-        }
+        if (polygon[i].ID == 0) polygon[i].ID = nnew++;
       }
+      for (auto i = 0; i < n; ++i) vertexMap[i] = polygon[vertexMap[i]].ID;
       for (auto& v: polygon) {
-        v.neighbors.first = polygon[v.neighbors.first].ID;
-        v.neighbors.second = polygon[v.neighbors.second].ID;
+        if (v.ID >= 0) {
+          v.neighbors.first = polygon[v.neighbors.first].ID;
+          v.neighbors.second = polygon[v.neighbors.second].ID;
+        }
       }
-
-      // Erase the inactive vertices.
       polygon.erase(remove_if(polygon.begin(), polygon.end(), [](const VertexType& v) { return v.ID < 0; }), polygon.end());
-      if (polygon.size() < 3) polygon.clear();
+      if (polygon.size() < 3) {
+        polygon.clear();
+        vertexMap.assign(n, -1);
+      }
+
+    } else {
+      for (auto i = 0; i < n; ++i) polygon[i].ID = i;
     }
   }
 
@@ -562,15 +1519,70 @@ void collapseDegenerates(std::vector<Vertex2d<VA>>& polygon,
 #ifndef NDEBUG
   {
     const auto n = polygon.size();
-    for (auto i = 0; i < n; ++i) {
-      PCASSERT(polygon[i].ID == i);
-      PCASSERT(polygon[i].neighbors.first < n);
-      PCASSERT(polygon[i].neighbors.second < n);
+    for (auto i = 0u; i < n; ++i) {
+      PCASSERT(polygon[i].ID == int(i));
+      PCASSERT(polygon[i].neighbors.first < int(n));
+      PCASSERT(polygon[i].neighbors.second < int(n));
     }
   }
 #endif
 }
 
+//------------------------------------------------------------------------------
+// Collapse degenerate vertices.
+//------------------------------------------------------------------------------
+template<typename VA>
+void collapseDegenerates(std::vector<Vertex2d<VA>>& polygon,
+                         const double tol) {
+  std::vector<int> vertexMap;
+  collapseDegenerates(polygon, tol, vertexMap);
+}
+
+//------------------------------------------------------------------------------
+// Label the connected components with a union-find over the neighbor links.
+//------------------------------------------------------------------------------
+template<typename VA>
+int splitComponents(std::vector<int>& componentIDs,
+                    const std::vector<Vertex2d<VA>>& poly) {
+  const int n = poly.size();
+  vector<int> parent(n);
+  for (auto i = 0; i < n; ++i) parent[i] = i;
+  for (auto i = 0; i < n; ++i) {
+    internal::unionFindJoin(parent, i, poly[i].neighbors.first);
+    internal::unionFindJoin(parent, i, poly[i].neighbors.second);
+  }
+  return internal::unionFindLabels(componentIDs, parent);
+}
+
+//------------------------------------------------------------------------------
+// Split into compacted components.  The vertices keep their order within each
+// component, and their ID is set to their index in the input polygon.
+//------------------------------------------------------------------------------
+template<typename VA>
+void splitComponents(std::vector<std::vector<Vertex2d<VA>>>& components,
+                     std::vector<double>& zerothMoments,
+                     std::vector<typename VA::VECTOR>& firstMoments,
+                     const std::vector<Vertex2d<VA>>& poly) {
+  vector<int> componentIDs;
+  const auto ncomps = splitComponents(componentIDs, poly);
+  const int n = poly.size();
+  components.assign(ncomps, std::vector<Vertex2d<VA>>());
+  vector<int> local(n);
+  for (auto i = 0; i < n; ++i) {
+    local[i] = components[componentIDs[i]].size();
+    components[componentIDs[i]].push_back(poly[i]);
+  }
+  for (auto i = 0; i < n; ++i) {
+    auto& v = components[componentIDs[i]][local[i]];
+    v.neighbors.first = local[v.neighbors.first];
+    v.neighbors.second = local[v.neighbors.second];
+    v.ID = i;
+  }
+  zerothMoments.resize(ncomps);
+  firstMoments.resize(ncomps);
+  for (auto c = 0; c < ncomps; ++c) moments(zerothMoments[c], firstMoments[c], components[c]);
+}
+
 //------------------------------------------------------------------------------
 // Return the vertices ordered in faces.
 //------------------------------------------------------------------------------
@@ -656,6 +1668,17 @@ vector<vector<int>> splitIntoTriangles(const std::vector<Vertex2d<VA>>& poly,
     ++i;
   }
 
+  // The local turn test can't tell disjoint loops apart, so only fan a single loop.
+  if (convex and n0 > 0) {
+    auto j = poly[0].neighbors.second;
+    auto nloop = 1u;
+    while (j != 0 and nloop <= n0) {
+      j = poly[j].neighbors.second;
+      ++nloop;
+    }
+    convex = (nloop == n0);
+  }
+
   // If the polygon is convex we can just make a fan of triangles from the first point.
   if (convex) {
     const auto& v0 = poly[0].position;
@@ -669,8 +1692,751 @@ vector<vector<int>> splitIntoTriangles(const std::vector<Vertex2d<VA>>& poly,
     return result;
   }
 
-  // PolyClipper::splitIntoTriangles ERROR: non-convex polygons not supported yet.
-  PCASSERT(false);
+  // Otherwise ear clip, and repackage as triples.
+  vector<int> tris;
+  splitIntoTriangles(tris, poly, tol);
+  const auto ntris = tris.size()/3u;
+  for (auto k = 0u; k < ntris; ++k) result.push_back({tris[3u*k], tris[3u*k + 1u], tris[3u*k + 2u]});
+  return result;
+}
+
+namespace internal {
+
+//------------------------------------------------------------------------------
+// Splice a hole loop (clockwise) into an outer loop (counterclockwise) with a
+// bridge from the rightmost hole vertex M to a visible outer vertex P, giving
+// the single loop ... P, M, <hole>, M, P, ...
+//------------------------------------------------------------------------------
+template<typename VA>
+inline
+void
+bridgeHole(vector<int>& outer,
+           const vector<int>& hole,
+           const std::vector<Vertex2d<VA>>& poly) {
+  auto x = [&](const int i) { return VA::x(poly[i].position); };
+  auto y = [&](const int i) { return VA::y(poly[i].position); };
+
+  // The rightmost hole vertex.
+  const auto nh = hole.size();
+  auto mi = 0u;
+  for (auto k = 1u; k < nh; ++k) {
+    if (x(hole[k]) > x(hole[mi])) mi = k;
+  }
+  const auto M = hole[mi];
+  const auto mx = x(M), my = y(M);
+
+  // Cast a ray in +x from M and find the closest outer edge it hits.
+  const auto no = outer.size();
+  auto pi = no;
+  auto ix = std::numeric_limits<double>::max();
+  for (auto k = 0u; k < no; ++k) {
+    const auto a = outer[k], b = outer[(k + 1u) % no];
+    if ((y(a) <= my and y(b) >= my) or (y(b) <= my and y(a) >= my)) {
+      const auto xhit = (y(a) == y(b) ? std::max(x(a), x(b)) : x(a) + (my - y(a))*(x(b) - x(a))/(y(b) - y(a)));
+      if (xhit >= mx and xhit < ix) {
+        ix = xhit;
+        pi = (x(a) >= x(b) ? k : (k + 1u) % no);
+      }
+    }
+  }
+  if (pi == no) return;
+
+  // If any outer vertices lie inside the triangle (M, I, P) they may hide P, in
+  // which case use the one making the smallest angle with the ray.
+  const auto P = outer[pi];
+  const auto I = VA::Vector(ix, my);
+  if (not (x(P) == ix and y(P) == my)) {
+    const auto& pm = poly[M].position;
+    const auto orient = (VA::crossmag(VA::sub(I, pm), VA::sub(poly[P].position, pm)) >= 0.0 ? 1.0 : -1.0);
+    auto best = std::numeric_limits<double>::max();
+    for (auto k = 0u; k < no; ++k) {
+      const auto& p = poly[outer[k]].position;
+      if (outer[k] != P and x(outer[k]) > mx and
+          orient*VA::crossmag(VA::sub(I, pm), VA::sub(p, pm)) >= 0.0 and
+          orient*VA::crossmag(VA::sub(poly[P].position, I), VA::sub(p, I)) >= 0.0 and
+          orient*VA::crossmag(VA::sub(pm, poly[P].position), VA::sub(p, poly[P].position)) >= 0.0) {
+        const auto slope = std::abs(y(outer[k]) - my)/(x(outer[k]) - mx);
+        if (slope < best) {
+          best = slope;
+          pi = k;
+        }
+      }
+    }
+  }
+
+  // Splice.
+  vector<int> merged(outer.begin(), outer.begin() + pi + 1u);
+  for (auto k = 0u; k <= nh; ++k) merged.push_back(hole[(mi + k) % nh]);
+  merged.insert(merged.end(), outer.begin() + pi, outer.end());
+  outer.swap(merged);
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Split a general (possibly non-convex) polygon into triangles, written as flat
+// index triples into tris.  The vertex loops with positive area are outer
+// boundaries, and those with negative area are holes which we bridge into the
+// smallest outer loop containing them before ear clipping.
+//------------------------------------------------------------------------------
+template<typename VA>
+void splitIntoTriangles(std::vector<int>& tris,
+                        const std::vector<Vertex2d<VA>>& poly,
+                        const double tol) {
+  tris.clear();
+  const auto n = poly.size();
+  if (n < 3u) return;
+
+  // Read out the vertex loops.
+  vector<vector<int>> loops;
+  vector<double> areas;
+  vector<int> visited(n, 0);
+  for (auto i = 0u; i < n; ++i) {
+    if (visited[i] == 0) {
+      loops.push_back(vector<int>());
+      auto& loop = loops.back();
+      auto j = int(i);
+      while (visited[j] == 0) {
+        visited[j] = 1;
+        loop.push_back(j);
+        j = poly[j].neighbors.second;
+      }
+      auto area = 0.0;
+      const auto nl = loop.size();
+      for (auto k = 0u; k < nl; ++k) area += VA::crossmag(poly[loop[k]].position, poly[loop[(k + 1u) % nl]].position);
+      areas.push_back(0.5*area);
+    }
+  }
+  const auto nloops = loops.size();
+
+  // Is point p inside loop k (crossing number)?
+  auto inside = [&](const typename VA::VECTOR& p, const int k) {
+    const auto& loop = loops[k];
+    const auto nl = loop.size();
+    auto result = false;
+    for (auto j = 0u; j < nl; ++j) {
+      const auto& a = poly[loop[j]].position;
+      const auto& b = poly[loop[(j + 1u) % nl]].position;
+      if ((VA::y(a) > VA::y(p)) != (VA::y(b) > VA::y(p)) and
+          VA::x(p) < VA::x(a) + (VA::y(p) - VA::y(a))*(VA::x(b) - VA::x(a))/(VA::y(b) - VA::y(a))) result = not result;
+    }
+    return result;
+  };
+
+  // Assign each hole to the smallest outer loop containing it, in order of
+  // decreasing rightmost x so each bridge sees the holes already spliced in.
+  vector<vector<std::pair<double, int>>> holes(nloops);
+  for (auto k = 0u; k < nloops; ++k) {
+    if (areas[k] < 0.0) {
+      auto xmax = -std::numeric_limits<double>::max();
+      auto iright = loops[k][0];
+      for (const auto i: loops[k]) {
+        if (VA::x(poly[i].position) > xmax) {
+          xmax = VA::x(poly[i].position);
+          iright = i;
+        }
+      }
+      auto owner = -1;
+      for (auto j = 0u; j < nloops; ++j) {
+        if (areas[j] > 0.0 and inside(poly[iright].position, j) and
+            (owner == -1 or areas[j] < areas[owner])) owner = j;
+      }
+      if (owner >= 0) holes[owner].push_back(std::make_pair(-xmax, int(k)));
+    }
+  }
+
+  // Ear clip each outer loop with its holes.
+  vector<double> xy;
+  vector<int> ears;
+  for (auto k = 0u; k < nloops; ++k) {
+    if (areas[k] <= 0.0 or loops[k].size() < 3u) continue;
+    auto loop = loops[k];
+    std::sort(holes[k].begin(), holes[k].end());
+    for (const auto& hole: holes[k]) internal::bridgeHole(loop, loops[hole.second], poly);
+    xy.clear();
+    for (const auto i: loop) {
+      xy.push_back(VA::x(poly[i].position));
+      xy.push_back(VA::y(poly[i].position));
+    }
+    ears.clear();
+    internal::earClipLoop(ears, xy);
+    const auto nears = ears.size()/3u;
+    for (auto j = 0u; j < nears; ++j) {
+      const auto& v0 = poly[loop[ears[3u*j]]].position;
+      const auto& v1 = poly[loop[ears[3u*j + 1u]]].position;
+      const auto& v2 = poly[loop[ears[3u*j + 2u]]].position;
+      if (0.5*VA::crossmag(VA::sub(v1, v0), VA::sub(v2, v0)) > tol) {
+        tris.push_back(loop[ears[3u*j]]);
+        tris.push_back(loop[ears[3u*j + 1u]]);
+        tris.push_back(loop[ears[3u*j + 2u]]);
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Find the plane (with the given normal) which retains the requested fraction
+// of the polygon area.  This is just the inverse of the piecewise quadratic
+// area response, so no clipping is required.
+//------------------------------------------------------------------------------
+template<typename VA>
+double
+findPlaneForVolumeFraction(const std::vector<Vertex2d<VA>>& poly,
+                           const typename VA::VECTOR& normal,
+                           const double fraction) {
+  const auto response = volumeResponse(poly, normal);
+  return response.inverse(fraction*response.totalVolume());
+}
+
+//------------------------------------------------------------------------------
+// Clip a polygon by planes and return the moments of the result, along with
+// the derivatives of those moments with respect to each plane's distance and
+// normal.
+//
+// Moving plane k changes the area by the integrals over the cut face F_k:
+//   dV/dd_k = |F_k|,   dV/dn_k = int_F_k x dl,
+// and the centroid C by
+//   dC/dd_k   = int_F_k (x - C) dl / V,
+//   dC_i/dn_j = int_F_k (x - C)_i x_j dl / V.
+// We clip once (labeling the planes by index so the cut faces can be found
+// from the vertex clips), and gather the face integrals in a single walk of
+// the resulting edges.  Edge lengths are signed along the plane tangent, so
+// collinear cut edges telescope correctly regardless of how the clip paired
+// them up across non-convex notches.
+//------------------------------------------------------------------------------
+template<typename VA>
+void clippedMomentsWithGradient(double& zerothMoment,
+                                typename VA::VECTOR& firstMoment,
+                                std::vector<double>& dzeroth_ddist,
+                                std::vector<typename VA::VECTOR>& dzeroth_dnormal,
+                                std::vector<typename VA::VECTOR>& dfirst_ddist,
+                                std::vector<double>& dfirst_dnormal,
+                                const std::vector<Vertex2d<VA>>& poly,
+                                const std::vector<Plane<VA>>& planes) {
+
+  // Prepare the results.
+  const auto nplanes = planes.size();
+  dzeroth_ddist.assign(nplanes, 0.0);
+  dzeroth_dnormal.assign(nplanes, VA::Vector(0.0, 0.0));
+  dfirst_ddist.assign(nplanes, VA::Vector(0.0, 0.0));
+  dfirst_dnormal.assign(4u*nplanes, 0.0);
+
+  // Clip a copy of the polygon, with the planes labeled by their index.
+  std::vector<Vertex2d<VA>> clipped(poly);
+  for (auto& v: clipped) v.clips.clear();
+  std::vector<Plane<VA>> indexedPlanes(planes);
+  for (auto k = 0u; k < nplanes; ++k) indexedPlanes[k].ID = k;
+  clipPolygon(clipped, indexedPlanes);
+  moments(zerothMoment, firstMoment, clipped);
+  if (clipped.empty() or zerothMoment <= 0.0) return;
+
+  // Walk the edges, looking for those lying in a clipping plane.
+  const auto Vinv = 1.0/zerothMoment;
+  const double C[2] = {VA::x(firstMoment), VA::y(firstMoment)};
+  for (const auto& v: clipped) {
+    const auto& w = clipped[v.neighbors.second];
+    auto itr = v.clips.begin();
+    while (itr != v.clips.end() and w.clips.find(*itr) == w.clips.end()) ++itr;
+    if (itr != v.clips.end()) {
+      const auto k = *itr;
+      const auto p = VA::sub(v.position, firstMoment);
+      const auto q = VA::sub(w.position, firstMoment);
+      const auto L = VA::dot(VA::sub(q, p), VA::Vector(VA::y(planes[k].normal), -VA::x(planes[k].normal)));
+      const double a[2] = {VA::x(p), VA::y(p)};
+      const double b[2] = {VA::x(q), VA::y(q)};
+      const auto F = VA::mul(VA::add(p, q), 0.5*L);                // int (x - C) dl
+      dzeroth_ddist[k] += L;
+      VA::iadd(dzeroth_dnormal[k], VA::add(F, VA::mul(firstMoment, L)));
+      VA::iadd(dfirst_ddist[k], VA::mul(F, Vinv));
+      const double Fy[2] = {VA::x(F), VA::y(F)};
+      for (auto i = 0u; i < 2u; ++i) {
+        for (auto j = 0u; j < 2u; ++j) {
+          const auto Sij = L/6.0*(2.0*a[i]*a[j] + 2.0*b[i]*b[j] + a[i]*b[j] + b[i]*a[j]);  // int (x - C)_i (x - C)_j dl
+          dfirst_dnormal[4u*k + 2u*i + j] += (Sij + Fy[i]*C[j])*Vinv;
+        }
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Split a polygon by a plane.
+// The two sides are clipped with the plane and its reverse, which produces
+// bit-identical cut vertices on both pieces.
+//------------------------------------------------------------------------------
+template<typename VA>
+void splitPolygon(std::vector<Vertex2d<VA>>& poly,
+                  std::vector<Vertex2d<VA>>& below,
+                  const Plane<VA>& plane) {
+  below = poly;
+  clipPolygon(poly, vector<Plane<VA>>(1, plane));
+  clipPolygon(below, vector<Plane<VA>>(1, Plane<VA>(-plane.dist, VA::neg(plane.normal), plane.ID)));
+}
+
+//------------------------------------------------------------------------------
+// Onion-skin (nested dissection) reconstruction of a multi-material polygon.
+// Each interface plane is found analytically with findPlaneForVolumeFraction,
+// and the plane for material m is labeled with ID m.
+//------------------------------------------------------------------------------
+template<typename VA>
+void nestedDissection(std::vector<std::vector<Vertex2d<VA>>>& materialPolys,
+                      const std::vector<Vertex2d<VA>>& poly,
+                      const std::vector<int>& order,
+                      const std::vector<typename VA::VECTOR>& normals,
+                      const std::vector<double>& fractions) {
+
+  // Pre-conditions.
+  const auto nmat = normals.size();
+  PCASSERT(fractions.size() == nmat);
+  PCASSERT(order.size() <= nmat);
+  materialPolys.resize(nmat);
+  for (auto& p: materialPolys) p.clear();
+  if (order.empty()) return;
+
+  // The last material in the order holds the remainder as we peel.
+  double V0;
+  typename VA::VECTOR C0;
+  moments(V0, C0, poly);
+  auto& remainder = materialPolys[order.back()];
+  remainder = poly;
+  auto Vr = V0;
+  for (auto k = 0u; k + 1u < order.size() and not remainder.empty(); ++k) {
+    const auto m = order[k];
+    PCASSERT(m >= 0 and m < int(nmat));
+    if (fractions[m] > 0.0) {
+      const auto frac = fractions[m]*V0/std::max(Vr, std::numeric_limits<double>::min());
+      if (frac >= 1.0) {
+        materialPolys[m].swap(remainder);
+        remainder.clear();
+      } else {
+        const auto dist = findPlaneForVolumeFraction(remainder, normals[m], frac);
+        splitPolygon(remainder, materialPolys[m], Plane<VA>(-dist, VA::neg(normals[m]), m));
+      }
+      Vr -= fractions[m]*V0;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Moments only version of nestedDissection.
+// We reuse a single workspace for the peeled pieces.
+//------------------------------------------------------------------------------
+template<typename VA>
+void nestedDissectionMoments(std::vector<double>& zerothMoments,
+                             std::vector<typename VA::VECTOR>& firstMoments,
+                             const std::vector<Vertex2d<VA>>& poly,
+                             const std::vector<int>& order,
+                             const std::vector<typename VA::VECTOR>& normals,
+                             const std::vector<double>& fractions) {
+
+  // Pre-conditions.
+  const auto nmat = normals.size();
+  PCASSERT(fractions.size() == nmat);
+  PCASSERT(order.size() <= nmat);
+  zerothMoments.assign(nmat, 0.0);
+  firstMoments.assign(nmat, VA::Vector(0.0, 0.0));
+  if (order.empty()) return;
+
+  double V0;
+  typename VA::VECTOR C0;
+  moments(V0, C0, poly);
+  std::vector<Vertex2d<VA>> remainder(poly), piece;
+  auto Vr = V0;
+  for (auto k = 0u; k + 1u < order.size() and not remainder.empty(); ++k) {
+    const auto m = order[k];
+    PCASSERT(m >= 0 and m < int(nmat));
+    if (fractions[m] > 0.0) {
+      const auto frac = fractions[m]*V0/std::max(Vr, std::numeric_limits<double>::min());
+      if (frac >= 1.0) {
+        moments(zerothMoments[m], firstMoments[m], remainder);
+        remainder.clear();
+      } else {
+        const auto dist = findPlaneForVolumeFraction(remainder, normals[m], frac);
+        splitPolygon(remainder, piece, Plane<VA>(-dist, VA::neg(normals[m]), m));
+        moments(zerothMoments[m], firstMoments[m], piece);
+      }
+      Vr -= fractions[m]*V0;
+    }
+  }
+  moments(zerothMoments[order.back()], firstMoments[order.back()], remainder);
+}
+
+//------------------------------------------------------------------------------
+// Subtract a convex region.  We peel each outside piece off the remainder with
+// splitPolygon, so the pieces share bit-identical cut vertices, and stop as soon
+// as the remainder (the part inside the region so far) is empty.
+//------------------------------------------------------------------------------
+template<typename VA>
+void subtractConvex(std::vector<std::vector<Vertex2d<VA>>>& pieces,
+                    const std::vector<Vertex2d<VA>>& poly,
+                    const std::vector<Plane<VA>>& planes) {
+  const auto nplanes = planes.size();
+  pieces.resize(nplanes);
+  for (auto& p: pieces) p.clear();
+  std::vector<Vertex2d<VA>> remainder(poly);
+  for (auto k = 0u; k < nplanes and not remainder.empty(); ++k) {
+    splitPolygon(remainder, pieces[k], planes[k]);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Moments only version of subtractConvex.
+// We reuse a single workspace for the peeled pieces.
+//------------------------------------------------------------------------------
+template<typename VA>
+void subtractConvexMoments(std::vector<double>& zerothMoments,
+                           std::vector<typename VA::VECTOR>& firstMoments,
+                           const std::vector<Vertex2d<VA>>& poly,
+                           const std::vector<Plane<VA>>& planes) {
+  const auto nplanes = planes.size();
+  zerothMoments.assign(nplanes, 0.0);
+  firstMoments.assign(nplanes, VA::Vector(0.0, 0.0));
+  std::vector<Vertex2d<VA>> remainder(poly), piece;
+  for (auto k = 0u; k < nplanes and not remainder.empty(); ++k) {
+    splitPolygon(remainder, piece, planes[k]);
+    moments(zerothMoments[k], firstMoments[k], piece);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Break a polygon into convex parts.  We ear clip it (holes and all) and then
+// greedily merge triangles across their shared diagonals whenever the merged
+// polygon stays convex (Hertel-Mehlhorn), which gives at most four times the
+// minimum number of convex parts.
+//------------------------------------------------------------------------------
+template<typename VA>
+void convexDecomposition(ConvexDecomposition<VA>& decomposition,
+                         const std::vector<Vertex2d<VA>>& poly) {
+  decomposition.parts.clear();
+  decomposition.xmin.clear();
+  decomposition.xmax.clear();
+  vector<int> tris;
+  splitIntoTriangles(tris, poly, 0.0);
+
+  // Is the turn a->b->c convex (or straight)?
+  auto convexAt = [&](const int a, const int b, const int c) {
+    const auto ab = VA::sub(poly[b].position, poly[a].position);
+    const auto bc = VA::sub(poly[c].position, poly[b].position);
+    return VA::crossmag(ab, bc) >= -1.0e-12*VA::magnitude(ab)*VA::magnitude(bc);
+  };
+
+  // Start with the triangles, and index the parts by their directed edges.
+  vector<vector<int>> parts;
+  map<std::pair<int, int>, int> edgeParts;
+  const auto ntris = tris.size()/3u;
+  for (auto k = 0u; k < ntris; ++k) {
+    const auto a = tris[3u*k], b = tris[3u*k + 1u], c = tris[3u*k + 2u];
+    if (VA::crossmag(VA::sub(poly[b].position, poly[a].position), VA::sub(poly[c].position, poly[a].position)) > 0.0) {
+      edgeParts[std::make_pair(a, b)] = parts.size();
+      edgeParts[std::make_pair(b, c)] = parts.size();
+      edgeParts[std::make_pair(c, a)] = parts.size();
+      parts.push_back({a, b, c});
+    }
+  }
+
+  // Merge across diagonals until nothing changes.
+  const auto nparts = parts.size();
+  vector<int> merged, sorted;
+  auto changed = true;
+  while (changed) {
+    changed = false;
+    for (auto p = 0u; p < nparts; ++p) {
+      const auto np = parts[p].size();
+      for (auto k = 0u; k < np and not changed; ++k) {
+        const auto a = parts[p][k], b = parts[p][(k + 1u) % np];
+        const auto itr = edgeParts.find(std::make_pair(b, a));
+        if (itr == edgeParts.end() or itr->second == int(p)) continue;
+        const auto& other = parts[itr->second];
+        const auto nq = other.size();
+        const auto j = size_t(std::find(other.begin(), other.end(), b) - other.begin());
+        PCASSERT(j < nq and other[(j + 1u) % nq] == a);
+
+        // Walk our loop from b around to a, then the other part's loop from a
+        // around to b.
+        merged.clear();
+        for (auto i = 1u; i <= np; ++i) merged.push_back(parts[p][(k + i) % np]);
+        for (auto i = 2u; i < nq; ++i) merged.push_back(other[(j + i) % nq]);
+        const auto nm = merged.size();
+        sorted = merged;
+        std::sort(sorted.begin(), sorted.end());
+        if (std::unique(sorted.begin(), sorted.end()) != sorted.end() or
+            not convexAt(merged[np - 2u], a, merged[np % nm]) or
+            not convexAt(merged[nm - 1u], b, merged[1u])) continue;
+        edgeParts.erase(std::make_pair(a, b));
+        edgeParts.erase(std::make_pair(b, a));
+        for (auto i = 0u; i < nm; ++i) edgeParts[std::make_pair(merged[i], merged[(i + 1u) % nm])] = p;
+        parts[itr->second].clear();
+        parts[p] = merged;
+        changed = true;
+      }
+    }
+  }
+
+  // Build the inward facing planes of each edge.
+  for (const auto& part: parts) {
+    const auto np = part.size();
+    if (np == 0u) continue;
+    decomposition.parts.push_back(vector<Plane<VA>>());
+    auto& planes = decomposition.parts.back();
+    auto xmin = poly[part[0]].position, xmax = xmin;
+    for (auto k = 0u; k < np; ++k) {
+      const auto& p0 = poly[part[k]].position;
+      const auto edge = VA::sub(poly[part[(k + 1u) % np]].position, p0);
+      if (VA::magnitude(edge) > 0.0) planes.push_back(Plane<VA>(p0, VA::unitVector(VA::Vector(-VA::y(edge), VA::x(edge)))));
+      xmin = VA::Vector(std::min(VA::x(xmin), VA::x(p0)), std::min(VA::y(xmin), VA::y(p0)));
+      xmax = VA::Vector(std::max(VA::x(xmax), VA::x(p0)), std::max(VA::y(xmax), VA::y(p0)));
+    }
+    decomposition.xmin.push_back(xmin);
+    decomposition.xmax.push_back(xmax);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Intersect a polygon with a convex decomposition.  Each convex part is an
+// independent clip of the polygon, skipped if the bounding boxes miss.
+//------------------------------------------------------------------------------
+template<typename VA>
+void intersect(std::vector<std::vector<Vertex2d<VA>>>& pieces,
+               const std::vector<Vertex2d<VA>>& poly,
+               const ConvexDecomposition<VA>& tool) {
+  pieces.clear();
+  if (poly.empty()) return;
+  auto xmin = poly[0].position, xmax = xmin;
+  for (const auto& v: poly) {
+    xmin = VA::Vector(std::min(VA::x(xmin), VA::x(v.position)), std::min(VA::y(xmin), VA::y(v.position)));
+    xmax = VA::Vector(std::max(VA::x(xmax), VA::x(v.position)), std::max(VA::y(xmax), VA::y(v.position)));
+  }
+  const auto nparts = tool.size();
+  std::vector<Vertex2d<VA>> piece;
+  for (auto k = 0u; k < nparts; ++k) {
+    if (VA::x(tool.xmin[k]) > VA::x(xmax) or VA::x(tool.xmax[k]) < VA::x(xmin) or
+        VA::y(tool.xmin[k]) > VA::y(xmax) or VA::y(tool.xmax[k]) < VA::y(xmin)) continue;
+    piece = poly;
+    clipPolygon(piece, tool.parts[k]);
+    if (not piece.empty()) pieces.push_back(piece);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Intersect two polygons, decomposing the tool first.
+//------------------------------------------------------------------------------
+template<typename VA>
+void intersect(std::vector<std::vector<Vertex2d<VA>>>& pieces,
+               const std::vector<Vertex2d<VA>>& poly,
+               const std::vector<Vertex2d<VA>>& tool) {
+  ConvexDecomposition<VA> decomposition;
+  convexDecomposition(decomposition, tool);
+  intersect(pieces, poly, decomposition);
+}
+
+//------------------------------------------------------------------------------
+// Moments only version of intersect.
+//------------------------------------------------------------------------------
+template<typename VA>
+void intersectMoments(double& zerothMoment,
+                      typename VA::VECTOR& firstMoment,
+                      const std::vector<Vertex2d<VA>>& poly,
+                      const ConvexDecomposition<VA>& tool) {
+  zerothMoment = 0.0;
+  firstMoment = VA::Vector(0.0, 0.0);
+  std::vector<std::vector<Vertex2d<VA>>> pieces;
+  intersect(pieces, poly, tool);
+  double area;
+  typename VA::VECTOR centroid;
+  for (const auto& piece: pieces) {
+    moments(area, centroid, piece);
+    zerothMoment += area;
+    VA::iadd(firstMoment, VA::mul(centroid, area));
+  }
+  if (zerothMoment != 0.0) VA::idiv(firstMoment, zerothMoment);
+}
+
+//------------------------------------------------------------------------------
+// Cache the face planes of a polygon.  Each edge plane is labeled with the
+// index of the edge in extractFaces, and zero length edges are skipped.  The
+// polygon is convex if every vertex is above every edge plane (to roundoff).
+//------------------------------------------------------------------------------
+template<typename VA>
+void facePlanes(FacePlanes<VA>& cell,
+                const std::vector<Vertex2d<VA>>& poly) {
+  cell.dimension = 2;
+  cell.points.clear();
+  cell.faces.clear();
+  cell.planes.clear();
+  cell.areas.clear();
+  cell.edges.clear();
+  cell.volume = 0.0;
+  cell.convex = true;
+  if (poly.empty()) return;
+  cell.xmin = poly[0].position;
+  cell.xmax = poly[0].position;
+  for (const auto& v: poly) {
+    cell.points.push_back(v.position);
+    VA::x(cell.xmin) = std::min(VA::x(cell.xmin), VA::x(v.position));
+    VA::y(cell.xmin) = std::min(VA::y(cell.xmin), VA::y(v.position));
+    VA::x(cell.xmax) = std::max(VA::x(cell.xmax), VA::x(v.position));
+    VA::y(cell.xmax) = std::max(VA::y(cell.xmax), VA::y(v.position));
+  }
+  cell.faces = extractFaces(poly);
+  const auto& faces = cell.faces;
+  const int nfaces = faces.size();
+  for (auto k = 0; k < nfaces; ++k) {
+    const auto& p0 = poly[faces[k][0]].position;
+    const auto edge = VA::sub(poly[faces[k][1]].position, p0);
+    const auto len = VA::magnitude(edge);
+    if (len == 0.0) continue;
+    cell.planes.push_back(Plane<VA>(p0, VA::Vector(-VA::y(edge)/len, VA::x(edge)/len), k));
+    cell.areas.push_back(len);
+  }
+  const auto tol = 1.0e-10*VA::magnitude(VA::sub(cell.xmax, cell.xmin));
+  for (const auto& plane: cell.planes) {
+    for (const auto& p: cell.points) cell.convex = cell.convex and plane.dist + VA::dot(plane.normal, p) >= -tol;
+  }
+  typename VA::VECTOR centroid;
+  moments(cell.volume, centroid, poly);
+}
+
+//------------------------------------------------------------------------------
+// Build the piecewise quadratic area response of a polygon for a fixed normal,
+// sweeping the signed triangles of the moments decomposition.
+//------------------------------------------------------------------------------
+template<typename VA>
+VolumeResponse
+volumeResponse(const std::vector<Vertex2d<VA>>& poly,
+               const typename VA::VECTOR& normal) {
+
+  VolumeResponse result;
+  result.degree = 2;
+  if (poly.size() < 3) return result;
+
+  // Heights of the signed triangles relative to the first vertex.
+  vector<double> heights, areas;
+  internal::triangleHeights(heights, areas, poly, normal);
+  result.offset = VA::dot(normal, poly[0].position);
+
+  // The sorted unique vertex heights are the breakpoints of the area function.
+  auto& breaks = result.breaks;
+  breaks.reserve(poly.size());
+  for (const auto& v: poly) breaks.push_back(VA::dot(normal, VA::sub(v.position, poly[0].position)));
+  std::sort(breaks.begin(), breaks.end());
+  breaks.erase(std::unique(breaks.begin(), breaks.end()), breaks.end());
+  const auto n = result.size();
+  if (n == 0u) {
+    breaks.clear();
+    return result;
+  }
+
+  // Sweep the triangles.
+  internal::sweepVolumeResponse(result, heights, areas,
+                                [](double* c, const double* h, const int piece, const double h0) {
+                                  internal::triangleFractionAbovePolynomial(c, h[0], h[1], h[2], piece, h0);
+                                });
+  return result;
+}
+
+//------------------------------------------------------------------------------
+// Compute the flux areas swept by the edges of a polygon, intersected with a
+// set of convex donor cells.
+// The area swept by the edge (u, v) moving to (U, V) is the quadrilateral
+// (u, U, V, v), which we split into the signed triangles (u, U, V) & (u, V, v).
+// These are clipped counter-clockwise and weighted by their sign, so twisted
+// (self-intersecting) swept quadrilaterals are handled by cancellation.
+//------------------------------------------------------------------------------
+template<typename VA>
+void fluxVolumes(std::vector<double>& zerothMoments,
+                 std::vector<typename VA::VECTOR>& firstMoments,
+                 const std::vector<Vertex2d<VA>>& poly,
+                 const std::vector<typename VA::VECTOR>& displacements,
+                 const std::vector<std::vector<Plane<VA>>>& donors) {
+  using Vector = typename VA::VECTOR;
+
+  // Pre-conditions.
+  PCASSERT(displacements.size() == poly.size());
+  const auto faces = extractFaces(poly);
+  const auto nfaces = faces.size();
+  const auto ndonors = donors.size();
+  zerothMoments.assign(nfaces*ndonors, 0.0);
+  firstMoments.assign(nfaces*ndonors, VA::Vector(0.0, 0.0));
+
+  // Faces are independent, and write disjoint parts of the result.
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (int f = 0; f < int(nfaces); ++f) {
+    const auto i = faces[f][0], j = faces[f][1];
+    const auto& u = poly[i].position;
+    const auto& v = poly[j].position;
+    const auto U = VA::add(u, displacements[i]);
+    const auto V = VA::add(v, displacements[j]);
+    const Vector triangles[6] = {u, U, V,
+                                 u, V, v};
+
+    // Clip the signed triangles against each donor.
+    std::vector<Vertex2d<VA>> tri;
+    for (auto t = 0u; t < 2u; ++t) {
+      const auto area = internal::initializeTriangle(tri, triangles[3*t], triangles[3*t + 1], triangles[3*t + 2]);
+      if (area != 0.0) {
+        const auto sgn = (area > 0.0 ? 1.0 : -1.0);
+        for (auto k = 0u; k < ndonors; ++k) {
+          auto chunk = tri;
+          clipPolygon(chunk, donors[k]);
+          if (not chunk.empty()) {
+            double A1;
+            Vector C1;
+            moments(A1, C1, chunk);
+            zerothMoments[f*ndonors + k] += sgn*A1;
+            VA::iadd(firstMoments[f*ndonors + k], VA::mul(C1, sgn*A1));
+          }
+        }
+      }
+    }
+    for (auto k = 0u; k < ndonors; ++k) {
+      VA::imul(firstMoments[f*ndonors + k], internal::safeInv(zerothMoments[f*ndonors + k]));
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Integrate a function over a polygon.
+//------------------------------------------------------------------------------
+template<typename VA, typename Integrand>
+double integrate(const std::vector<Vertex2d<VA>>& poly,
+                 Integrand&& integrand,
+                 const QuadratureRule& rule,
+                 QuadratureBatch& batch) {
+  batch.clear();
+  internal::appendQuadraturePoints(batch, poly, rule);
+  const auto n = batch.size();
+  batch.offsets.push_back(n);
+  batch.values.resize(n);
+  if (n == 0u) return 0.0;
+  integrand(batch.x, batch.y, batch.values);
+  double result = 0.0;
+  for (auto i = 0u; i < n; ++i) result += batch.weights[i]*batch.values[i];
+  return result;
+}
+
+//------------------------------------------------------------------------------
+// Integrate a function over a set of polygons, with one integrand call.
+//------------------------------------------------------------------------------
+template<typename VA, typename Integrand>
+void integrate(std::vector<double>& results,
+               const std::vector<std::vector<Vertex2d<VA>>>& polys,
+               Integrand&& integrand,
+               const QuadratureRule& rule,
+               QuadratureBatch& batch) {
+  const auto npolys = polys.size();
+  results.assign(npolys, 0.0);
+  batch.clear();
+  for (const auto& poly: polys) internal::appendQuadraturePoints(batch, poly, rule);
+  const auto n = batch.size();
+  batch.offsets.push_back(n);
+  batch.values.resize(n);
+  if (n == 0u) return;
+  integrand(batch.x, batch.y, batch.values);
+  for (auto k = 0u; k < npolys; ++k) {
+    for (auto i = batch.offsets[k]; i < batch.offsets[k + 1u]; ++i) results[k] += batch.weights[i]*batch.values[i];
+  }
 }
 
 }
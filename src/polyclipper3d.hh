@@ -28,6 +28,9 @@
 #include "polyclipper_vector3d.hh"
 #include "polyclipper_utilities.hh"
 #include "polyclipper_serialize.hh"
+#include "polyclipper_response.hh"
+#include "polyclipper_quadrature.hh"
+#include "polyclipper_faceplanes.hh"
 
 #include <cmath>
 #include <string>
@@ -76,6 +79,23 @@ void initializePolyhedron(std::vector<Vertex3d<VA>>& poly,
                           const std::vector<typename VA::VECTOR>& positions,
                           const std::vector<std::vector<int>>& neighbors);
 
+//------------------------------------------------------------------------------
+// Build the polyhedron bounded by a set of planes, given a point strictly
+// inside all of them.  The vertices list the IDs of their planes in clips.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>>
+void polyhedronFromHalfspaces(std::vector<Vertex3d<VA>>& poly,
+                              const std::vector<Plane<VA>>& planes,
+                              const typename VA::VECTOR& interiorPoint);
+
+//------------------------------------------------------------------------------
+// Build the convex hull of a set of points as a polyhedron.  Each vertex has its
+// ID set to the index of its point.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>>
+void convexHull(std::vector<Vertex3d<VA>>& poly,
+                const std::vector<typename VA::VECTOR>& points);
+
 //------------------------------------------------------------------------------
 // Return a nicely formatted string representing the polyhedron.
 //------------------------------------------------------------------------------
@@ -89,6 +109,29 @@ template<typename VA = internal::VectorAdapter<Vector3d>>
 void moments(double& zerothMoment, typename VA::VECTOR& firstMoment,
              const std::vector<Vertex3d<VA>>& polyhedron);
 
+//------------------------------------------------------------------------------
+// Compute the surface area of a Polyhedron, along with the area, centroid, and
+// outward unit normal of each face (in extractFaces order).
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>>
+void surfaceMoments(double& totalArea,
+                    std::vector<double>& faceAreas,
+                    std::vector<typename VA::VECTOR>& faceCentroids,
+                    std::vector<typename VA::VECTOR>& faceNormals,
+                    const std::vector<Vertex3d<VA>>& polyhedron);
+
+//------------------------------------------------------------------------------
+// Fused version of moments and surfaceMoments, sharing one pass over the faces.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>>
+void surfaceMoments(double& zerothMoment,
+                    typename VA::VECTOR& firstMoment,
+                    double& totalArea,
+                    std::vector<double>& faceAreas,
+                    std::vector<typename VA::VECTOR>& faceCentroids,
+                    std::vector<typename VA::VECTOR>& faceNormals,
+                    const std::vector<Vertex3d<VA>>& polyhedron);
+
 //------------------------------------------------------------------------------
 // Clip a polyhedron by planes.
 //------------------------------------------------------------------------------
@@ -96,6 +139,79 @@ template<typename VA = internal::VectorAdapter<Vector3d>>
 void clipPolyhedron(std::vector<Vertex3d<VA>>& poly,
                     const std::vector<Plane<VA>>& planes);
 
+//------------------------------------------------------------------------------
+// Clip a polyhedron by planes, also returning the face created by each plane
+// (cutFaces[k] for planes[k]) as it survives on the clipped polyhedron.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>>
+void clipPolyhedron(std::vector<Vertex3d<VA>>& poly,
+                    const std::vector<Plane<VA>>& planes,
+                    std::vector<CutFace<VA>>& cutFaces);
+
+//------------------------------------------------------------------------------
+// Reduce a set of planes for clipping a polyhedron: merge planes coplanar within
+// tol over the polyhedron, and drop planes that are redundant for it.  planeMap
+// gives the index in result each input plane was merged into (-1 if dropped).
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>>
+void simplifyPlanes(std::vector<Plane<VA>>& result,
+                    std::vector<int>& planeMap,
+                    const std::vector<Vertex3d<VA>>& poly,
+                    const std::vector<Plane<VA>>& planes,
+                    const double tol);
+
+//------------------------------------------------------------------------------
+// Check whether clipping a polyhedron by planes would leave a non-zero volume,
+// without building the clipped polyhedron.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>>
+bool intersectsHalfspaces(const std::vector<Vertex3d<VA>>& poly,
+                          const std::vector<Plane<VA>>& planes);
+
+//------------------------------------------------------------------------------
+// Clip a polyhedron by a scalar field sampled at its vertices (field[i] for
+// vertex i), keeping the region where the field (linearly interpolated along
+// the edges) is positive.  New vertices are labeled with the clip ID.  A
+// nonlinear field may only cut a convex polyhedron, and its curved cut faces
+// are fanned from new vertices at their centroids.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>>
+void clipByVertexField(std::vector<Vertex3d<VA>>& poly,
+                       const std::vector<double>& field,
+                       const int ID = std::numeric_limits<int>::min());
+
+//------------------------------------------------------------------------------
+// Clip every cell of a polyhedral mesh by a plane.  Cell c lists the global IDs
+// of its vertices in cellVertices[c], indexing the mesh points.  Each edge
+// crossing the plane is intersected once, appending the new point to points,
+// so the clipped cells conform: cellVertices is updated to the global IDs of
+// the clipped cells' vertices.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>>
+void clipMesh(std::vector<std::vector<Vertex3d<VA>>>& cells,
+              std::vector<std::vector<int>>& cellVertices,
+              std::vector<typename VA::VECTOR>& points,
+              const Plane<VA>& plane);
+
+//------------------------------------------------------------------------------
+// Assemble a conforming mesh from independently clipped cells.  Vertices
+// closer than tol are welded, and faces with the same welded vertices are
+// shared between the cells on either side.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>>
+void assembleMesh(ConformingMesh<VA>& mesh,
+                  const std::vector<std::vector<Vertex3d<VA>>>& cells,
+                  const double tol);
+
+//------------------------------------------------------------------------------
+// Weld the vertices of a set of polyhedra closer than tol, moving each to the
+// first vertex of its class.  Returns the number of classes.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>>
+int weldVertices(std::vector<std::vector<Vertex3d<VA>>>& polys,
+                 const double tol,
+                 std::vector<std::vector<int>>& vertexClasses);
+
 //------------------------------------------------------------------------------
 // Collapse degenerate vertices.
 //------------------------------------------------------------------------------
@@ -103,6 +219,33 @@ template<typename VA = internal::VectorAdapter<Vector3d>>
 void collapseDegenerates(std::vector<Vertex3d<VA>>& poly,
                          const double tol);
 
+//------------------------------------------------------------------------------
+// Collapse degenerate vertices, reporting the vertex of the result each input
+// vertex was merged into (-1 if removed).
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>>
+void collapseDegenerates(std::vector<Vertex3d<VA>>& poly,
+                         const double tol,
+                         std::vector<int>& vertexMap);
+
+//------------------------------------------------------------------------------
+// Label the connected components of a polyhedron (such as the pieces left by
+// clipping a non-convex polyhedron), returning the number of components.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>>
+int splitComponents(std::vector<int>& componentIDs,
+                    const std::vector<Vertex3d<VA>>& poly);
+
+//------------------------------------------------------------------------------
+// Split a polyhedron into its connected components, each compacted as a separate
+// polyhedron, along with the moments of each component.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>>
+void splitComponents(std::vector<std::vector<Vertex3d<VA>>>& components,
+                     std::vector<double>& zerothMoments,
+                     std::vector<typename VA::VECTOR>& firstMoments,
+                     const std::vector<Vertex3d<VA>>& poly);
+
 //------------------------------------------------------------------------------
 // Return the vertices ordered in faces.
 // Implicitly uses the convention that neighbors for each vertex are arranged
@@ -125,6 +268,183 @@ template<typename VA = internal::VectorAdapter<Vector3d>>
 std::vector<std::vector<int>> splitIntoTetrahedra(const std::vector<Vertex3d<VA>>& poly, 
                                                   const double tol = 0.0);
 
+//------------------------------------------------------------------------------
+// Split a general (possibly non-convex) polyhedron into tetrahedra, returned
+// as flat arrays: points starts with the polyhedron vertices (in order) and
+// may have cut points appended, and each four entries of tets index points.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>>
+void splitIntoTetrahedra(std::vector<typename VA::VECTOR>& points,
+                         std::vector<int>& tets,
+                         const std::vector<Vertex3d<VA>>& poly,
+                         const double tol = 0.0);
+
+//------------------------------------------------------------------------------
+// Find the plane distance (for the given unit normal) such that clipping the
+// polyhedron by Plane(dist, normal) retains the given fraction of its volume.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>>
+double findPlaneForVolumeFraction(const std::vector<Vertex3d<VA>>& poly,
+                                  const typename VA::VECTOR& normal,
+                                  const double fraction);
+
+//------------------------------------------------------------------------------
+// Build the piecewise cubic volume retained by clipping with a plane of the
+// given normal, as a function of the plane distance.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>>
+VolumeResponse volumeResponse(const std::vector<Vertex3d<VA>>& poly,
+                              const typename VA::VECTOR& normal);
+
+//------------------------------------------------------------------------------
+// Clip a polyhedron by planes and return the moments of the result, along with
+// the derivatives of those moments with respect to each plane's distance and
+// normal.  The normal derivatives of the first moment are stored row-major,
+// i.e., dfirst_dnormal[k*3*3 + 3*i + j] = d(firstMoment_i)/d(normal_j) for plane k.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>>
+void clippedMomentsWithGradient(double& zerothMoment,
+                                typename VA::VECTOR& firstMoment,
+                                std::vector<double>& dzeroth_ddist,
+                                std::vector<typename VA::VECTOR>& dzeroth_dnormal,
+                                std::vector<typename VA::VECTOR>& dfirst_ddist,
+                                std::vector<double>& dfirst_dnormal,
+                                const std::vector<Vertex3d<VA>>& poly,
+                                const std::vector<Plane<VA>>& planes);
+
+//------------------------------------------------------------------------------
+// Split a polyhedron by a plane: poly retains the portion above the plane (as
+// clipPolyhedron), while below receives the portion beneath it.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>>
+void splitPolyhedron(std::vector<Vertex3d<VA>>& poly,
+                     std::vector<Vertex3d<VA>>& below,
+                     const Plane<VA>& plane);
+
+//------------------------------------------------------------------------------
+// Onion-skin (nested dissection) reconstruction of a multi-material polyhedron.
+// Materials are peeled off in the given order, each above a plane with the
+// material's normal enclosing its volume fraction of the original polyhedron.
+// The final material in the order receives the remainder.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>>
+void nestedDissection(std::vector<std::vector<Vertex3d<VA>>>& materialPolys,
+                      const std::vector<Vertex3d<VA>>& poly,
+                      const std::vector<int>& order,
+                      const std::vector<typename VA::VECTOR>& normals,
+                      const std::vector<double>& fractions);
+
+//------------------------------------------------------------------------------
+// Moments only version of nestedDissection.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>>
+void nestedDissectionMoments(std::vector<double>& zerothMoments,
+                             std::vector<typename VA::VECTOR>& firstMoments,
+                             const std::vector<Vertex3d<VA>>& poly,
+                             const std::vector<int>& order,
+                             const std::vector<typename VA::VECTOR>& normals,
+                             const std::vector<double>& fractions);
+
+//------------------------------------------------------------------------------
+// Subtract a convex region (the intersection of the half-spaces above the
+// planes) from a polyhedron, returning the disjoint pieces outside it.  Piece k
+// lies below plane k and above planes 0, ..., k-1 (and may be empty).
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>>
+void subtractConvex(std::vector<std::vector<Vertex3d<VA>>>& pieces,
+                    const std::vector<Vertex3d<VA>>& poly,
+                    const std::vector<Plane<VA>>& planes);
+
+//------------------------------------------------------------------------------
+// Moments only version of subtractConvex.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>>
+void subtractConvexMoments(std::vector<double>& zerothMoments,
+                           std::vector<typename VA::VECTOR>& firstMoments,
+                           const std::vector<Vertex3d<VA>>& poly,
+                           const std::vector<Plane<VA>>& planes);
+
+//------------------------------------------------------------------------------
+// Break a (possibly non-convex) polyhedron into convex parts, caching the planes
+// bounding each part so it can be used to intersect many targets.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>>
+void convexDecomposition(ConvexDecomposition<VA>& decomposition,
+                         const std::vector<Vertex3d<VA>>& poly);
+
+//------------------------------------------------------------------------------
+// Intersect a polyhedron with a (possibly non-convex) tool given by its convex
+// decomposition, returning the disjoint pieces of the intersection (at most
+// one per convex part of the tool).
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>>
+void intersect(std::vector<std::vector<Vertex3d<VA>>>& pieces,
+               const std::vector<Vertex3d<VA>>& poly,
+               const ConvexDecomposition<VA>& tool);
+
+//------------------------------------------------------------------------------
+// Intersect two (possibly non-convex) polyhedrons.  This decomposes the tool on
+// each call, so build a ConvexDecomposition directly to reuse it.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>>
+void intersect(std::vector<std::vector<Vertex3d<VA>>>& pieces,
+               const std::vector<Vertex3d<VA>>& poly,
+               const std::vector<Vertex3d<VA>>& tool);
+
+//------------------------------------------------------------------------------
+// Moments only version of intersect, summed over the pieces.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>>
+void intersectMoments(double& zerothMoment,
+                      typename VA::VECTOR& firstMoment,
+                      const std::vector<Vertex3d<VA>>& poly,
+                      const ConvexDecomposition<VA>& tool);
+
+//------------------------------------------------------------------------------
+// Cache the face planes of a polyhedron, to test it against many others (see
+// convexOverlap in polyclipper_faceplanes.hh).
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>>
+void facePlanes(FacePlanes<VA>& cell,
+                const std::vector<Vertex3d<VA>>& poly);
+
+//------------------------------------------------------------------------------
+// Compute the signed volumes (and centroids) swept by each face of a polyhedron
+// moving with the given vertex displacements, intersected with each of a set
+// of convex donor cells described by their planes.  Results are stored as
+// [face*ndonors + donor], with faces in extractFaces order, and are positive
+// for motion along the outward face normal.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>>
+void fluxVolumes(std::vector<double>& zerothMoments,
+                 std::vector<typename VA::VECTOR>& firstMoments,
+                 const std::vector<Vertex3d<VA>>& poly,
+                 const std::vector<typename VA::VECTOR>& displacements,
+                 const std::vector<std::vector<Plane<VA>>>& donors);
+
+//------------------------------------------------------------------------------
+// Integrate a function over a polyhedron using the given tetrahedron rule.
+// The integrand is called once on the whole batch of points as
+//   integrand(x, y, z, values)
+// with x, y, z, values std::vector<double>s, and must fill values.  The batch
+// holds the point storage, and can be reused between calls.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>, typename Integrand>
+double integrate(const std::vector<Vertex3d<VA>>& poly,
+                 Integrand&& integrand,
+                 const QuadratureRule& rule,
+                 QuadratureBatch& batch);
+
+//------------------------------------------------------------------------------
+// Integrate a function over each of a set of polyhedra, evaluating the
+// integrand once for the points of all of them.
+//------------------------------------------------------------------------------
+template<typename VA = internal::VectorAdapter<Vector3d>, typename Integrand>
+void integrate(std::vector<double>& results,
+               const std::vector<std::vector<Vertex3d<VA>>>& polys,
+               Integrand&& integrand,
+               const QuadratureRule& rule,
+               QuadratureBatch& batch);
 
 }
 
@@ -27,6 +27,7 @@
 #include <sstream>
 #include <iterator>
 #include <algorithm>
+#include <tuple>
 
 using std::vector;
 using std::list;
@@ -137,6 +138,196 @@ inPlaceSetIntersection(set<int>& a, const set<int>& b) {
   a.erase(it1, a.end());
 }
 
+//------------------------------------------------------------------------------
+// Fraction of a tetrahedron's volume lying above the height t, given the
+// heights of its four vertices sorted in ascending order (a <= b <= c <= d).
+// This is the cumulative of the quadratic B-spline with knots (a, b, c, d),
+// written piecewise so we only divide by knot intervals that are non-empty
+// when each branch is taken.
+//------------------------------------------------------------------------------
+inline
+double
+tetrahedronFractionAbove(const double a, const double b, const double c, const double d,
+                         const double t) {
+  if (t <= a) return 1.0;
+  if (t >= d) return 0.0;
+  if (t <= b) {
+    const auto x = t - a;
+    return 1.0 - x*x*x/((b - a)*(c - a)*(d - a));
+  }
+  if (t >= c) {
+    const auto x = d - t;
+    return x*x*x/((d - a)*(d - b)*(d - c));
+  }
+  const auto u = t - b;
+  const auto u2 = u*u, u3 = u2*u;
+  const auto I1 = (b - a)*(c - b)*u + ((c - b) - (b - a))*u2/2.0 - u3/3.0;     // int_b^t (s - a)(c - s) ds
+  const auto I2 = (d - b)*u2/2.0 - u3/3.0;                                     // int_b^t (d - s)(s - b) ds
+  return 1.0 - ((b - a)*(b - a)/((c - a)*(d - a)) +
+                3.0/(d - a)*(I1/((c - a)*(c - b)) + I2/((d - b)*(c - b))));
+}
+
+//------------------------------------------------------------------------------
+// The polynomial form of tetrahedronFractionAbove on its piece'th knot
+// interval (0 for [a, b], 1 for [b, c], 2 for [c, d]), as coefficients in
+// x = t - h0.
+//------------------------------------------------------------------------------
+inline
+void
+tetrahedronFractionAbovePolynomial(double* coeffs,
+                                   const double a, const double b, const double c, const double d,
+                                   const int piece, const double h0) {
+  if (piece == 0) {
+    const auto s = h0 - a;
+    const auto Dinv = 1.0/((b - a)*(c - a)*(d - a));
+    coeffs[0] = 1.0 - s*s*s*Dinv;
+    coeffs[1] = -3.0*s*s*Dinv;
+    coeffs[2] = -3.0*s*Dinv;
+    coeffs[3] = -Dinv;
+  } else if (piece == 2) {
+    const auto r = d - h0;
+    const auto Dinv = 1.0/((d - a)*(d - b)*(d - c));
+    coeffs[0] = r*r*r*Dinv;
+    coeffs[1] = -3.0*r*r*Dinv;
+    coeffs[2] = 3.0*r*Dinv;
+    coeffs[3] = -Dinv;
+  } else {
+    // Middle knot interval, written in u = t - b and then shifted to x.
+    const auto alpha = 3.0/((d - a)*(c - a)*(c - b));
+    const auto beta = 3.0/((d - a)*(d - b)*(c - b));
+    const auto q = shiftPolynomial({1.0 - (b - a)*(b - a)/((c - a)*(d - a)),
+                                    -alpha*(b - a)*(c - b),
+                                    -0.5*(alpha*((c - b) - (b - a)) + beta*(d - b)),
+                                    (alpha + beta)/3.0}, h0 - b);
+    std::copy(q.begin(), q.end(), coeffs);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Decompose a polyhedron into the signed tetrahedra used by moments, and
+// record the sorted heights (relative to the first vertex) of each
+// tetrahedron along the given direction.  Tetrahedron heights are stored as
+// consecutive quadruples in heights, with their signed volumes in volumes.
+//------------------------------------------------------------------------------
+template<typename VA>
+inline
+void
+tetrahedronHeights(std::vector<double>& heights,
+                   std::vector<double>& volumes,
+                   const std::vector<Vertex3d<VA>>& polyhedron,
+                   const typename VA::VECTOR& normal) {
+  heights.clear();
+  volumes.clear();
+  if (polyhedron.size() > 3) {
+    const auto& origin = polyhedron[0].position;
+    const auto facets = extractFaces(polyhedron);
+    for (const auto& facet: facets) {
+      const auto n = facet.size();
+      const auto p0 = VA::sub(polyhedron[facet[0]].position, origin);
+      const auto h0 = VA::dot(normal, p0);
+      for (auto k = 1u; k < n - 1u; ++k) {
+        const auto p1 = VA::sub(polyhedron[facet[k]].position, origin);
+        const auto p2 = VA::sub(polyhedron[facet[k + 1u]].position, origin);
+        const auto dV = VA::dot(p0, VA::cross(p1, p2))/6.0;
+        if (dV != 0.0) {
+          double h[4] = {0.0, h0, VA::dot(normal, p1), VA::dot(normal, p2)};
+          std::sort(h, h + 4);
+          heights.insert(heights.end(), h, h + 4);
+          volumes.push_back(dV);
+        }
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Add the area and (3x area weighted) centroid of a planar vertex loop, using
+// the triangle fan from its first vertex with areas projected on direction.
+// Projecting on a fixed direction makes the results signed, so the loops of a
+// face with holes or overlapping loops sum correctly.
+//------------------------------------------------------------------------------
+template<typename VA>
+inline
+void
+accumulateFacetMoments(double& area,
+                       typename VA::VECTOR& firstMoment,
+                       const std::vector<Vertex3d<VA>>& poly,
+                       const std::vector<int>& loop,
+                       const typename VA::VECTOR& direction) {
+  const auto n = loop.size();
+  const auto& p0 = poly[loop[0]].position;
+  for (auto m = 1u; m + 1u < n; ++m) {
+    const auto& p1 = poly[loop[m]].position;
+    const auto& p2 = poly[loop[m + 1u]].position;
+    const auto dA = 0.5*VA::dot(VA::cross(VA::sub(p1, p0), VA::sub(p2, p0)), direction);
+    area += dA;
+    VA::iadd(firstMoment, VA::mul(VA::add(p0, VA::add(p1, p2)), dA));
+  }
+}
+
+//------------------------------------------------------------------------------
+// Append the quadrature points for a polyhedron to a batch, mapping the rule
+// onto the signed tetrahedra used by moments (coned from the first vertex to
+// the face fans).
+//------------------------------------------------------------------------------
+template<typename VA>
+inline
+void
+appendQuadraturePoints(QuadratureBatch& batch,
+                       const std::vector<Vertex3d<VA>>& polyhedron,
+                       const QuadratureRule& rule) {
+  PCASSERT(rule.dimension == 3);
+  batch.offsets.push_back(batch.size());
+  if (polyhedron.size() < 4) return;
+  const auto npts = rule.size();
+  const auto& origin = polyhedron[0].position;
+  const auto facets = extractFaces(polyhedron);
+  for (const auto& facet: facets) {
+    const auto n = facet.size();
+    const auto p0 = VA::sub(polyhedron[facet[0]].position, origin);
+    for (auto k = 1u; k + 1u < n; ++k) {
+      const auto p1 = VA::sub(polyhedron[facet[k]].position, origin);
+      const auto p2 = VA::sub(polyhedron[facet[k + 1u]].position, origin);
+      const auto dV = VA::dot(p0, VA::cross(p1, p2))/6.0;
+      if (dV != 0.0) {
+        for (auto i = 0u; i < npts; ++i) {
+          const auto* b = &rule.barycentric[4u*i];
+          const auto p = VA::add(origin, VA::add(VA::mul(p0, b[1]), VA::add(VA::mul(p1, b[2]), VA::mul(p2, b[3]))));
+          batch.x.push_back(VA::x(p));
+          batch.y.push_back(VA::y(p));
+          batch.z.push_back(VA::z(p));
+          batch.weights.push_back(rule.weights[i]*dV);
+        }
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Build the tetrahedron (a, b, c, d) as a polyhedron, swapping b & c if needed
+// to make it positively oriented.  Returns the signed volume of (a, b, c, d).
+//------------------------------------------------------------------------------
+template<typename VA>
+inline
+double
+initializeTetrahedron(std::vector<Vertex3d<VA>>& poly,
+                      const typename VA::VECTOR& a,
+                      const typename VA::VECTOR& b,
+                      const typename VA::VECTOR& c,
+                      const typename VA::VECTOR& d) {
+  const auto vol = VA::dot(VA::sub(d, a), VA::cross(VA::sub(b, a), VA::sub(c, a)))/6.0;
+  poly.assign(4, Vertex3d<VA>());
+  poly[0].position = a;
+  poly[1].position = (vol >= 0.0 ? b : c);
+  poly[2].position = (vol >= 0.0 ? c : b);
+  poly[3].position = d;
+  poly[0].neighbors = vector<int>({1, 3, 2});
+  poly[1].neighbors = vector<int>({2, 3, 0});
+  poly[2].neighbors = vector<int>({0, 3, 1});
+  poly[3].neighbors = vector<int>({2, 0, 1});
+  return vol;
+}
+
 }              // internal namespace methods
 
 //------------------------------------------------------------------------------
@@ -159,6 +350,401 @@ initializePolyhedron(std::vector<Vertex3d<VA>>& poly,
   }
 }
 
+namespace internal {
+
+//------------------------------------------------------------------------------
+// Quickhull: the convex hull of a set of points, returned as facet loops of
+// point indices (counter-clockwise viewed from outside).  Points within tol of
+// a facet are treated as lying on it, and adjacent triangles within tol of
+// coplanar are merged into polygonal facets.  Returns no facets if the points
+// are degenerate (coplanar).
+//------------------------------------------------------------------------------
+template<typename VA>
+vector<vector<int>>
+convexHullFacets(const vector<typename VA::VECTOR>& points,
+                 const double tol) {
+  using Vector = typename VA::VECTOR;
+  struct Face {
+    int v[3];                  // Vertices (counter-clockwise from outside)
+    int neighbor[3];           // Faces across the edges (v[k], v[k+1])
+    Vector normal;             // Outward unit normal
+    double offset;             // Signed distance of p is normal.p + offset
+    vector<int> outside;       // Points above this face
+    bool alive;
+  };
+  vector<vector<int>> result;
+  const int n = points.size();
+  if (n < 4) return result;
+  vector<Face> faces;
+  auto addFace = [&](const int a, const int b, const int c) {
+    Face f;
+    f.v[0] = a; f.v[1] = b; f.v[2] = c;
+    f.neighbor[0] = f.neighbor[1] = f.neighbor[2] = -1;
+    f.normal = VA::unitVector(VA::cross(VA::sub(points[b], points[a]), VA::sub(points[c], points[a])));
+    f.offset = -VA::dot(f.normal, points[a]);
+    f.alive = true;
+    faces.push_back(f);
+    return int(faces.size()) - 1;
+  };
+  auto dist = [&](const Face& f, const int i) { return VA::dot(f.normal, points[i]) + f.offset; };
+
+  // Start from a tetrahedron: the extreme points along the longest axis, the
+  // point farthest from their line, and the point farthest from that plane.
+  auto i0 = 0, i1 = 0;
+  {
+    auto extent = -1.0;
+    for (auto k = 0; k < 3; ++k) {
+      auto jmin = 0, jmax = 0;
+      for (auto i = 1; i < n; ++i) {
+        const auto xi = VA::get_triple(points[i])[k];
+        if (xi < VA::get_triple(points[jmin])[k]) jmin = i;
+        if (xi > VA::get_triple(points[jmax])[k]) jmax = i;
+      }
+      const auto dx = VA::get_triple(points[jmax])[k] - VA::get_triple(points[jmin])[k];
+      if (dx > extent) {
+        extent = dx;
+        i0 = jmin;
+        i1 = jmax;
+      }
+    }
+    if (extent <= tol) return result;
+  }
+  const auto e01 = VA::unitVector(VA::sub(points[i1], points[i0]));
+  auto i2 = -1;
+  {
+    auto dmax = tol;
+    for (auto i = 0; i < n; ++i) {
+      const auto d = VA::magnitude(VA::cross(VA::sub(points[i], points[i0]), e01));
+      if (d > dmax) {
+        dmax = d;
+        i2 = i;
+      }
+    }
+    if (i2 < 0) return result;
+  }
+  const auto n012 = VA::unitVector(VA::cross(VA::sub(points[i1], points[i0]), VA::sub(points[i2], points[i0])));
+  auto i3 = -1;
+  {
+    auto dmax = tol;
+    for (auto i = 0; i < n; ++i) {
+      const auto d = std::abs(VA::dot(VA::sub(points[i], points[i0]), n012));
+      if (d > dmax) {
+        dmax = d;
+        i3 = i;
+      }
+    }
+    if (i3 < 0) return result;
+  }
+  if (VA::dot(VA::sub(points[i3], points[i0]), n012) > 0.0) std::swap(i1, i2);
+  addFace(i0, i1, i2);
+  addFace(i0, i3, i1);
+  addFace(i1, i3, i2);
+  addFace(i2, i3, i0);
+  {
+    map<pair<int, int>, int> edgeFaces;
+    for (auto f = 0; f < 4; ++f) {
+      for (auto k = 0; k < 3; ++k) edgeFaces[make_pair(faces[f].v[k], faces[f].v[(k + 1) % 3])] = f;
+    }
+    for (auto f = 0; f < 4; ++f) {
+      for (auto k = 0; k < 3; ++k) faces[f].neighbor[k] = edgeFaces[make_pair(faces[f].v[(k + 1) % 3], faces[f].v[k])];
+    }
+  }
+  for (auto i = 0; i < n; ++i) {
+    if (i == i0 or i == i1 or i == i2 or i == i3) continue;
+    for (auto f = 0; f < 4; ++f) {
+      if (dist(faces[f], i) > tol) {
+        faces[f].outside.push_back(i);
+        break;
+      }
+    }
+  }
+
+  // Add the farthest outside point of each face in turn, replacing the faces
+  // it sees with a cone from the horizon.  New faces are appended, so one pass
+  // through the growing list visits them all.
+  vector<int> visible, stack, newFaces;
+  vector<std::tuple<int, int, int>> horizon;
+  vector<int> mark;                               // 2*pass + 1 => visible, 2*pass + 2 => not visible
+  auto pass = 0;
+  map<int, int> startsAt, endsAt;
+  for (auto f = 0u; f < faces.size(); ++f) {
+    if (not faces[f].alive or faces[f].outside.empty()) continue;
+    auto eye = faces[f].outside[0];
+    for (const auto i: faces[f].outside) {
+      if (dist(faces[f], i) > dist(faces[f], eye)) eye = i;
+    }
+
+    // Find the visible faces and the horizon edges around them.
+    ++pass;
+    mark.resize(faces.size(), 0);
+    visible.assign(1, f);
+    stack.assign(1, f);
+    mark[f] = 2*pass + 1;
+    horizon.clear();
+    while (not stack.empty()) {
+      const auto g = stack.back();
+      stack.pop_back();
+      for (auto k = 0; k < 3; ++k) {
+        const auto h = faces[g].neighbor[k];
+        if (mark[h] <= 2*pass) {
+          if (dist(faces[h], eye) > tol) {
+            mark[h] = 2*pass + 1;
+            visible.push_back(h);
+            stack.push_back(h);
+          } else {
+            mark[h] = 2*pass + 2;
+          }
+        }
+        if (mark[h] == 2*pass + 2) horizon.push_back(std::make_tuple(faces[g].v[k], faces[g].v[(k + 1) % 3], h));
+      }
+    }
+
+    // Build the cone of new faces from the horizon to the eye.
+    newFaces.clear();
+    startsAt.clear();
+    endsAt.clear();
+    for (const auto& edge: horizon) {
+      const auto a = std::get<0>(edge), b = std::get<1>(edge), h = std::get<2>(edge);
+      const auto fnew = addFace(a, b, eye);
+      faces[fnew].neighbor[0] = h;
+      for (auto k = 0; k < 3; ++k) {
+        if (faces[h].v[k] == b and faces[h].v[(k + 1) % 3] == a) faces[h].neighbor[k] = fnew;
+      }
+      startsAt[a] = fnew;
+      endsAt[b] = fnew;
+      newFaces.push_back(fnew);
+    }
+    for (const auto fnew: newFaces) {
+      faces[fnew].neighbor[1] = startsAt[faces[fnew].v[1]];
+      faces[fnew].neighbor[2] = endsAt[faces[fnew].v[0]];
+    }
+
+    // Hand the outside points of the visible faces on to the new faces.
+    for (const auto g: visible) {
+      faces[g].alive = false;
+      for (const auto i: faces[g].outside) {
+        if (i == eye) continue;
+        for (const auto fnew: newFaces) {
+          if (dist(faces[fnew], i) > tol) {
+            faces[fnew].outside.push_back(i);
+            break;
+          }
+        }
+      }
+      faces[g].outside.clear();
+    }
+  }
+
+  // Merge the coplanar faces, and walk the boundary loop of each group.
+  const int nfaces = faces.size();
+  vector<int> parent(nfaces), labels;
+  for (auto f = 0; f < nfaces; ++f) parent[f] = f;
+  for (auto f = 0; f < nfaces; ++f) {
+    if (not faces[f].alive) continue;
+    for (auto k = 0; k < 3; ++k) {
+      const auto g = faces[f].neighbor[k];
+      const auto a = faces[f].v[(k + 2) % 3];
+      auto b = faces[g].v[0];
+      for (auto j = 0; j < 3; ++j) {
+        if (faces[g].v[j] != faces[f].v[k] and faces[g].v[j] != faces[f].v[(k + 1) % 3]) b = faces[g].v[j];
+      }
+      if (std::abs(dist(faces[f], b)) <= tol and std::abs(dist(faces[g], a)) <= tol) unionFindJoin(parent, f, g);
+    }
+  }
+  unionFindLabels(labels, parent);
+  map<int, map<int, int>> groupEdges;
+  for (auto f = 0; f < nfaces; ++f) {
+    if (not faces[f].alive) continue;
+    for (auto k = 0; k < 3; ++k) {
+      if (labels[faces[f].neighbor[k]] != labels[f]) groupEdges[labels[f]][faces[f].v[k]] = faces[f].v[(k + 1) % 3];
+    }
+  }
+  for (auto& group: groupEdges) {
+    auto& next = group.second;
+    while (not next.empty()) {
+      vector<int> loop;
+      auto i = next.begin()->first;
+      while (next.find(i) != next.end()) {
+        loop.push_back(i);
+        const auto j = next[i];
+        next.erase(i);
+        i = j;
+      }
+      if (loop.size() >= 3) result.push_back(loop);
+    }
+  }
+  return result;
+}
+
+//------------------------------------------------------------------------------
+// Check whether a polyhedron is convex: every vertex on or above the plane of
+// each face, to a tolerance relative to the size of the polyhedron.
+//------------------------------------------------------------------------------
+template<typename VA>
+bool
+isConvex(const std::vector<Vertex3d<VA>>& poly) {
+  const int n = poly.size();
+  if (n < 4) return true;
+  auto xmin = poly[0].position, xmax = poly[0].position;
+  for (const auto& v: poly) {
+    VA::x(xmin) = std::min(VA::x(xmin), VA::x(v.position));
+    VA::y(xmin) = std::min(VA::y(xmin), VA::y(v.position));
+    VA::z(xmin) = std::min(VA::z(xmin), VA::z(v.position));
+    VA::x(xmax) = std::max(VA::x(xmax), VA::x(v.position));
+    VA::y(xmax) = std::max(VA::y(xmax), VA::y(v.position));
+    VA::z(xmax) = std::max(VA::z(xmax), VA::z(v.position));
+  }
+  const auto extent = VA::magnitude(VA::sub(xmax, xmin));
+  const auto tol = 1.0e-10*extent;
+  for (const auto& facet: extractFaces(poly)) {
+    const auto& p0 = poly[facet[0]].position;
+    auto areaVec = VA::Vector(0.0, 0.0, 0.0);
+    for (auto m = 1u; m + 1u < facet.size(); ++m) {
+      VA::iadd(areaVec, VA::cross(VA::sub(poly[facet[m]].position, p0),
+                                  VA::sub(poly[facet[m + 1u]].position, p0)));
+    }
+    const auto area = VA::magnitude(areaVec);
+    if (area <= tol*extent) continue;
+    for (const auto& w: poly) {
+      if (VA::dot(areaVec, VA::sub(w.position, p0)) > tol*area) return false;
+    }
+  }
+  return true;
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Build the polyhedron bounded by a set of planes (half-spaces) around an
+// interior point.  Moving the origin to the interior point, the plane
+// (d, n) becomes q.x <= 1 with the dual point q = -n/h, where h > 0 is the
+// height of the interior point above the plane.  The vertices of the
+// polyhedron are then the (polar) duals of the facets of the convex hull of
+// the dual points, with the facets' adjacency giving the connectivity, while
+// dual points inside the hull are redundant planes.
+//------------------------------------------------------------------------------
+template<typename VA>
+void
+polyhedronFromHalfspaces(std::vector<Vertex3d<VA>>& poly,
+                         const std::vector<Plane<VA>>& planes,
+                         const typename VA::VECTOR& interiorPoint) {
+  using Vector = typename VA::VECTOR;
+  poly.clear();
+  const int nplanes = planes.size();
+
+  // The dual points.
+  vector<Vector> dual(nplanes);
+  auto qmax = 0.0;
+  for (auto k = 0; k < nplanes; ++k) {
+    const auto h = planes[k].dist + VA::dot(planes[k].normal, interiorPoint);
+    if (h <= 0.0) return;
+    dual[k] = VA::div(VA::neg(planes[k].normal), h);
+    qmax = std::max(qmax, VA::magnitude(dual[k]));
+  }
+  const auto facets = internal::convexHullFacets<VA>(dual, 1.0e-10*qmax);
+  const int nfacets = facets.size();
+  if (nfacets < 4) return;
+
+  // Each facet of the dual hull gives a vertex, which must be finite (the
+  // origin strictly inside the hull).
+  poly.resize(nfacets);
+  map<pair<int, int>, int> edgeFacets;
+  for (auto f = 0; f < nfacets; ++f) {
+    const auto& loop = facets[f];
+    const int nloop = loop.size();
+    Vector normal = VA::Vector(0.0, 0.0, 0.0), centroid = VA::Vector(0.0, 0.0, 0.0);
+    for (auto k = 0; k < nloop; ++k) {
+      VA::iadd(normal, VA::cross(dual[loop[k]], dual[loop[(k + 1) % nloop]]));
+      VA::iadd(centroid, dual[loop[k]]);
+      edgeFacets[make_pair(loop[k], loop[(k + 1) % nloop])] = f;
+    }
+    VA::idiv(centroid, double(nloop));
+    const auto c = VA::dot(normal, centroid);
+    if (c <= 1.0e-10*qmax*VA::magnitude(normal)) {
+      poly.clear();
+      return;
+    }
+    poly[f].position = VA::add(interiorPoint, VA::div(normal, c));
+    poly[f].ID = f;
+    for (const auto k: loop) poly[f].clips.insert(planes[k].ID);
+  }
+
+  // Link the vertices across the dual edges.
+  for (auto f = 0; f < nfacets; ++f) {
+    const auto& loop = facets[f];
+    const int nloop = loop.size();
+    for (auto k = 0; k < nloop; ++k) {
+      const auto itr = edgeFacets.find(make_pair(loop[(k + 1) % nloop], loop[k]));
+      PCASSERT(itr != edgeFacets.end());
+      poly[f].neighbors.push_back(itr->second);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Build the convex hull of a set of points, with quickhull.  Points within a
+// small tolerance (relative to the extent of the points) of the hull facets
+// are left out.  Around each vertex v, a facet loop (..., u, v, w, ...) means
+// w is followed by u in the (counter-clockwise) neighbors of v, so we chain
+// the facets around each vertex to order its neighbors.
+//------------------------------------------------------------------------------
+template<typename VA>
+void
+convexHull(std::vector<Vertex3d<VA>>& poly,
+           const std::vector<typename VA::VECTOR>& points) {
+  poly.clear();
+  if (points.empty()) return;
+  auto xmin = points[0], xmax = points[0];
+  for (const auto& p: points) {
+    VA::x(xmin) = std::min(VA::x(xmin), VA::x(p));
+    VA::y(xmin) = std::min(VA::y(xmin), VA::y(p));
+    VA::z(xmin) = std::min(VA::z(xmin), VA::z(p));
+    VA::x(xmax) = std::max(VA::x(xmax), VA::x(p));
+    VA::y(xmax) = std::max(VA::y(xmax), VA::y(p));
+    VA::z(xmax) = std::max(VA::z(xmax), VA::z(p));
+  }
+  const auto facets = internal::convexHullFacets<VA>(points, 1.0e-10*VA::magnitude(VA::sub(xmax, xmin)));
+  if (facets.size() < 4) return;
+
+  // Number the hull vertices in the order of their points.
+  const int npoints = points.size();
+  vector<int> index(npoints, -1);
+  for (const auto& loop: facets) {
+    for (const auto i: loop) index[i] = 0;
+  }
+  auto n = 0;
+  for (auto i = 0; i < npoints; ++i) {
+    if (index[i] == 0) {
+      index[i] = n++;
+      poly.push_back(Vertex3d<VA>(points[i]));
+      poly.back().ID = i;
+    }
+  }
+
+  // Chain the facets around each vertex.
+  vector<vector<pair<int, int>>> around(n);
+  for (const auto& loop: facets) {
+    const int nloop = loop.size();
+    for (auto k = 0; k < nloop; ++k) {
+      around[index[loop[k]]].push_back(make_pair(index[loop[(k + 1) % nloop]], index[loop[(k + nloop - 1) % nloop]]));
+    }
+  }
+  for (auto i = 0; i < n; ++i) {
+    const auto& links = around[i];
+    const int nlinks = links.size();
+    auto& neighbors = poly[i].neighbors;
+    auto j = links[0].first;
+    for (auto k = 0; k < nlinks; ++k) {
+      neighbors.push_back(j);
+      auto m = 0;
+      while (m < nlinks and links[m].first != j) ++m;
+      PCASSERT(m < nlinks);
+      j = links[m].second;
+    }
+    PCASSERT(j == neighbors.front());
+  }
+}
+
 //------------------------------------------------------------------------------
 // Return a nicely formatted string representing the polyhedron.
 //------------------------------------------------------------------------------
@@ -231,11 +817,166 @@ void moments(double& zerothMoment, typename VA::VECTOR& firstMoment,
 }
 
 //------------------------------------------------------------------------------
-// Clip a polyhedron by planes.
+// Compute the surface moments of a Polyhedron, optionally fused with the
+// volume moments (zerothMoment == nullptr skips those).  Both are built from
+// the same triangle fans on the faces, so we only extract the faces once.
 //------------------------------------------------------------------------------
+namespace internal {
+
 template<typename VA>
-void clipPolyhedron(std::vector<Vertex3d<VA>>& polyhedron,
-                    const std::vector<Plane<VA>>& planes) {
+void surfaceMomentsImpl(double* zerothMoment,
+                        typename VA::VECTOR* firstMoment,
+                        double& totalArea,
+                        std::vector<double>& faceAreas,
+                        std::vector<typename VA::VECTOR>& faceCentroids,
+                        std::vector<typename VA::VECTOR>& faceNormals,
+                        const std::vector<Vertex3d<VA>>& polyhedron) {
+
+  const auto computeVolume = zerothMoment != nullptr;
+
+  // Clear the result for accumulation.
+  totalArea = 0.0;
+  faceAreas.clear();
+  faceCentroids.clear();
+  faceNormals.clear();
+  if (computeVolume) {
+    *zerothMoment = 0.0;
+    *firstMoment = VA::Vector(0.0, 0.0, 0.0);
+  }
+  if (polyhedron.size() < 4) return;    // Require at least a tetrahedron
+
+  const auto facets = extractFaces(polyhedron);
+  const auto nfaces = facets.size();
+  faceAreas.resize(nfaces);
+  faceCentroids.resize(nfaces);
+  faceNormals.resize(nfaces);
+  const auto& origin = polyhedron[0].position;
+  for (auto k = 0u; k < nfaces; ++k) {
+    const auto& facet = facets[k];
+    const auto n = facet.size();
+
+    // The face normal from its area vector.
+    const auto& p0 = polyhedron[facet[0]].position;
+    auto areaVec = VA::Vector(0.0, 0.0, 0.0);
+    for (auto m = 1u; m + 1u < n; ++m) {
+      VA::iadd(areaVec, VA::cross(VA::sub(polyhedron[facet[m]].position, p0),
+                                  VA::sub(polyhedron[facet[m + 1u]].position, p0)));
+    }
+    faceNormals[k] = VA::unitVector(areaVec);
+
+    // Face area & centroid.
+    faceAreas[k] = 0.0;
+    faceCentroids[k] = VA::Vector(0.0, 0.0, 0.0);
+    internal::accumulateFacetMoments(faceAreas[k], faceCentroids[k], polyhedron, facet, faceNormals[k]);
+    VA::imul(faceCentroids[k], internal::safeInv(3.0*faceAreas[k]));
+    totalArea += faceAreas[k];
+
+    // Volume moments, as in moments.
+    if (computeVolume) {
+      const auto q0 = VA::sub(p0, origin);
+      for (auto m = 1u; m + 1u < n; ++m) {
+        const auto q1 = VA::sub(polyhedron[facet[m]].position, origin);
+        const auto q2 = VA::sub(polyhedron[facet[m + 1u]].position, origin);
+        const auto dV = VA::dot(q0, VA::cross(q1, q2));
+        *zerothMoment += dV;                                                // 6x
+        VA::iadd(*firstMoment, VA::mul(VA::add(q0, VA::add(q1, q2)), dV));  // 24x
+      }
+    }
+  }
+  if (computeVolume) {
+    *zerothMoment /= 6.0;
+    VA::imul(*firstMoment, internal::safeInv(24.0*(*zerothMoment)));
+    VA::iadd(*firstMoment, origin);
+  }
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Compute the surface moments of a Polyhedron.
+//------------------------------------------------------------------------------
+template<typename VA>
+void surfaceMoments(double& totalArea,
+                    std::vector<double>& faceAreas,
+                    std::vector<typename VA::VECTOR>& faceCentroids,
+                    std::vector<typename VA::VECTOR>& faceNormals,
+                    const std::vector<Vertex3d<VA>>& polyhedron) {
+  internal::surfaceMomentsImpl(static_cast<double*>(nullptr), static_cast<typename VA::VECTOR*>(nullptr),
+                               totalArea, faceAreas, faceCentroids, faceNormals, polyhedron);
+}
+
+//------------------------------------------------------------------------------
+// Compute the volume and surface moments of a Polyhedron together.
+//------------------------------------------------------------------------------
+template<typename VA>
+void surfaceMoments(double& zerothMoment,
+                    typename VA::VECTOR& firstMoment,
+                    double& totalArea,
+                    std::vector<double>& faceAreas,
+                    std::vector<typename VA::VECTOR>& faceCentroids,
+                    std::vector<typename VA::VECTOR>& faceNormals,
+                    const std::vector<Vertex3d<VA>>& polyhedron) {
+  internal::surfaceMomentsImpl(&zerothMoment, &firstMoment,
+                               totalArea, faceAreas, faceCentroids, faceNormals, polyhedron);
+}
+
+//------------------------------------------------------------------------------
+// Clip a polyhedron by planes, optionally tracking the face created by each
+// plane (cutFaces == nullptr skips all of that bookkeeping).  If field is
+// given we instead make a single pass (with one plane, used only for its ID)
+// classifying the vertices by the field values and interpolating them along
+// the edges.  If meshCut is also given the polyhedron is a mesh cell, and the
+// new vertices take the shared points on its edges by global ID.
+//------------------------------------------------------------------------------
+namespace internal {
+
+//------------------------------------------------------------------------------
+// A later plane can split an earlier non-convex cut face into separate pieces,
+// which clipping its loops vertex by vertex would leave bridged together.  So
+// re-walk the clipped loops around the actual faces of the polyhedron, keeping
+// those walks that stay on the vertices of the original loops.
+//------------------------------------------------------------------------------
+template<typename VA>
+inline
+void
+rewalkFaceLoops(std::vector<std::vector<int>>& loops,
+                const std::vector<Vertex3d<VA>>& polyhedron) {
+  set<int> onFace;
+  for (const auto& loop: loops) onFace.insert(loop.begin(), loop.end());
+  set<pair<int, int>> edgesWalked;
+  vector<vector<int>> result;
+  for (const auto& loop: loops) {
+    const auto n = loop.size();
+    for (auto k = 0u; k < n; ++k) {
+      const auto a = loop[k], b = loop[(k + 1u) % n];
+      if (edgesWalked.find(make_pair(a, b)) == edgesWalked.end() and
+          std::find(polyhedron[a].neighbors.begin(), polyhedron[a].neighbors.end(), b) != polyhedron[a].neighbors.end()) {
+        vector<int> face(1, a);
+        auto iprev = a, inext = b;
+        auto m = 0u;
+        while (inext != a and onFace.find(inext) != onFace.end() and m++ < polyhedron.size()) {
+          edgesWalked.insert(make_pair(iprev, inext));
+          face.push_back(inext);
+          const auto itmp = inext;
+          inext = nextInFaceLoop(polyhedron[inext], iprev);
+          iprev = itmp;
+        }
+        if (inext == a) {
+          edgesWalked.insert(make_pair(iprev, inext));
+          if (face.size() >= 3u) result.push_back(face);
+        }
+      }
+    }
+  }
+  loops.swap(result);
+}
+
+template<typename VA>
+void clipPolyhedronImpl(std::vector<Vertex3d<VA>>& polyhedron,
+                        const std::vector<Plane<VA>>& planes,
+                        std::vector<CutFace<VA>>* cutFaces,
+                        const std::vector<double>* field,
+                        MeshCut<VA>* meshCut) {
 
   // Pre-declare variables.  Normally I prefer local declaration, but this
   // seems to slightly help performance.
@@ -257,11 +998,18 @@ void clipPolyhedron(std::vector<Vertex3d<VA>>& polyhedron,
 #endif
 
   // Check the input.
+  PCASSERT(field == nullptr or (planes.size() == 1u and field->size() == polyhedron.size()));
+  PCASSERT(meshCut == nullptr or (field != nullptr and meshCut->ids.size() == polyhedron.size()));
   double V0;
   Vector C0;
   moments(V0, C0, polyhedron);
   if (V0 < nearlyZero) polyhedron.clear();
 
+  // Prepare the cut faces (loops of vertex indices) for each plane.
+  const auto trackCutFaces = cutFaces != nullptr;
+  map<pair<int, int>, int> edgeVertices;
+  if (trackCutFaces) cutFaces->assign(planes.size(), CutFace<VA>());
+
   // Find the bounding box of the polyhedron.
   auto xmin = std::numeric_limits<double>::max(), xmax = std::numeric_limits<double>::lowest();
   auto ymin = std::numeric_limits<double>::max(), ymax = std::numeric_limits<double>::lowest();
@@ -293,7 +1041,7 @@ void clipPolyhedron(std::vector<Vertex3d<VA>>& polyhedron,
     // }
 
     // First check against the bounding box.
-    auto boxcomp = internal::compare(plane, xmin, ymin, zmin, xmax, ymax, zmax);
+    auto boxcomp = field == nullptr ? internal::compare(plane, xmin, ymin, zmin, xmax, ymax, zmax) : 0;
     auto above = boxcomp ==  1;
     auto below = boxcomp == -1;
     PCASSERT2(not (above and below), internal::dumpSerializedState(initial_state));
@@ -303,8 +1051,9 @@ void clipPolyhedron(std::vector<Vertex3d<VA>>& polyhedron,
     if (not (above or below)) {
       above = true;
       below = true;
-      for (auto& v: polyhedron) {
-        v.comp = internal::compare<VA>(plane, v.position);
+      for (i = 0; i < int(polyhedron.size()); ++i) {
+        auto& v = polyhedron[i];
+        v.comp = (field == nullptr ? internal::compare<VA>(plane, v.position) : internal::compare((*field)[i]));
         if (v.comp == 1) {
           below = false;
         } else if (v.comp == -1) {
@@ -324,6 +1073,7 @@ void clipPolyhedron(std::vector<Vertex3d<VA>>& polyhedron,
 
       // This plane passes through the polyhedron.
       // Insert any new vertices.
+      edgeVertices.clear();
       nverts0 = polyhedron.size();
       for (i = 0; i < nverts0; ++i) {   // Only check vertices before we start adding new ones.
         if (polyhedron[i].comp == -1) {
@@ -339,13 +1089,24 @@ void clipPolyhedron(std::vector<Vertex3d<VA>>& polyhedron,
 
               // This edge straddles the clip plane, so insert a new vertex.
               inew = polyhedron.size();
-              polyhedron.push_back(Vertex(internal::segmentPlaneIntersection(polyhedron[i].position,
-                                                                             polyhedron[jn].position,
-                                                                             plane),
-                                          2));         // 2 indicates new vertex
+              if (meshCut != nullptr) {
+                meshCut->ids.push_back(meshCut->edgePoint(meshCut->ids[i], meshCut->ids[jn]));
+                polyhedron.push_back(Vertex(meshCut->points[meshCut->ids.back()], 2));
+              } else {
+                polyhedron.push_back(Vertex(field == nullptr ?
+                                            internal::segmentPlaneIntersection(polyhedron[i].position,
+                                                                               polyhedron[jn].position,
+                                                                               plane) :
+                                            internal::segmentFieldIntersection<VA>(polyhedron[i].position,
+                                                                                   polyhedron[jn].position,
+                                                                                   (*field)[i],
+                                                                                   (*field)[jn]),
+                                            2));         // 2 indicates new vertex
+              }
               PCASSERT2(polyhedron.size() == inew + 1, internal::dumpSerializedState(initial_state));
               polyhedron[inew].neighbors = vector<int>({i, jn});
               polyhedron[inew].clips.insert(plane.ID);
+              if (trackCutFaces) edgeVertices[make_pair(min(i, jn), max(i, jn))] = inew;
 
               // Patch up clip info -- gotta scan for common elements in the neighbors of the clipped guy.
               std::set<int> common_clips;
@@ -369,10 +1130,112 @@ void clipPolyhedron(std::vector<Vertex3d<VA>>& polyhedron,
       nverts = polyhedron.size();
       // cerr << "After insertion:\n" << polyhedron2string(polyhedron) << endl;
 
+      // Each clipped neighbor of a surviving vertex starts a run of clipped
+      // vertices around a face loop, ending at the next unclipped vertex.  We
+      // walk the whole face to identify it (by its smallest directed edge) and find
+      // its normal, since a non-convex face can have several runs: following
+      // the old loop would then bridge separate pieces across the clipped
+      // notches.  As in 2D, the new edges on a face run along the plane in the
+      // direction n_plane x n_face, so when the starts and ends of the runs on
+      // a face strictly alternate in that direction we pair them in order.
+      // A field clip passes the gradient of a linear field as the plane normal,
+      // while a nonlinear field has no such direction (a zero normal).  The
+      // level set then crosses the face in a saddle, and as in 2D we only keep
+      // the retained runs connected if the mean field on the face is positive,
+      // otherwise closing each run on itself, so that clipping by -field
+      // leaves the complement.
+      // We hit any new vertices first, and then any preexisting that happened
+      // to lie exactly in-plane.
+      struct CutRun {
+        int start, end, last;
+        pair<int, int> face;
+        Vector normal;
+        double fieldSum;
+      };
+      vector<CutRun> runs;
+      for (ii = 0; ii < nverts; ++ii) {
+        i = (ii + nverts0) % nverts;
+        if (polyhedron[i].comp == 0 or polyhedron[i].comp == 2) {
+          for (const auto jn0: polyhedron[i].neighbors) {
+            if (polyhedron[jn0].comp == -1) {
+              CutRun run = {i, -1, -1, make_pair(i, jn0), VA::Vector(0.0, 0.0, 0.0), 0.0};
+              iprev = i;
+              inext = jn0;
+              k = 0;
+              while (true) {
+                VA::iadd(run.normal, VA::cross(polyhedron[iprev].position, polyhedron[inext].position));
+                if (field != nullptr and inext < nverts0) run.fieldSum += (*field)[inext];
+                if (run.end == -1 and polyhedron[inext].comp != -1) {
+                  run.end = inext;
+                  run.last = iprev;
+                }
+                if (inext == i or k++ > nverts) break;
+                itmp = inext;
+                inext = internal::nextInFaceLoop(polyhedron[inext], iprev);
+                iprev = itmp;
+                run.face = min(run.face, make_pair(iprev, inext));
+              }
+              PCASSERT2(run.end != -1, internal::dumpSerializedState(initial_state));
+              runs.push_back(run);
+            }
+          }
+        }
+      }
+      const auto nruns = runs.size();
+      vector<int> runEnd(nruns), order(nruns);
+      for (k = 0; k < int(nruns); ++k) runEnd[k] = order[k] = k;
+      std::sort(order.begin(), order.end(), [&](const int a, const int b) { return runs[a].face < runs[b].face; });
+      for (auto k0 = 0u; k0 < nruns; ) {
+        auto k1 = k0 + 1u;
+        while (k1 < nruns and runs[order[k1]].face == runs[order[k0]].face) ++k1;
+        if (k1 - k0 > 1u and field != nullptr and VA::magnitude2(plane.normal) == 0.0 and
+            runs[order[k0]].fieldSum <= 0.0) {
+          // Each retained run on the face ends at the start of the next cut run.
+          vector<int> runFirst(k1 - k0);
+          auto separate = true;
+          for (auto m = k0; m < k1 and separate; ++m) {
+            iprev = runs[order[m]].last;
+            inext = runs[order[m]].end;
+            auto mnext = k1;
+            k = 0;
+            while (mnext == k1 and k++ <= nverts) {
+              for (auto mm = k0; mm < k1; ++mm) {
+                if (runs[order[mm]].start == inext) mnext = mm;
+              }
+              itmp = inext;
+              inext = internal::nextInFaceLoop(polyhedron[inext], iprev);
+              iprev = itmp;
+            }
+            separate = mnext < k1 and runs[order[mnext]].start != runs[order[m]].end;
+            if (separate) runFirst[mnext - k0] = order[m];
+          }
+          if (separate) {
+            for (auto m = k0; m < k1; ++m) runEnd[order[m]] = runFirst[m - k0];
+          }
+        } else if (k1 - k0 > 1u and (field == nullptr or VA::magnitude2(plane.normal) > 0.0)) {
+          const auto direction = VA::cross(plane.normal, runs[order[k0]].normal);
+          vector<int> starts(order.begin() + k0, order.begin() + k1), ends(starts);
+          std::sort(starts.begin(), starts.end(), [&](const int a, const int b) { return VA::dot(polyhedron[runs[a].start].position, direction) < VA::dot(polyhedron[runs[b].start].position, direction); });
+          std::sort(ends.begin(), ends.end(), [&](const int a, const int b) { return VA::dot(polyhedron[runs[a].end].position, direction) < VA::dot(polyhedron[runs[b].end].position, direction); });
+          const auto ncuts = k1 - k0;
+          auto alternate = true;
+          for (auto m = 0u; m < ncuts and alternate; ++m) {
+            const auto s = VA::dot(polyhedron[runs[starts[m]].start].position, direction);
+            const auto e = VA::dot(polyhedron[runs[ends[m]].end].position, direction);
+            alternate = (runs[starts[m]].start != runs[ends[m]].end and s <= e and
+                         (m + 1u == ncuts or e <= VA::dot(polyhedron[runs[starts[m + 1u]].start].position, direction)));
+          }
+          if (alternate) {
+            for (auto m = 0u; m < ncuts; ++m) runEnd[starts[m]] = ends[m];
+          }
+        }
+        k0 = k1;
+      }
+
       // Look for any topology links to clipped nodes we need to patch.
-      // We hit any new vertices first, and then any preexisting that happened to lie exactly in-plane.
       vector<vector<int>> old_neighbors(nverts);
       for (i = 0; i < nverts; ++i) old_neighbors[i] = polyhedron[i].neighbors;
+      auto irun = 0u;
       for (ii = 0; ii < nverts; ++ii) {
         i = (ii + nverts0) % nverts;
         if (polyhedron[i].comp == 0 or polyhedron[i].comp == 2) {
@@ -382,20 +1245,11 @@ void clipPolyhedron(std::vector<Vertex3d<VA>>& polyhedron,
           for (j = 0; j < nneigh; ++j) {
             jn = polyhedron[i].neighbors[j];
             if (polyhedron[jn].comp == -1) {
-              // This neighbor is clipped, so look for the first unclipped vertex along this face loop.
-              iprev = i;
-              inext = jn;
-              itmp = inext;
-              // cerr << i << ": ( " << iprev << " " << inext << ")";
-              k = 0;
-              while (polyhedron[inext].comp == -1 and k++ < nverts) {
-                itmp = inext;
-                inext = internal::nextInFaceLoop(polyhedron[inext], iprev);
-                iprev = itmp;
-                // cerr << " (" << iprev << " " << inext << ")";
-              }
-              // cerr << endl;
-              PCASSERT2(polyhedron[inext].comp != -1, internal::dumpSerializedState(initial_state));
+              // This neighbor is clipped, so link to the end of the paired run.
+              PCASSERT2(irun < nruns and runs[irun].start == i, internal::dumpSerializedState(initial_state));
+              inext = runs[runEnd[irun]].end;
+              iprev = runs[runEnd[irun]].last;
+              ++irun;
               if (polyhedron[i].neighbors[(j + 1u) % polyhedron[i].neighbors.size()] == inext or
                   inext == i) {
                 polyhedron[i].neighbors[j] = -1; // mark to be removed
@@ -423,22 +1277,125 @@ void clipPolyhedron(std::vector<Vertex3d<VA>>& polyhedron,
       }
       // cerr << "After relinking:\n" << polyhedron2string(polyhedron) << endl;
 
-#ifndef NDEBUG
-      {
-        // Check that faces still make sense.
-        auto faces = extractFaces(polyhedron);
-        // cerr << "Faces: " << endl;
-        for (auto face: faces) {
-          // cerr << "    ";
-          // for (auto x: face) cerr << " " << x;
-          // cerr << endl;
-          std::sort(face.begin(), face.end());
-          PCASSERT2(std::unique(face.begin(), face.end()) == face.end(),
-                    "Face loop contains duplicates\n" << internal::dumpSerializedState(initial_state));
+      // The cut faces of a nonlinear field are generally not planar, so their
+      // volume depends on how they are triangulated.  We fan each such face
+      // from a new vertex at its centroid, so that clipping by field and -field
+      // leaves the same cut surface on both pieces.
+      if (field != nullptr and VA::magnitude2(plane.normal) == 0.0) {
+        PCASSERT(meshCut == nullptr);
+        vector<vector<int>> cutLoops;
+        set<pair<int, int>> edgesWalked;
+        for (i = 0; i < nverts; ++i) {
+          if (polyhedron[i].comp == 0 or polyhedron[i].comp == 2) {
+            for (const auto j0: polyhedron[i].neighbors) {
+              if ((polyhedron[j0].comp == 0 or polyhedron[j0].comp == 2) and
+                  edgesWalked.find(make_pair(i, j0)) == edgesWalked.end()) {
+                vector<int> loop(1, i);
+                iprev = i;
+                inext = j0;
+                k = 0;
+                while (inext != i and
+                       (polyhedron[inext].comp == 0 or polyhedron[inext].comp == 2) and
+                       k++ < nverts) {
+                  edgesWalked.insert(make_pair(iprev, inext));
+                  loop.push_back(inext);
+                  itmp = inext;
+                  inext = internal::nextInFaceLoop(polyhedron[inext], iprev);
+                  iprev = itmp;
+                }
+                if (inext == i) {
+                  edgesWalked.insert(make_pair(iprev, inext));
+                  if (loop.size() > 3u) cutLoops.push_back(loop);
+                }
+              }
+            }
+          }
         }
-      }
-#endif
-
+        for (const auto& loop: cutLoops) {
+          const auto n = loop.size();
+          auto centroid = VA::Vector(0.0, 0.0, 0.0);
+          for (const auto iv: loop) VA::iadd(centroid, polyhedron[iv].position);
+          VA::imul(centroid, 1.0/n);
+          auto normal = VA::Vector(0.0, 0.0, 0.0);
+          for (auto m = 0u; m < n; ++m) {
+            VA::iadd(normal, VA::cross(VA::sub(polyhedron[loop[m]].position, centroid),
+                                       VA::sub(polyhedron[loop[(m + 1u) % n]].position, centroid)));
+          }
+          const auto scale = std::sqrt(VA::magnitude(normal));
+          if (scale > 0.0) normal = VA::unitVector(normal);
+          auto planar = true;
+          for (auto m = 0u; m < n and planar; ++m) {
+            planar = std::abs(VA::dot(VA::sub(polyhedron[loop[m]].position, centroid), normal)) <= 1.0e-10*scale;
+          }
+          if (not planar) {
+            inew = polyhedron.size();
+            polyhedron.push_back(Vertex(centroid, 2));
+            polyhedron[inew].neighbors = loop;
+            polyhedron[inew].clips.insert(plane.ID);
+            for (auto m = 0u; m < n; ++m) {
+              auto& neighbors = polyhedron[loop[m]].neighbors;
+              neighbors.insert(find(neighbors.begin(), neighbors.end(), loop[(m + n - 1u) % n]), inew);
+            }
+          }
+        }
+        nverts = polyhedron.size();
+      }
+
+      if (trackCutFaces) {
+        // Clip the faces from prior planes.
+        for (auto kprev = 0; kprev < kplane - 1; ++kprev) {
+          auto& loops = (*cutFaces)[kprev].loops;
+          for (auto& loop: loops) internal::clipVertexLoop(loop, polyhedron, edgeVertices, true);
+          internal::rewalkFaceLoops(loops, polyhedron);
+        }
+
+        // The new face loops are those made up entirely of vertices in the plane.
+        auto& loops = (*cutFaces)[kplane - 1].loops;
+        set<pair<int, int>> edgesWalked;
+        for (i = 0; i < nverts; ++i) {
+          if (polyhedron[i].comp == 0 or polyhedron[i].comp == 2) {
+            for (const auto j0: polyhedron[i].neighbors) {
+              if ((polyhedron[j0].comp == 0 or polyhedron[j0].comp == 2) and
+                  edgesWalked.find(make_pair(i, j0)) == edgesWalked.end()) {
+                vector<int> loop(1, i);
+                iprev = i;
+                inext = j0;
+                k = 0;
+                while (inext != i and
+                       (polyhedron[inext].comp == 0 or polyhedron[inext].comp == 2) and
+                       k++ < nverts) {
+                  edgesWalked.insert(make_pair(iprev, inext));
+                  loop.push_back(inext);
+                  itmp = inext;
+                  inext = internal::nextInFaceLoop(polyhedron[inext], iprev);
+                  iprev = itmp;
+                }
+                if (inext == i) {
+                  edgesWalked.insert(make_pair(iprev, inext));
+                  if (loop.size() >= 3u) loops.push_back(loop);
+                }
+              }
+            }
+          }
+        }
+      }
+
+#ifndef NDEBUG
+      {
+        // Check that faces still make sense.
+        auto faces = extractFaces(polyhedron);
+        // cerr << "Faces: " << endl;
+        for (auto face: faces) {
+          // cerr << "    ";
+          // for (auto x: face) cerr << " " << x;
+          // cerr << endl;
+          std::sort(face.begin(), face.end());
+          PCASSERT2(std::unique(face.begin(), face.end()) == face.end(),
+                    "Face loop contains duplicates\n" << internal::dumpSerializedState(initial_state));
+        }
+      }
+#endif
+
       // Remove the clipped vertices and collapse degenerates, compressing the polyhedron.
       i = 0;
       xmin = std::numeric_limits<double>::max(), xmax = std::numeric_limits<double>::lowest();
@@ -469,6 +1426,21 @@ void clipPolyhedron(std::vector<Vertex3d<VA>>& polyhedron,
           }
         }
       }
+      if (trackCutFaces) {
+        for (auto kprev = 0; kprev < kplane; ++kprev) {
+          for (auto& loop: (*cutFaces)[kprev].loops) {
+            for (auto& iv: loop) iv = polyhedron[iv].ID;
+          }
+        }
+      }
+      if (meshCut != nullptr) {
+        auto& ids = meshCut->ids;
+        auto nkeep = 0u;
+        for (i = 0; i < nverts; ++i) {
+          if (polyhedron[i].comp >= 0) ids[nkeep++] = ids[i];
+        }
+        ids.resize(nkeep);
+      }
       polyhedron.erase(std::remove_if(polyhedron.begin(), polyhedron.end(), [](Vertex& v) { return v.comp < 0; }), polyhedron.end());
 
       // Is the polyhedron gone?
@@ -484,14 +1456,415 @@ void clipPolyhedron(std::vector<Vertex3d<VA>>& polyhedron,
       }
     }
   }
+  if (meshCut != nullptr and polyhedron.empty()) meshCut->ids.clear();
+
+  // Measure the surviving cut faces, which are outward facing (-normal).
+  if (trackCutFaces) {
+    for (auto kp = 0u; kp < nplanes; ++kp) {
+      auto& cutFace = (*cutFaces)[kp];
+      if (polyhedron.empty()) cutFace.loops.clear();
+      cutFace.area = 0.0;
+      cutFace.centroid = VA::Vector(0.0, 0.0, 0.0);
+      const auto direction = VA::neg(planes[kp].normal);
+      for (const auto& loop: cutFace.loops) {
+        internal::accumulateFacetMoments(cutFace.area, cutFace.centroid, polyhedron, loop, direction);
+      }
+      VA::imul(cutFace.centroid, internal::safeInv(3.0*cutFace.area));
+    }
+  }
+}
+
 }
 
 //------------------------------------------------------------------------------
-// Collapse degenerate vertices.
+// Clip a polyhedron by planes.
+//------------------------------------------------------------------------------
+template<typename VA>
+void clipPolyhedron(std::vector<Vertex3d<VA>>& polyhedron,
+                    const std::vector<Plane<VA>>& planes) {
+  internal::clipPolyhedronImpl(polyhedron, planes, static_cast<std::vector<CutFace<VA>>*>(nullptr), static_cast<const std::vector<double>*>(nullptr), static_cast<internal::MeshCut<VA>*>(nullptr));
+}
+
+//------------------------------------------------------------------------------
+// Clip a polyhedron by planes, returning the cut faces.
+//------------------------------------------------------------------------------
+template<typename VA>
+void clipPolyhedron(std::vector<Vertex3d<VA>>& polyhedron,
+                    const std::vector<Plane<VA>>& planes,
+                    std::vector<CutFace<VA>>& cutFaces) {
+  internal::clipPolyhedronImpl(polyhedron, planes, &cutFaces, static_cast<const std::vector<double>*>(nullptr), static_cast<internal::MeshCut<VA>*>(nullptr));
+}
+
+//------------------------------------------------------------------------------
+// Reduce a set of planes for clipping a polyhedron.  Two planes are merged if their
+// signed distances differ by less than tol at every vertex of the polyhedron, in
+// which case the first is kept.  A merged plane is then needed only if it cuts
+// more than tol into the convex hull of the polyhedron above the other planes,
+// which we check without clipping: the dual hull about an interior point prunes
+// most of them, and a small linear program checks each of the rest.  If the
+// result is empty we can't tell which planes are needed, and keep them all.
+//------------------------------------------------------------------------------
+template<typename VA>
+void simplifyPlanes(std::vector<Plane<VA>>& result,
+                    std::vector<int>& planeMap,
+                    const std::vector<Vertex3d<VA>>& poly,
+                    const std::vector<Plane<VA>>& planes,
+                    const double tol) {
+  const int nplanes = planes.size();
+  const int nverts = poly.size();
+  result.clear();
+  planeMap.assign(nplanes, -1);
+  if (nverts == 0) return;
+
+  // Merge the coplanar planes.
+  vector<double> dist(nplanes*nverts);
+  for (auto k = 0; k < nplanes; ++k) {
+    for (auto i = 0; i < nverts; ++i) dist[k*nverts + i] = planes[k].dist + VA::dot(planes[k].normal, poly[i].position);
+  }
+  vector<int> rep(nplanes);
+  vector<Plane<VA>> merged;
+  for (auto k = 0; k < nplanes; ++k) {
+    rep[k] = k;
+    for (auto j = 0; j < k and rep[k] == k; ++j) {
+      if (rep[j] == j and VA::dot(planes[j].normal, planes[k].normal) > 0.0) {
+        auto i = 0;
+        while (i < nverts and std::abs(dist[k*nverts + i] - dist[j*nverts + i]) < tol) ++i;
+        if (i == nverts) rep[k] = j;
+      }
+    }
+    if (rep[k] == k) merged.push_back(planes[k]);
+  }
+
+  // Planes above every vertex are redundant, while one below every vertex
+  // leaves nothing.
+  const int nmerged = merged.size();
+  vector<int> mergedIndex(nplanes, -1), resultIndex(nmerged, -1), redundant(nmerged, 0);
+  auto empty = false;
+  for (auto k = 0, m = 0; k < nplanes; ++k) {
+    if (rep[k] == k) {
+      mergedIndex[k] = m;
+      const auto minmax = std::minmax_element(&dist[k*nverts], &dist[(k + 1)*nverts]);
+      redundant[m] = (*minmax.first >= -tol);
+      empty = empty or (*minmax.second <= 0.0);
+      ++m;
+    }
+  }
+
+  // Check the rest over the convex hull of the polyhedron.
+  if (not empty) {
+    vector<typename VA::VECTOR> points;
+    for (const auto& v: poly) points.push_back(v.position);
+    vector<Vertex3d<VA>> hull;
+    convexHull(hull, points);
+    vector<Plane<VA>> bounds;
+    for (const auto& facet: extractFaces(hull)) {
+      const auto& p0 = hull[facet[0]].position;
+      auto areaVec = VA::Vector(0.0, 0.0, 0.0);
+      for (auto m = 1u; m + 1u < facet.size(); ++m) {
+        VA::iadd(areaVec, VA::cross(VA::sub(hull[facet[m]].position, p0),
+                                    VA::sub(hull[facet[m + 1u]].position, p0)));
+      }
+      bounds.push_back(Plane<VA>(p0, VA::unitVector(VA::neg(areaVec))));
+    }
+    auto xmin = poly[0].position, xmax = poly[0].position;
+    for (const auto& v: hull) {
+      VA::x(xmin) = min(VA::x(xmin), VA::x(v.position));
+      VA::y(xmin) = min(VA::y(xmin), VA::y(v.position));
+      VA::z(xmin) = min(VA::z(xmin), VA::z(v.position));
+      VA::x(xmax) = max(VA::x(xmax), VA::x(v.position));
+      VA::y(xmax) = max(VA::y(xmax), VA::y(v.position));
+      VA::z(xmax) = max(VA::z(xmax), VA::z(v.position));
+    }
+    const auto center = VA::mul(VA::add(xmin, xmax), 0.5);
+    const auto halfWidth = 0.5*max(VA::x(xmax) - VA::x(xmin), max(VA::y(xmax) - VA::y(xmin), VA::z(xmax) - VA::z(xmin)));
+
+    // About an interior point, a plane (or bound) is needed only if its dual
+    // point is a vertex of the dual hull, which leaves just a few for the
+    // linear programs.
+    const int nbounds = bounds.size();
+    vector<Plane<VA>> active(bounds);
+    vector<int> activeIndex(nbounds, -1);
+    for (auto m = 0; m < nmerged; ++m) {
+      if (not redundant[m]) {
+        active.push_back(merged[m]);
+        activeIndex.push_back(m);
+      }
+    }
+    auto x0 = center;
+    double radius;
+    empty = (hull.size() < 4 or
+             not internal::inscribedBall(x0, radius, active, center, halfWidth, 3));
+    if (not empty and radius > tol) {
+      vector<typename VA::VECTOR> dual;
+      auto qmax = 0.0;
+      for (const auto& plane: active) {
+        dual.push_back(VA::div(VA::neg(plane.normal), plane.dist + VA::dot(plane.normal, x0)));
+        qmax = max(qmax, VA::magnitude(dual.back()));
+      }
+      const auto facets = internal::convexHullFacets<VA>(dual, 1.0e-10*qmax);
+      if (facets.size() >= 4u) {
+        vector<int> onHull(active.size(), 0);
+        for (const auto& facet: facets) {
+          for (const auto i: facet) onHull[i] = 1;
+        }
+        bounds.clear();
+        for (auto i = 0; i < int(active.size()); ++i) {
+          if (i < nbounds and onHull[i]) bounds.push_back(active[i]);
+          if (i >= nbounds and not onHull[i]) redundant[activeIndex[i]] = 1;
+        }
+      }
+    }
+    empty = (empty or
+             not internal::flagRedundantPlanes(redundant, merged, bounds, center, halfWidth, 3, tol));
+  }
+  for (auto m = 0; m < nmerged; ++m) {
+    if (empty or not redundant[m]) {
+      resultIndex[m] = result.size();
+      result.push_back(merged[m]);
+    }
+  }
+  for (auto k = 0; k < nplanes; ++k) planeMap[k] = resultIndex[mergedIndex[rep[k]]];
+}
+
+//------------------------------------------------------------------------------
+// Check whether clipping a polyhedron by planes leaves a non-zero volume.  Most
+// queries are answered by the vertex distances alone: the result is empty if
+// every vertex is below any one plane, and not if some vertex is above all of
+// them.  Otherwise a convex polyhedron is the region above its faces, so we
+// look for a ball above both its faces and the planes by linear programming.
+// A non-convex polyhedron falls back to clipping a copy.
+//------------------------------------------------------------------------------
+template<typename VA>
+bool intersectsHalfspaces(const std::vector<Vertex3d<VA>>& poly,
+                          const std::vector<Plane<VA>>& planes) {
+  const int nverts = poly.size();
+  if (nverts < 4) return false;
+  auto xmin = poly[0].position, xmax = poly[0].position;
+  for (const auto& v: poly) {
+    VA::x(xmin) = min(VA::x(xmin), VA::x(v.position));
+    VA::y(xmin) = min(VA::y(xmin), VA::y(v.position));
+    VA::z(xmin) = min(VA::z(xmin), VA::z(v.position));
+    VA::x(xmax) = max(VA::x(xmax), VA::x(v.position));
+    VA::y(xmax) = max(VA::y(xmax), VA::y(v.position));
+    VA::z(xmax) = max(VA::z(xmax), VA::z(v.position));
+  }
+  const auto extent = VA::magnitude(VA::sub(xmax, xmin));
+  if (extent == 0.0) return false;
+  const auto tol = 1.0e-10*extent;
+
+  // Check the vertices against each plane.
+  vector<double> minDist(nverts, std::numeric_limits<double>::max());
+  for (const auto& plane: planes) {
+    auto maxDist = std::numeric_limits<double>::lowest();
+    for (auto i = 0; i < nverts; ++i) {
+      const auto di = plane.dist + VA::dot(plane.normal, poly[i].position);
+      maxDist = max(maxDist, di);
+      minDist[i] = min(minDist[i], di);
+    }
+    if (maxDist <= tol) return false;
+  }
+  for (auto i = 0; i < nverts; ++i) {
+    if (minDist[i] > tol) return true;
+  }
+
+  // Collect the face planes, checking the polyhedron is convex.
+  vector<Plane<VA>> halfspaces(planes);
+  auto convex = true;
+  const auto facets = extractFaces(poly);
+  for (auto k = 0u; k < facets.size() and convex; ++k) {
+    const auto& facet = facets[k];
+    const auto& p0 = poly[facet[0]].position;
+    auto areaVec = VA::Vector(0.0, 0.0, 0.0);
+    for (auto m = 1u; m + 1u < facet.size(); ++m) {
+      VA::iadd(areaVec, VA::cross(VA::sub(poly[facet[m]].position, p0),
+                                  VA::sub(poly[facet[m + 1u]].position, p0)));
+    }
+    const auto area = VA::magnitude(areaVec);
+    if (area <= tol*extent) continue;
+    halfspaces.push_back(Plane<VA>(p0, VA::div(areaVec, -area)));
+    for (auto j = 0; j < nverts and convex; ++j) convex = halfspaces.back().dist + VA::dot(halfspaces.back().normal, poly[j].position) >= -tol;
+  }
+  if (not convex) {
+    auto clipped = poly;
+    clipPolyhedron(clipped, planes);
+    double vol;
+    typename VA::VECTOR centroid;
+    moments(vol, centroid, clipped);
+    return vol > tol*extent*extent;
+  }
+  const auto center = VA::mul(VA::add(xmin, xmax), 0.5);
+  const auto halfWidth = 0.5*max(VA::x(xmax) - VA::x(xmin), max(VA::y(xmax) - VA::y(xmin), VA::z(xmax) - VA::z(xmin)));
+  return internal::planesEncloseVolume(halfspaces, center, halfWidth, 3, tol);
+}
+
+//------------------------------------------------------------------------------
+// Clip a polyhedron by a field sampled at its vertices.
+//------------------------------------------------------------------------------
+template<typename VA>
+void clipByVertexField(std::vector<Vertex3d<VA>>& polyhedron,
+                       const std::vector<double>& field,
+                       const int ID) {
+  // A linear field is the distance to a plane, whose normal lets the clip pair
+  // up the cut edges on the non-convex faces.  A nonlinear field has no such
+  // direction, and walking the old face loops only keeps the cut faces inside
+  // a convex polyhedron.
+  auto normal = VA::Vector(0.0, 0.0, 0.0);
+  if (internal::linearFieldGradient<VA>(normal, polyhedron, field, 3) and
+      VA::magnitude2(normal) > 0.0) normal = VA::unitVector(normal);
+  PCASSERT2(VA::magnitude2(normal) > 0.0 or
+            not internal::fieldChangesSign(field) or
+            internal::isConvex(polyhedron),
+            "clipByVertexField: a nonlinear field can only cut a convex polyhedron");
+  internal::clipPolyhedronImpl(polyhedron,
+                               std::vector<Plane<VA>>(1, Plane<VA>(0.0, normal, ID)),
+                               static_cast<std::vector<CutFace<VA>>*>(nullptr),
+                               &field,
+                               static_cast<internal::MeshCut<VA>*>(nullptr));
+}
+
+//------------------------------------------------------------------------------
+// Clip a mesh by a plane.  We compute the signed distance of each mesh point
+// once, and each cell is clipped classifying its vertices by the distances of
+// their global IDs.  The new point on each crossing edge is computed by the
+// first cell to cut it and cached by its (clipped, surviving) pair of global
+// IDs, so the other cells sharing the edge reuse the same point.
+//------------------------------------------------------------------------------
+template<typename VA>
+void clipMesh(std::vector<std::vector<Vertex3d<VA>>>& cells,
+              std::vector<std::vector<int>>& cellVertices,
+              std::vector<typename VA::VECTOR>& points,
+              const Plane<VA>& plane) {
+  const auto ncells = cells.size();
+  PCASSERT(cellVertices.size() == ncells);
+  const auto npoints = points.size();
+  vector<double> dist(npoints), field;
+  for (auto k = 0u; k < npoints; ++k) dist[k] = plane.dist + VA::dot(plane.normal, points[k]);
+  internal::MeshCut<VA> meshCut(points, dist);
+  const vector<Plane<VA>> planes(1, plane);
+  for (auto c = 0u; c < ncells; ++c) {
+    auto& ids = cellVertices[c];
+    const auto n = ids.size();
+    PCASSERT(cells[c].size() == n);
+    field.resize(n);
+    for (auto i = 0u; i < n; ++i) field[i] = dist[ids[i]];
+    meshCut.ids.swap(ids);
+    internal::clipPolyhedronImpl(cells[c], planes, static_cast<std::vector<CutFace<VA>>*>(nullptr), &field, &meshCut);
+    meshCut.ids.swap(ids);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Assemble a conforming mesh from independent polyhedra.  All the vertices are
+// welded to the first member of their class within tol (found with a spatial
+// hash), each class taking the position of that member.  Faces are then matched by their (sorted) sets of welded
+// vertices: the first cell to see a face owns it, and the second is recorded
+// as its neighbor.  Repeated vertices left in a face loop by the welding are
+// dropped, as are the faces that collapse to fewer than three vertices.
+//------------------------------------------------------------------------------
+template<typename VA>
+void assembleMesh(ConformingMesh<VA>& mesh,
+                  const std::vector<std::vector<Vertex3d<VA>>>& cells,
+                  const double tol) {
+  mesh = ConformingMesh<VA>();
+  const auto ncells = cells.size();
+
+  // Weld the vertices.
+  vector<typename VA::VECTOR> positions;
+  for (const auto& cell: cells) {
+    for (const auto& v: cell) positions.push_back(v.position);
+  }
+  vector<int> labels;
+  internal::weldPoints<VA>(labels, mesh.points, positions, tol);
+
+  // Walk the faces of each cell.
+  map<vector<int>, int> faceIDs;
+  vector<int> loop, key;
+  mesh.cellVertexOffsets.push_back(0);
+  mesh.cellFaceOffsets.push_back(0);
+  mesh.faceVertexOffsets.push_back(0);
+  auto offset = 0;
+  for (auto c = 0u; c < ncells; ++c) {
+    const auto& cell = cells[c];
+    const auto n = cell.size();
+    for (auto i = 0u; i < n; ++i) mesh.cellVertices.push_back(labels[offset + i]);
+    const auto faces = extractFaces(cell);
+    for (const auto& face: faces) {
+      loop.clear();
+      for (const auto i: face) {
+        const auto k = labels[offset + i];
+        if (loop.empty() or loop.back() != k) loop.push_back(k);
+      }
+      while (loop.size() > 1 and loop.back() == loop.front()) loop.pop_back();
+      if (loop.size() < 3) continue;
+      key = loop;
+      std::sort(key.begin(), key.end());
+      const auto itr = faceIDs.find(key);
+      if (itr == faceIDs.end()) {
+        const int f = mesh.faceCells.size()/2;
+        faceIDs[key] = f;
+        mesh.faceVertices.insert(mesh.faceVertices.end(), loop.begin(), loop.end());
+        mesh.faceVertexOffsets.push_back(mesh.faceVertices.size());
+        mesh.faceCells.push_back(c);
+        mesh.faceCells.push_back(-1);
+        mesh.cellFaces.push_back(f);
+      } else {
+        const auto f = itr->second;
+        PCASSERT2(mesh.faceCells[2*f + 1] == -1, "assembleMesh: face shared by more than two cells");
+        mesh.faceCells[2*f + 1] = c;
+        mesh.cellFaces.push_back(~f);
+      }
+    }
+    mesh.cellVertexOffsets.push_back(mesh.cellVertices.size());
+    mesh.cellFaceOffsets.push_back(mesh.cellFaces.size());
+    offset += n;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Weld the vertices of a set of polyhedra.  Each vertex joins the class of the
+// nearest earlier class representative within tol (found with a spatial hash)
+// and is snapped to it, so vertices in the same class end up with identical
+// positions, and never more than tol from where they started.
+//------------------------------------------------------------------------------
+template<typename VA>
+int weldVertices(std::vector<std::vector<Vertex3d<VA>>>& polys,
+                 const double tol,
+                 std::vector<std::vector<int>>& vertexClasses) {
+  vector<typename VA::VECTOR> positions, representatives;
+  for (const auto& poly: polys) {
+    for (const auto& v: poly) positions.push_back(v.position);
+  }
+  vector<int> labels;
+  const auto nclasses = internal::weldPoints<VA>(labels, representatives, positions, tol);
+  vertexClasses.resize(polys.size());
+  auto k = 0;
+  for (auto i = 0u; i < polys.size(); ++i) {
+    auto& poly = polys[i];
+    vertexClasses[i].resize(poly.size());
+    for (auto j = 0u; j < poly.size(); ++j) {
+      vertexClasses[i][j] = labels[k];
+      poly[j].position = representatives[labels[k]];
+      ++k;
+    }
+  }
+  return nclasses;
+}
+
+//------------------------------------------------------------------------------
+// Collapse degenerate vertices.  Each cluster grows from its lowest indexed
+// vertex across the edges of its members, but only takes in vertices within
+// tol of that first vertex, so a finely sampled surface is thinned rather than
+// collapsed.  The neighbors of the first vertex are found by walking once
+// around the cluster: stepping along an edge (v, u) inside the cluster
+// continues with the neighbor after v around u, just as if u were spliced into
+// the neighbors of v.  Vertices left dangling, and components left with fewer
+// than four vertices, are removed.  vertexMap reports the output vertex each
+// input vertex was merged into (-1 if removed).
 //------------------------------------------------------------------------------
 template<typename VA>
 void collapseDegenerates(std::vector<Vertex3d<VA>>& polyhedron,
-                         const double tol) {
+                         const double tol,
+                         std::vector<int>& vertexMap) {
 
   // Prepare to dump the input state if we hit an exception
   std::vector<char> initial_state;
@@ -504,110 +1877,151 @@ void collapseDegenerates(std::vector<Vertex3d<VA>>& polyhedron,
 
   using Vertex = Vertex3d<VA>;
   const auto tol2 = tol*tol;
-  auto n = polyhedron.size();
+  const int n = polyhedron.size();
+  vertexMap.resize(n);
+  for (auto i = 0; i < n; ++i) vertexMap[i] = i;
   if (n > 0) {
 
-    // Set the initial ID's the vertices.
-    for (auto i = 0; i < n; ++i) polyhedron[i].ID = i;
-
-    // cerr << "Initial: " << endl << polyhedron2string(polyhedron) << endl;
-
-    // Walk the polyhedron removing degenerate edges until we make a sweep without
-    // removing any.  Don't worry about ordering of the neighbors yet.
+    // Grow a cluster from each unassigned vertex in turn, taking in the
+    // vertices linked to the cluster that are within tol of its first vertex.
+    for (auto i = 0; i < n; ++i) vertexMap[i] = -1;
+    vector<int> count(n, 0), stack;
     auto active = false;
+    auto nlinks = 0;
     for (auto i = 0; i < n; ++i) {
-      if (polyhedron[i].ID >= 0) {
-        auto idone = false;
-        while (not idone) {
-          idone = true;
-          for (auto jneigh = 0; jneigh < polyhedron[i].neighbors.size(); ++jneigh) {
-            const auto j = polyhedron[i].neighbors[jneigh];
-            PCASSERT2(polyhedron[j].ID >= 0, internal::dumpSerializedState(initial_state));
-            if (VA::magnitude2(VA::sub(polyhedron[i].position, polyhedron[j].position)) < tol2) {
-              // cerr << " --> collapasing " << j << " to " << i;
+      nlinks += polyhedron[i].neighbors.size();
+      if (vertexMap[i] == -1) {
+        vertexMap[i] = i;
+        count[i] = 1;
+        stack.assign(1, i);
+        while (not stack.empty()) {
+          const auto v = stack.back();
+          stack.pop_back();
+          for (const auto j: polyhedron[v].neighbors) {
+            PCASSERT2(j != v, internal::dumpSerializedState(initial_state));
+            if (vertexMap[j] == -1 and
+                VA::magnitude2(VA::sub(polyhedron[i].position, polyhedron[j].position)) < tol2) {
+              vertexMap[j] = i;
+              ++count[i];
+              stack.push_back(j);
               active = true;
-              idone = false;
-              polyhedron[j].ID = -1;
-              polyhedron[i].clips.insert(polyhedron[j].clips.begin(), polyhedron[j].clips.end());
-
-              // Merge the neighbors of j->i.
-              auto jitr = polyhedron[i].neighbors.begin() + jneigh;
-              auto kitr = find(polyhedron[j].neighbors.begin(), polyhedron[j].neighbors.end(), i);
-              PCASSERT2(kitr != polyhedron[j].neighbors.end(), internal::dumpSerializedState(initial_state));
-              jitr = polyhedron[i].neighbors.insert(jitr, polyhedron[j].neighbors.begin(), kitr);
-              jitr = polyhedron[i].neighbors.insert(jitr, kitr+1, polyhedron[j].neighbors.end());  // jitr now points at the first of the newly inserted neighbors
-
-              // Make sure i & j are removed from the neighbor set of i.
-              polyhedron[i].neighbors.erase(remove_if(polyhedron[i].neighbors.begin(), polyhedron[i].neighbors.end(),
-                                                      [&](const int val) { return val == i or val == j; }), 
-                                            polyhedron[i].neighbors.end());
-
-              // Remove any adjacent repeats.
-              for (auto kitr = polyhedron[i].neighbors.begin(); kitr < polyhedron[i].neighbors.end() - 1; ++kitr) {
-                if (*kitr == *(kitr + 1)) kitr = polyhedron[i].neighbors.erase(kitr);
-              }
-              if (polyhedron[i].neighbors.front() == polyhedron[i].neighbors.back()) polyhedron[i].neighbors.pop_back();
-
-              // {
-              //   cerr << " : new neighbors of " << i << " [";
-              //   std::copy(polyhedron[i].neighbors.begin(), polyhedron[i].neighbors.end(), ostream_iterator<int>(cerr, " "));
-              //   cerr << "]" << endl;
-              // }
-
-              // Make all the neighbors of j point back at i instead of j.
-              for (auto k: polyhedron[j].neighbors) {
-                 // i is a neighbor to j, and j has already been removed from list
-                 // also, i can not be a neighbor to itself
-                 if (k != i) {
-                    auto itr = find(polyhedron[k].neighbors.begin(), polyhedron[k].neighbors.end(), j);
-                    // PCASSERT(itr != polyhedron[k].neighbors.end());
-                    if (itr != polyhedron[k].neighbors.end()) *itr = i;
-                 }
-              }
             }
           }
         }
       }
     }
 
-    // cerr << "After relinking: " << endl << polyhedron2string(polyhedron) << endl;
-
     if (active) {
 
-      // Renumber the nodes assuming we're going to clear out the degenerates.
-      auto offset = 0;
+      // Find the neighbors of each cluster.  Unmerged vertices just map their
+      // neighbors, while clusters are walked from the first edge leaving them.
       for (auto i = 0; i < n; ++i) {
-        if (polyhedron[i].ID == -1) {
-          --offset;
+        const auto r = vertexMap[i];
+        polyhedron[i].ID = -1;
+        if (r != i) polyhedron[r].clips.insert(polyhedron[i].clips.begin(), polyhedron[i].clips.end());
+      }
+      vector<vector<int>> newNeighbors(n);
+      for (auto i = 0; i < n; ++i) {
+        const auto r = vertexMap[i];
+        if (polyhedron[r].ID == 0) continue;
+        const auto& ineighbors = polyhedron[i].neighbors;
+        const int nneigh = ineighbors.size();
+        if (count[r] == 1) {
+          for (const auto j: ineighbors) newNeighbors[r].push_back(vertexMap[j]);
+          polyhedron[r].ID = 0;
         } else {
-          polyhedron[i].ID += offset;
+          auto k0 = 0;
+          while (k0 < nneigh and vertexMap[ineighbors[k0]] == r) ++k0;
+          if (k0 == nneigh) continue;
+          auto v = i, k = k0, nsteps = 0;
+          do {
+            const auto u = polyhedron[v].neighbors[k];
+            if (vertexMap[u] == r) {
+              const auto& uneighbors = polyhedron[u].neighbors;
+              const auto vitr = find(uneighbors.begin(), uneighbors.end(), v);
+              PCASSERT2(vitr != uneighbors.end(), internal::dumpSerializedState(initial_state));
+              k = (std::distance(uneighbors.begin(), vitr) + 1) % uneighbors.size();
+              v = u;
+            } else {
+              newNeighbors[r].push_back(vertexMap[u]);
+              k = (k + 1) % polyhedron[v].neighbors.size();
+            }
+            PCASSERT2(++nsteps <= nlinks, internal::dumpSerializedState(initial_state));
+          } while (v != i or k != k0);
+          polyhedron[r].ID = 0;
         }
+
+        // Remove any adjacent repeats.
+        auto& rneighbors = newNeighbors[r];
+        rneighbors.erase(unique(rneighbors.begin(), rneighbors.end()), rneighbors.end());
+        while (rneighbors.size() > 1 and rneighbors.front() == rneighbors.back()) rneighbors.pop_back();
       }
-      for (auto& v: polyhedron) {
-        for (auto itr = v.neighbors.begin(); itr < v.neighbors.end(); ++itr) {
-          *itr = polyhedron[*itr].ID;
+
+      // A vertex all of whose neighbors merged into one cluster is left as a
+      // dangling edge (its faces have collapsed), so we prune those in turn.
+      for (auto i = 0; i < n; ++i) {
+        if (polyhedron[i].ID == 0 and newNeighbors[i].size() < 2u) stack.push_back(i);
+      }
+      while (not stack.empty()) {
+        const auto v = stack.back();
+        stack.pop_back();
+        if (polyhedron[v].ID == 0) {
+          polyhedron[v].ID = -1;
+          for (const auto u: newNeighbors[v]) {
+            auto& uneighbors = newNeighbors[u];
+            uneighbors.erase(std::remove(uneighbors.begin(), uneighbors.end(), v), uneighbors.end());
+            uneighbors.erase(unique(uneighbors.begin(), uneighbors.end()), uneighbors.end());
+            while (uneighbors.size() > 1 and uneighbors.front() == uneighbors.back()) uneighbors.pop_back();
+            if (uneighbors.size() < 2u) stack.push_back(u);
+          }
         }
-        v.neighbors.erase(remove_if(v.neighbors.begin(), v.neighbors.end(), [](const int x) { return x < 0; }), v.neighbors.end());
+      }
 
-        // Remove any adjacent repeats.
-        for (auto kitr = v.neighbors.begin(); kitr < v.neighbors.end() - 1; ++kitr) {
-          if (*kitr == *(kitr + 1)) kitr = v.neighbors.erase(kitr);
+      // Drop any component left with too few vertices to enclose a volume.
+      vector<int> parent(n);
+      for (auto i = 0; i < n; ++i) {
+        parent[i] = i;
+        count[i] = 0;
+      }
+      for (auto i = 0; i < n; ++i) {
+        if (polyhedron[i].ID == 0) {
+          for (const auto j: newNeighbors[i]) internal::unionFindJoin(parent, i, j);
         }
-        if (v.neighbors.front() == v.neighbors.back()) v.neighbors.pop_back();
+      }
+      for (auto i = 0; i < n; ++i) {
+        if (polyhedron[i].ID == 0) ++count[internal::unionFindRoot(parent, i)];
+      }
+      for (auto i = 0; i < n; ++i) {
+        if (polyhedron[i].ID == 0 and count[internal::unionFindRoot(parent, i)] < 4) polyhedron[i].ID = -1;
       }
 
-      // Erase the inactive vertices.
+      // Renumber the surviving clusters and clear out the rest.
+      auto nnew = 0;
+      for (auto i = 0; i < n; ++i) {
+        if (polyhedron[i].ID == 0) polyhedron[i].ID = nnew++;
+      }
+      for (auto i = 0; i < n; ++i) vertexMap[i] = polyhedron[vertexMap[i]].ID;
+      for (auto i = 0; i < n; ++i) {
+        if (polyhedron[i].ID >= 0) {
+          polyhedron[i].neighbors.swap(newNeighbors[i]);
+          for (auto& j: polyhedron[i].neighbors) j = polyhedron[j].ID;
+        }
+      }
       polyhedron.erase(remove_if(polyhedron.begin(), polyhedron.end(), [](const Vertex& v) { return v.ID < 0; }), polyhedron.end());
-      if (polyhedron.size() < 4) polyhedron.clear();
+      if (polyhedron.size() < 4) {
+        polyhedron.clear();
+        vertexMap.assign(n, -1);
+      }
+
+    } else {
+      for (auto i = 0; i < n; ++i) polyhedron[i].ID = i;
     }
   }
 
-  // cerr << "Final: " << endl << polyhedron2string(polyhedron) << endl;
-
   // Post-conditions.
 #ifndef NDEBUG
   {
-    const auto n = polyhedron.size();
+    const int n = polyhedron.size();
     for (auto i = 0; i < n; ++i) {
       PCASSERT2(polyhedron[i].ID == i, internal::dumpSerializedState(initial_state));
       for (auto j: polyhedron[i].neighbors) PCASSERT2(j >= 0 and j < n, internal::dumpSerializedState(initial_state));
@@ -617,6 +2031,59 @@ void collapseDegenerates(std::vector<Vertex3d<VA>>& polyhedron,
 
 }
 
+//------------------------------------------------------------------------------
+// Collapse degenerate vertices.
+//------------------------------------------------------------------------------
+template<typename VA>
+void collapseDegenerates(std::vector<Vertex3d<VA>>& polyhedron,
+                         const double tol) {
+  std::vector<int> vertexMap;
+  collapseDegenerates(polyhedron, tol, vertexMap);
+}
+
+//------------------------------------------------------------------------------
+// Label the connected components with a union-find over the neighbor links.
+//------------------------------------------------------------------------------
+template<typename VA>
+int splitComponents(std::vector<int>& componentIDs,
+                    const std::vector<Vertex3d<VA>>& poly) {
+  const int n = poly.size();
+  vector<int> parent(n);
+  for (auto i = 0; i < n; ++i) parent[i] = i;
+  for (auto i = 0; i < n; ++i) {
+    for (const auto j: poly[i].neighbors) internal::unionFindJoin(parent, i, j);
+  }
+  return internal::unionFindLabels(componentIDs, parent);
+}
+
+//------------------------------------------------------------------------------
+// Split into compacted components.  The vertices keep their order within each
+// component, and their ID is set to their index in the input polyhedron.
+//------------------------------------------------------------------------------
+template<typename VA>
+void splitComponents(std::vector<std::vector<Vertex3d<VA>>>& components,
+                     std::vector<double>& zerothMoments,
+                     std::vector<typename VA::VECTOR>& firstMoments,
+                     const std::vector<Vertex3d<VA>>& poly) {
+  vector<int> componentIDs;
+  const auto ncomps = splitComponents(componentIDs, poly);
+  const int n = poly.size();
+  components.assign(ncomps, std::vector<Vertex3d<VA>>());
+  vector<int> local(n);
+  for (auto i = 0; i < n; ++i) {
+    local[i] = components[componentIDs[i]].size();
+    components[componentIDs[i]].push_back(poly[i]);
+  }
+  for (auto i = 0; i < n; ++i) {
+    auto& v = components[componentIDs[i]][local[i]];
+    for (auto& j: v.neighbors) j = local[j];
+    v.ID = i;
+  }
+  zerothMoments.resize(ncomps);
+  firstMoments.resize(ncomps);
+  for (auto c = 0; c < ncomps; ++c) moments(zerothMoments[c], firstMoments[c], components[c]);
+}
+
 //------------------------------------------------------------------------------
 // Return the vertices ordered in faces.
 // Implicitly uses the convention that neighbors for each vertex are arranged
@@ -732,6 +2199,349 @@ commonFaceClips(const std::vector<Vertex3d<VA>>& poly,
   return faceClips;
 }
 
+namespace internal {
+
+//------------------------------------------------------------------------------
+// Triangulate the faces of a polyhedron, returning flat triples of vertex
+// indices oriented like the faces.  Each face is projected onto its own
+// (Newell) plane and ear clipped, so non-convex faces are fine.
+//------------------------------------------------------------------------------
+template<typename VA>
+inline
+void
+triangulatePolyhedronFaces(std::vector<int>& tris,
+                           const std::vector<Vertex3d<VA>>& poly,
+                           const std::vector<std::vector<int>>& faces) {
+  std::vector<int> local;
+  std::vector<double> xy;
+  for (const auto& face: faces) {
+    const auto n = face.size();
+    PCASSERT(n >= 3);
+    const auto& p0 = poly[face[0]].position;
+    auto normal = VA::Vector(0.0, 0.0, 0.0);
+    for (auto k = 1u; k + 1u < n; ++k) {
+      VA::iadd(normal, VA::cross(VA::sub(poly[face[k]].position, p0), VA::sub(poly[face[k + 1u]].position, p0)));
+    }
+    if (n == 3u or VA::magnitude(normal) == 0.0) {
+      for (auto k = 1u; k + 1u < n; ++k) {
+        tris.push_back(face[0]);
+        tris.push_back(face[k]);
+        tris.push_back(face[k + 1u]);
+      }
+      continue;
+    }
+    normal = VA::unitVector(normal);
+    const auto ax = std::abs(VA::x(normal)), ay = std::abs(VA::y(normal)), az = std::abs(VA::z(normal));
+    const auto axis = (ax <= ay and ax <= az ? VA::Vector(1.0, 0.0, 0.0) :
+                       ay <= az              ? VA::Vector(0.0, 1.0, 0.0) :
+                                               VA::Vector(0.0, 0.0, 1.0));
+    const auto uhat = VA::unitVector(VA::cross(normal, axis));
+    const auto vhat = VA::cross(normal, uhat);
+    xy.resize(2u*n);
+    for (auto k = 0u; k < n; ++k) {
+      const auto dp = VA::sub(poly[face[k]].position, p0);
+      xy[2u*k]      = VA::dot(dp, uhat);
+      xy[2u*k + 1u] = VA::dot(dp, vhat);
+    }
+    local.clear();
+    earClipLoop(local, xy);
+    for (const auto k: local) tris.push_back(face[k]);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Count the vertices of a polyhedron lying in a plane (other than i0 and i1),
+// returning the number of vertices if the plane doesn't actually split them.
+//------------------------------------------------------------------------------
+template<typename VA>
+inline
+unsigned
+planeContacts(const std::vector<Vertex3d<VA>>& poly,
+              const Plane<VA>& plane,
+              const int i0,
+              const int i1,
+              const double lentol) {
+  const auto n = poly.size();
+  auto ncontacts = 0u, nabove = 0u, nbelow = 0u;
+  for (auto i = 0u; i < n; ++i) {
+    const auto d = plane.dist + VA::dot(plane.normal, poly[i].position);
+    if (d > lentol) {
+      ++nabove;
+    } else if (d < -lentol) {
+      ++nbelow;
+    } else if (int(i) != i0 and int(i) != i1) {
+      ++ncontacts;
+    }
+  }
+  return (nabove > 0u and nbelow > 0u ? ncontacts : unsigned(n));
+}
+
+//------------------------------------------------------------------------------
+// Find planes through the reflex edges of a polyhedron, restricted to the
+// vertices with the given component label.  A reflex edge is one where the
+// faces on either side fold outward (n_f x n_g runs against the edge).  Cutting
+// through the edge with a plane passing through the exterior wedge leaves a
+// convex edge in both halves and doesn't contain either face (so no zero
+// thickness sheets are left behind).  Returns whether any reflex edge exists.
+//------------------------------------------------------------------------------
+template<typename VA>
+inline
+bool
+reflexEdgeCuts(std::vector<Plane<VA>>& candidates,
+               const std::vector<Vertex3d<VA>>& poly,
+               const std::vector<std::vector<int>>& faces,
+               const std::vector<int>& component,
+               const int comp,
+               const double lentol) {
+  const auto nfaces = faces.size();
+  std::vector<typename VA::VECTOR> normals(nfaces);
+  std::map<std::pair<int, int>, int> edgeFaces;
+  for (auto f = 0u; f < nfaces; ++f) {
+    const auto nf = faces[f].size();
+    normals[f] = VA::Vector(0.0, 0.0, 0.0);
+    for (auto k = 0u; k < nf; ++k) {
+      VA::iadd(normals[f], VA::cross(poly[faces[f][k]].position, poly[faces[f][(k + 1u) % nf]].position));
+      edgeFaces[std::make_pair(faces[f][k], faces[f][(k + 1u) % nf])] = f;
+    }
+    if (VA::magnitude(normals[f]) > 0.0) normals[f] = VA::unitVector(normals[f]);
+  }
+
+  auto reflex = false;
+  for (auto f = 0u; f < nfaces; ++f) {
+    const auto& face = faces[f];
+    const auto nf = face.size();
+    if (component[face[0]] != comp or VA::magnitude(normals[f]) == 0.0) continue;
+    for (auto k = 0u; k < nf; ++k) {
+      const auto itr = edgeFaces.find(std::make_pair(face[(k + 1u) % nf], face[k]));
+      if (itr == edgeFaces.end()) continue;
+      const auto g = itr->second;
+      const auto& a = poly[face[k]].position;
+      const auto edge = VA::sub(poly[face[(k + 1u) % nf]].position, a);
+      if (VA::magnitude(edge) > lentol and
+          VA::dot(VA::cross(normals[f], normals[g]), VA::unitVector(edge)) < -1.0e-10) {
+        reflex = true;
+
+        // Any plane through the edge and the exterior wedge will do, so try a
+        // few and keep those that split the vertices without touching any
+        // others: clipPolyhedron can leave degenerate bridges between the
+        // pieces when a non-convex polyhedron has vertices lying in the plane.
+        const double weights[5] = {1.0, 0.5, 2.0, 0.25, 4.0};
+        for (auto iw = 0; iw < 5; ++iw) {
+          const auto trial = Plane<VA>(a, VA::unitVector(VA::sub(normals[f], VA::mul(normals[g], weights[iw]))));
+          if (planeContacts(poly, trial, face[k], face[(k + 1u) % nf], lentol) == 0u) candidates.push_back(trial);
+        }
+      }
+    }
+  }
+  return reflex;
+}
+
+//------------------------------------------------------------------------------
+// Split a polyhedron in two with a plane, accepting the result only if
+// clipPolyhedron handled it cleanly: both halves well connected with positive
+// volumes summing to ours.
+//------------------------------------------------------------------------------
+template<typename VA>
+inline
+bool
+cleanSplit(std::vector<Vertex3d<VA>>& above,
+           std::vector<Vertex3d<VA>>& below,
+           const std::vector<Vertex3d<VA>>& poly,
+           const Plane<VA>& plane,
+           const double lentol,
+           const double voltol) {
+  auto clean = [](const std::vector<Vertex3d<VA>>& piece) {
+    const auto np = piece.size();
+    for (auto i = 0u; i < np; ++i) {
+      if (piece[i].neighbors.size() < 3u) return false;
+      for (const auto j: piece[i].neighbors) {
+        if (j < 0 or j >= int(np) or
+            std::find(piece[j].neighbors.begin(), piece[j].neighbors.end(), int(i)) == piece[j].neighbors.end()) return false;
+      }
+    }
+    return true;
+  };
+  above = poly;
+  below = poly;
+  try {
+    clipPolyhedron(above, std::vector<Plane<VA>>(1, plane));
+    clipPolyhedron(below, std::vector<Plane<VA>>(1, Plane<VA>(-plane.dist, VA::neg(plane.normal))));
+    collapseDegenerates(above, lentol);
+    collapseDegenerates(below, lentol);
+  } catch (PolyClipperError&) {
+    return false;
+  }
+  if (not (clean(above) and clean(below))) return false;
+  double V0, Va, Vb;
+  typename VA::VECTOR C0, Ca, Cb;
+  moments(V0, C0, poly);
+  moments(Va, Ca, above);
+  moments(Vb, Cb, below);
+  return (Va > voltol and Vb > voltol and std::abs(Va + Vb - V0) <= 1.0e-10*V0);
+}
+
+//------------------------------------------------------------------------------
+// Recursive worker for the general splitIntoTetrahedra.  Each connected
+// component of the polyhedron is fanned from the first of its vertices which
+// sees every face triangle (a star point).  If some component has no star
+// vertex we cut the polyhedron through a reflex edge, which leaves that edge
+// convex in both halves, and recurse on the halves.
+//------------------------------------------------------------------------------
+template<typename VA>
+inline
+void
+splitIntoTetrahedraImpl(std::vector<typename VA::VECTOR>& points,
+                        std::vector<int>& tets,
+                        std::map<std::vector<double>, int>& pointIDs,
+                        const std::vector<Vertex3d<VA>>& poly,
+                        const double tol,
+                        const int depth) {
+  const auto n = poly.size();
+  if (n < 4) return;
+
+  // Tolerances from the size of the polyhedron.
+  auto xmin = poly[0].position, xmax = poly[0].position;
+  for (const auto& v: poly) {
+    xmin = VA::Vector(std::min(VA::x(xmin), VA::x(v.position)), std::min(VA::y(xmin), VA::y(v.position)), std::min(VA::z(xmin), VA::z(v.position)));
+    xmax = VA::Vector(std::max(VA::x(xmax), VA::x(v.position)), std::max(VA::y(xmax), VA::y(v.position)), std::max(VA::z(xmax), VA::z(v.position)));
+  }
+  const auto length = VA::magnitude(VA::sub(xmax, xmin));
+  const auto voltol = 1.0e-12*length*length*length;
+  const auto lentol = 1.0e-10*length;
+
+  // Triangulate the faces.
+  const auto faces = extractFaces(poly);
+  std::vector<int> tris;
+  triangulatePolyhedronFaces(tris, poly, faces);
+  const auto ntris = tris.size()/3u;
+
+  // Label the connected components.  Zero length edges don't count, since
+  // clipping a non-convex polyhedron can leave separate lumps joined that way.
+  std::vector<int> component(n, -1);
+  auto ncomps = 0;
+  for (auto i = 0u; i < n; ++i) {
+    if (component[i] == -1) {
+      std::vector<int> stack(1, i);
+      component[i] = ncomps;
+      while (not stack.empty()) {
+        const auto j = stack.back();
+        stack.pop_back();
+        for (const auto k: poly[j].neighbors) {
+          if (component[k] == -1 and
+              VA::magnitude(VA::sub(poly[k].position, poly[j].position)) > lentol) {
+            component[k] = ncomps;
+            stack.push_back(k);
+          }
+        }
+      }
+      ++ncomps;
+    }
+  }
+
+  // Look for a star vertex in each component.
+  auto tetVolume = [&](const int a, const int b, const int c, const int d) {
+    const auto& pa = poly[a].position;
+    return VA::dot(VA::sub(poly[b].position, pa), VA::cross(VA::sub(poly[c].position, pa), VA::sub(poly[d].position, pa)))/6.0;
+  };
+  // Map our vertices to the output points as we add tetrahedra.
+  std::vector<int> localTets;
+  auto emit = [&]() {
+    std::vector<int> ids(n, -1);
+    for (const auto k: localTets) {
+      if (ids[k] == -1) {
+        const auto& p = poly[k].position;
+        const std::vector<double> key = {VA::x(p), VA::y(p), VA::z(p)};
+        const auto itr = pointIDs.find(key);
+        if (itr == pointIDs.end()) {
+          ids[k] = points.size();
+          pointIDs[key] = ids[k];
+          points.push_back(p);
+        } else {
+          ids[k] = itr->second;
+        }
+      }
+      tets.push_back(ids[k]);
+    }
+  };
+  auto failed = -1;
+  for (auto icomp = 0; icomp < ncomps and failed == -1; ++icomp) {
+    auto found = false;
+    for (auto a = 0u; a < n and not found; ++a) {
+      if (component[a] != icomp) continue;
+      found = true;
+      for (auto k = 0u; k < ntris and found; ++k) {
+        if (component[tris[3u*k]] == icomp) found = (tetVolume(a, tris[3u*k], tris[3u*k + 1u], tris[3u*k + 2u]) >= -voltol);
+      }
+      if (found) {
+        for (auto k = 0u; k < ntris; ++k) {
+          if (component[tris[3u*k]] == icomp and
+              tetVolume(a, tris[3u*k], tris[3u*k + 1u], tris[3u*k + 2u]) > tol) {
+            localTets.push_back(a);
+            localTets.insert(localTets.end(), tris.begin() + 3u*k, tris.begin() + 3u*k + 3u);
+          }
+        }
+      }
+    }
+    if (not found) failed = icomp;
+  }
+
+  // If every component worked we're done.
+  if (failed == -1) {
+    emit();
+    return;
+  }
+
+  // Find the planes through reflex edges of the failed component which we might
+  // cut along.
+  std::vector<Plane<VA>> candidates;
+  const auto reflex = reflexEdgeCuts(candidates, poly, faces, component, failed, lentol);
+
+  // With no reflex edges the component must be convex lumps joined through
+  // degenerate (zero thickness) bridges, so halve it across its longest extent.
+  if (not reflex) {
+    auto cmin = xmax, cmax = xmin;
+    for (auto i = 0u; i < n; ++i) {
+      if (component[i] == failed) {
+        const auto& p = poly[i].position;
+        cmin = VA::Vector(std::min(VA::x(cmin), VA::x(p)), std::min(VA::y(cmin), VA::y(p)), std::min(VA::z(cmin), VA::z(p)));
+        cmax = VA::Vector(std::max(VA::x(cmax), VA::x(p)), std::max(VA::y(cmax), VA::y(p)), std::max(VA::z(cmax), VA::z(p)));
+      }
+    }
+    const auto extent = VA::sub(cmax, cmin);
+    const auto axis = (VA::x(extent) >= VA::y(extent) and VA::x(extent) >= VA::z(extent) ? VA::Vector(1.0, 0.0, 0.0) :
+                       VA::y(extent) >= VA::z(extent)                                    ? VA::Vector(0.0, 1.0, 0.0) :
+                                                                                          VA::Vector(0.0, 0.0, 1.0));
+    const auto trial = Plane<VA>(VA::mul(VA::add(cmin, cmax), 0.5), axis);
+    if (planeContacts(poly, trial, -1, -1, lentol) == 0u) candidates.push_back(trial);
+  }
+
+  // Take the first cut that clipPolyhedron handles cleanly and recurse on the
+  // halves.
+  if (depth < 100) {
+    std::vector<Vertex3d<VA>> above, below;
+    for (const auto& plane: candidates) {
+      if (cleanSplit(above, below, poly, plane, lentol, voltol)) {
+        splitIntoTetrahedraImpl(points, tets, pointIDs, above, tol, depth + 1);
+        splitIntoTetrahedraImpl(points, tets, pointIDs, below, tol, depth + 1);
+        return;
+      }
+    }
+  }
+
+  // Nothing worked, so fall back to the signed fan from the first vertex.  This
+  // still conserves volume, but some tetrahedra may be inverted.
+  localTets.clear();
+  for (auto k = 0u; k < ntris; ++k) {
+    if (std::abs(tetVolume(0, tris[3u*k], tris[3u*k + 1u], tris[3u*k + 2u])) > tol) {
+      localTets.push_back(0);
+      localTets.insert(localTets.end(), tris.begin() + 3u*k, tris.begin() + 3u*k + 3u);
+    }
+  }
+  emit();
+}
+
+}
+
 //------------------------------------------------------------------------------
 // Split a polyhedron into a set of tetrahedra.
 //------------------------------------------------------------------------------
@@ -741,59 +2551,754 @@ vector<vector<int>> splitIntoTetrahedra(const std::vector<Vertex3d<VA>>& poly,
 
   // Prepare the result, which will be quadruples of indices in the input polyhedron vertices.
   vector<vector<int>> result;
-
-  // Check if we're convex.
   const auto n0 = poly.size();
-  bool convex = true;
-  auto i = 0;
-  while (convex and i < n0) {
-    const auto nv = poly[i].neighbors.size();
-    PCASSERT(nv >= 3);
-    auto j = 0;
-    while (convex and j < nv - 2) {
-      const auto& v0 = poly[i].position;
-      const auto& v1 = poly[poly[i].neighbors[j  ]].position;
-      const auto& v2 = poly[poly[i].neighbors[j+1]].position;
-      const auto& v3 = poly[poly[i].neighbors[j+2]].position;
-      convex = VA::dot(VA::sub(v1, v0), VA::cross(VA::sub(v2, v0), VA::sub(v3, v0))) <= 1.0e-10;  // Note we have to flip signs cause of neighbor ordering
-      // convex = ((v1 - v0).dot((v2 - v0).cross(v3 - v0)) <= 1.0e-10);
-      ++j;
-    }
-    ++i;
-  }
-
-  // If the polyhedron is convex we can just make a fan of tetrahedra from the first point.
-  if (convex) {
-
-    // Get the faces.
-    const auto faces = extractFaces(poly);
-
-    // Create tetrahedra from each face back to the starting point, except for faces which contain
-    // the starting point since those would be zero volume.
-    double vol;
-    const auto& v0 = poly[0].position;
-    for (const auto& face: faces) {
-      // cout << " --> [";
-      // copy(face.begin(), face.end(), ostream_iterator<int>(cout, " "));
-      // cout << "]" << endl;
-      if (find(face.begin(), face.end(), 0) == face.end()) {
-        const auto nf = face.size();
-        PCASSERT(nf >= 3);
-        for (auto i = 2; i < nf; ++i) {
-          const auto& v1 = poly[face[0  ]].position;
-          const auto& v2 = poly[face[i-1]].position;
-          const auto& v3 = poly[face[i  ]].position;
-          vol = VA::dot(VA::sub(v1, v0), VA::cross(VA::sub(v2, v0), VA::sub(v3, v0)))/3.0;
-          // vol = (v1 - v0).dot((v2 - v0).cross(v3 - v0))/3.0;
-          if (vol > tol) result.push_back({0, face[0], face[i-1], face[i]});
+  if (n0 < 4) return result;
+
+  // Fan the faces back to the first point, except for faces which contain the
+  // starting point since those would be zero volume.  The signed tetrahedra
+  // always sum to the volume, so if none of them is inverted (the first point
+  // sees every face, as in any convex polyhedron) the fan is the answer.
+  auto xmin = poly[0].position, xmax = poly[0].position;
+  for (const auto& v: poly) {
+    xmin = VA::Vector(std::min(VA::x(xmin), VA::x(v.position)), std::min(VA::y(xmin), VA::y(v.position)), std::min(VA::z(xmin), VA::z(v.position)));
+    xmax = VA::Vector(std::max(VA::x(xmax), VA::x(v.position)), std::max(VA::y(xmax), VA::y(v.position)), std::max(VA::z(xmax), VA::z(v.position)));
+  }
+  const auto length = VA::magnitude(VA::sub(xmax, xmin));
+  const auto voltol = 1.0e-12*length*length*length;
+  const auto faces = extractFaces(poly);
+  double vol;
+  const auto& v0 = poly[0].position;
+  auto star = true;
+  for (const auto& face: faces) {
+    if (find(face.begin(), face.end(), 0) == face.end()) {
+      const auto nf = face.size();
+      PCASSERT(nf >= 3);
+      for (auto i = 2; i < nf; ++i) {
+        const auto& v1 = poly[face[0  ]].position;
+        const auto& v2 = poly[face[i-1]].position;
+        const auto& v3 = poly[face[i  ]].position;
+        vol = VA::dot(VA::sub(v1, v0), VA::cross(VA::sub(v2, v0), VA::sub(v3, v0)))/3.0;
+        // vol = (v1 - v0).dot((v2 - v0).cross(v3 - v0))/3.0;
+        star = star and vol >= -voltol;
+        if (vol > tol) result.push_back({0, face[0], face[i-1], face[i]});
+      }
+    }
+  }
+  if (star) return result;
+
+  // Otherwise use the general decomposition, which we can only return here if
+  // it found star vertices without adding points.
+  result.clear();
+  vector<typename VA::VECTOR> points;
+  vector<int> tets;
+  splitIntoTetrahedra(points, tets, poly, tol);
+  if (points.size() != n0) throw PolyClipperError("PolyClipper::splitIntoTetrahedra ERROR: non-convex polyhedron requires additional points, use the flat splitIntoTetrahedra:\n" + polyhedron2string(poly));
+  const auto ntets = tets.size()/4u;
+  for (auto k = 0u; k < ntets; ++k) result.push_back({tets[4u*k], tets[4u*k + 1u], tets[4u*k + 2u], tets[4u*k + 3u]});
+  return result;
+}
+
+//------------------------------------------------------------------------------
+// Split a general (possibly non-convex) polyhedron into tetrahedra.
+//------------------------------------------------------------------------------
+template<typename VA>
+void splitIntoTetrahedra(std::vector<typename VA::VECTOR>& points,
+                         std::vector<int>& tets,
+                         const std::vector<Vertex3d<VA>>& poly,
+                         const double tol) {
+  points.clear();
+  tets.clear();
+  std::map<std::vector<double>, int> pointIDs;
+  for (const auto& v: poly) {
+    pointIDs.insert(std::make_pair(std::vector<double>({VA::x(v.position), VA::y(v.position), VA::z(v.position)}), int(points.size())));
+    points.push_back(v.position);
+  }
+  internal::splitIntoTetrahedraImpl(points, tets, pointIDs, poly, tol, 0);
+}
+
+//------------------------------------------------------------------------------
+// Find the plane (with the given normal) which retains the requested fraction
+// of the polyhedron volume.  This is just the inverse of the piecewise cubic
+// volume response, so no clipping is required.
+//------------------------------------------------------------------------------
+template<typename VA>
+double
+findPlaneForVolumeFraction(const std::vector<Vertex3d<VA>>& poly,
+                           const typename VA::VECTOR& normal,
+                           const double fraction) {
+  const auto response = volumeResponse(poly, normal);
+  return response.inverse(fraction*response.totalVolume());
+}
+
+//------------------------------------------------------------------------------
+// Clip a polyhedron by planes and return the moments of the result, along
+// with the derivatives of those moments with respect to each plane's distance
+// and normal.
+//
+// Moving plane k changes the volume by the integrals over the cut face F_k:
+//   dV/dd_k = |F_k|,   dV/dn_k = int_F_k x dA,
+// and the centroid C by
+//   dC/dd_k   = int_F_k (x - C) dA / V,
+//   dC_i/dn_j = int_F_k (x - C)_i x_j dA / V.
+// We clip once (labeling the planes by index so the cut faces can be found
+// from the vertex clips), and reuse a single face extraction for both the
+// moments and the face integrals.
+//------------------------------------------------------------------------------
+template<typename VA>
+void clippedMomentsWithGradient(double& zerothMoment,
+                                typename VA::VECTOR& firstMoment,
+                                std::vector<double>& dzeroth_ddist,
+                                std::vector<typename VA::VECTOR>& dzeroth_dnormal,
+                                std::vector<typename VA::VECTOR>& dfirst_ddist,
+                                std::vector<double>& dfirst_dnormal,
+                                const std::vector<Vertex3d<VA>>& poly,
+                                const std::vector<Plane<VA>>& planes) {
+
+  // Prepare the results.
+  const auto nplanes = planes.size();
+  zerothMoment = 0.0;
+  firstMoment = VA::Vector(0.0, 0.0, 0.0);
+  dzeroth_ddist.assign(nplanes, 0.0);
+  dzeroth_dnormal.assign(nplanes, VA::Vector(0.0, 0.0, 0.0));
+  dfirst_ddist.assign(nplanes, VA::Vector(0.0, 0.0, 0.0));
+  dfirst_dnormal.assign(9u*nplanes, 0.0);
+
+  // Clip a copy of the polyhedron, with the planes labeled by their index.
+  std::vector<Vertex3d<VA>> clipped(poly);
+  for (auto& v: clipped) v.clips.clear();
+  std::vector<Plane<VA>> indexedPlanes(planes);
+  for (auto k = 0u; k < nplanes; ++k) indexedPlanes[k].ID = k;
+  clipPolyhedron(clipped, indexedPlanes);
+  if (clipped.size() < 4u) return;
+
+  // Moments, as in moments().
+  const auto faces = extractFaces(clipped);
+  const auto origin = clipped[0].position;
+  for (const auto& face: faces) {
+    const auto n = face.size();
+    const auto p0 = VA::sub(clipped[face[0]].position, origin);
+    for (auto k = 1u; k < n - 1u; ++k) {
+      const auto p1 = VA::sub(clipped[face[k]].position, origin);
+      const auto p2 = VA::sub(clipped[face[k + 1u]].position, origin);
+      const auto dV = VA::dot(p0, VA::cross(p1, p2));
+      zerothMoment += dV;
+      VA::iadd(firstMoment, VA::mul(VA::add(p0, VA::add(p1, p2)), dV));
+    }
+  }
+  zerothMoment /= 6.0;
+  VA::imul(firstMoment, internal::safeInv(24.0*zerothMoment));
+  VA::iadd(firstMoment, origin);
+  if (zerothMoment <= 0.0) return;
+
+  // Integrate over the faces lying in the clipping planes.
+  const auto Vinv = 1.0/zerothMoment;
+  const double C[3] = {VA::x(firstMoment), VA::y(firstMoment), VA::z(firstMoment)};
+  const auto faceClips = commonFaceClips(clipped, faces);
+  const auto nfaces = faces.size();
+  for (auto f = 0u; f < nfaces; ++f) {
+    if (not faceClips[f].empty()) {
+      const auto k = *faceClips[f].begin();
+      const auto& face = faces[f];
+      const auto n = face.size();
+      const auto outward = VA::neg(planes[k].normal);
+      double A = 0.0, F[3] = {0.0, 0.0, 0.0}, S[9] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+      const auto p0 = VA::sub(clipped[face[0]].position, firstMoment);
+      for (auto m = 1u; m < n - 1u; ++m) {
+        const auto p1 = VA::sub(clipped[face[m]].position, firstMoment);
+        const auto p2 = VA::sub(clipped[face[m + 1u]].position, firstMoment);
+        const auto dA = 0.5*VA::dot(VA::cross(VA::sub(p1, p0), VA::sub(p2, p0)), outward);
+        const double a[3] = {VA::x(p0), VA::y(p0), VA::z(p0)};
+        const double b[3] = {VA::x(p1), VA::y(p1), VA::z(p1)};
+        const double c[3] = {VA::x(p2), VA::y(p2), VA::z(p2)};
+        A += dA;
+        for (auto i = 0u; i < 3u; ++i) {
+          const auto si = a[i] + b[i] + c[i];
+          F[i] += dA*si/3.0;                                          // int (x - C) dA
+          for (auto j = 0u; j < 3u; ++j) {
+            const auto sj = a[j] + b[j] + c[j];
+            S[3u*i + j] += dA/12.0*(a[i]*a[j] + b[i]*b[j] + c[i]*c[j] + si*sj);  // int (x - C)_i (x - C)_j dA
+          }
         }
       }
+      dzeroth_ddist[k] += A;
+      VA::iadd(dzeroth_dnormal[k], VA::Vector(F[0] + A*C[0], F[1] + A*C[1], F[2] + A*C[2]));
+      VA::iadd(dfirst_ddist[k], VA::Vector(F[0]*Vinv, F[1]*Vinv, F[2]*Vinv));
+      for (auto i = 0u; i < 3u; ++i) {
+        for (auto j = 0u; j < 3u; ++j) {
+          dfirst_dnormal[9u*k + 3u*i + j] += (S[3u*i + j] + F[i]*C[j])*Vinv;
+        }
+      }
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Split a polyhedron by a plane.
+// The two sides are clipped with the plane and its reverse, which produces
+// bit-identical cut vertices on both pieces.
+//------------------------------------------------------------------------------
+template<typename VA>
+void splitPolyhedron(std::vector<Vertex3d<VA>>& poly,
+                     std::vector<Vertex3d<VA>>& below,
+                     const Plane<VA>& plane) {
+  below = poly;
+  clipPolyhedron(poly, vector<Plane<VA>>(1, plane));
+  clipPolyhedron(below, vector<Plane<VA>>(1, Plane<VA>(-plane.dist, VA::neg(plane.normal), plane.ID)));
+}
+
+//------------------------------------------------------------------------------
+// Onion-skin (nested dissection) reconstruction of a multi-material polyhedron.
+// Each interface plane is found analytically with findPlaneForVolumeFraction,
+// and the plane for material m is labeled with ID m.
+//------------------------------------------------------------------------------
+template<typename VA>
+void nestedDissection(std::vector<std::vector<Vertex3d<VA>>>& materialPolys,
+                      const std::vector<Vertex3d<VA>>& poly,
+                      const std::vector<int>& order,
+                      const std::vector<typename VA::VECTOR>& normals,
+                      const std::vector<double>& fractions) {
+
+  // Pre-conditions.
+  const auto nmat = normals.size();
+  PCASSERT(fractions.size() == nmat);
+  PCASSERT(order.size() <= nmat);
+  materialPolys.resize(nmat);
+  for (auto& p: materialPolys) p.clear();
+  if (order.empty()) return;
+
+  // The last material in the order holds the remainder as we peel.
+  double V0;
+  typename VA::VECTOR C0;
+  moments(V0, C0, poly);
+  auto& remainder = materialPolys[order.back()];
+  remainder = poly;
+  auto Vr = V0;
+  for (auto k = 0u; k + 1u < order.size() and not remainder.empty(); ++k) {
+    const auto m = order[k];
+    PCASSERT(m >= 0 and m < int(nmat));
+    if (fractions[m] > 0.0) {
+      const auto frac = fractions[m]*V0/std::max(Vr, std::numeric_limits<double>::min());
+      if (frac >= 1.0) {
+        materialPolys[m].swap(remainder);
+        remainder.clear();
+      } else {
+        const auto dist = findPlaneForVolumeFraction(remainder, normals[m], frac);
+        splitPolyhedron(remainder, materialPolys[m], Plane<VA>(-dist, VA::neg(normals[m]), m));
+      }
+      Vr -= fractions[m]*V0;
     }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Moments only version of nestedDissection.
+// We reuse a single workspace for the peeled pieces.
+//------------------------------------------------------------------------------
+template<typename VA>
+void nestedDissectionMoments(std::vector<double>& zerothMoments,
+                             std::vector<typename VA::VECTOR>& firstMoments,
+                             const std::vector<Vertex3d<VA>>& poly,
+                             const std::vector<int>& order,
+                             const std::vector<typename VA::VECTOR>& normals,
+                             const std::vector<double>& fractions) {
+
+  // Pre-conditions.
+  const auto nmat = normals.size();
+  PCASSERT(fractions.size() == nmat);
+  PCASSERT(order.size() <= nmat);
+  zerothMoments.assign(nmat, 0.0);
+  firstMoments.assign(nmat, VA::Vector(0.0, 0.0, 0.0));
+  if (order.empty()) return;
+
+  double V0;
+  typename VA::VECTOR C0;
+  moments(V0, C0, poly);
+  std::vector<Vertex3d<VA>> remainder(poly), piece;
+  auto Vr = V0;
+  for (auto k = 0u; k + 1u < order.size() and not remainder.empty(); ++k) {
+    const auto m = order[k];
+    PCASSERT(m >= 0 and m < int(nmat));
+    if (fractions[m] > 0.0) {
+      const auto frac = fractions[m]*V0/std::max(Vr, std::numeric_limits<double>::min());
+      if (frac >= 1.0) {
+        moments(zerothMoments[m], firstMoments[m], remainder);
+        remainder.clear();
+      } else {
+        const auto dist = findPlaneForVolumeFraction(remainder, normals[m], frac);
+        splitPolyhedron(remainder, piece, Plane<VA>(-dist, VA::neg(normals[m]), m));
+        moments(zerothMoments[m], firstMoments[m], piece);
+      }
+      Vr -= fractions[m]*V0;
+    }
+  }
+  moments(zerothMoments[order.back()], firstMoments[order.back()], remainder);
+}
+
+//------------------------------------------------------------------------------
+// Subtract a convex region.  We peel each outside piece off the remainder with
+// splitPolyhedron, so the pieces share bit-identical cut vertices, and stop as soon
+// as the remainder (the part inside the region so far) is empty.
+//------------------------------------------------------------------------------
+template<typename VA>
+void subtractConvex(std::vector<std::vector<Vertex3d<VA>>>& pieces,
+                    const std::vector<Vertex3d<VA>>& poly,
+                    const std::vector<Plane<VA>>& planes) {
+  const auto nplanes = planes.size();
+  pieces.resize(nplanes);
+  for (auto& p: pieces) p.clear();
+  std::vector<Vertex3d<VA>> remainder(poly);
+  for (auto k = 0u; k < nplanes and not remainder.empty(); ++k) {
+    splitPolyhedron(remainder, pieces[k], planes[k]);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Moments only version of subtractConvex.
+// We reuse a single workspace for the peeled pieces.
+//------------------------------------------------------------------------------
+template<typename VA>
+void subtractConvexMoments(std::vector<double>& zerothMoments,
+                           std::vector<typename VA::VECTOR>& firstMoments,
+                           const std::vector<Vertex3d<VA>>& poly,
+                           const std::vector<Plane<VA>>& planes) {
+  const auto nplanes = planes.size();
+  zerothMoments.assign(nplanes, 0.0);
+  firstMoments.assign(nplanes, VA::Vector(0.0, 0.0, 0.0));
+  std::vector<Vertex3d<VA>> remainder(poly), piece;
+  for (auto k = 0u; k < nplanes and not remainder.empty(); ++k) {
+    splitPolyhedron(remainder, piece, planes[k]);
+    moments(zerothMoments[k], firstMoments[k], piece);
+  }
+}
+
+namespace internal {
+
+//------------------------------------------------------------------------------
+// Add a convex part to a decomposition given its points and faces, with the
+// face planes facing the centroid of the points.  Returns false (adding
+// nothing) if some point lies below a face plane, i.e., we weren't convex.
+//------------------------------------------------------------------------------
+template<typename VA>
+inline
+bool
+addConvexPart(ConvexDecomposition<VA>& decomposition,
+              const std::vector<typename VA::VECTOR>& points,
+              const std::vector<std::vector<int>>& faces,
+              const double lentol) {
+  const auto npoints = points.size();
+  if (npoints < 4u) return false;
+  auto centroid = VA::Vector(0.0, 0.0, 0.0);
+  auto xmin = points[0], xmax = points[0];
+  for (const auto& p: points) {
+    VA::iadd(centroid, p);
+    xmin = VA::Vector(std::min(VA::x(xmin), VA::x(p)), std::min(VA::y(xmin), VA::y(p)), std::min(VA::z(xmin), VA::z(p)));
+    xmax = VA::Vector(std::max(VA::x(xmax), VA::x(p)), std::max(VA::y(xmax), VA::y(p)), std::max(VA::z(xmax), VA::z(p)));
+  }
+  VA::idiv(centroid, double(npoints));
+  std::vector<Plane<VA>> planes;
+  for (const auto& face: faces) {
+    const auto nf = face.size();
+    auto normal = VA::Vector(0.0, 0.0, 0.0);
+    auto fcent = VA::Vector(0.0, 0.0, 0.0);
+    for (auto k = 0u; k < nf; ++k) {
+      VA::iadd(normal, VA::cross(points[face[k]], points[face[(k + 1u) % nf]]));
+      VA::iadd(fcent, points[face[k]]);
+    }
+    if (VA::magnitude(normal) == 0.0) continue;
+    VA::idiv(fcent, double(nf));
+    normal = VA::unitVector(normal);
+    if (VA::dot(normal, VA::sub(centroid, fcent)) < 0.0) normal = VA::neg(normal);
+    planes.push_back(Plane<VA>(fcent, normal));
+    for (const auto& p: points) {
+      if (planes.back().dist + VA::dot(normal, p) < -lentol) return false;
+    }
+  }
+  decomposition.parts.push_back(planes);
+  decomposition.xmin.push_back(xmin);
+  decomposition.xmax.push_back(xmax);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Recursive worker for convexDecomposition.  Each connected component with no
+// reflex edges is a convex part; otherwise we cut it through a reflex edge (as
+// in splitIntoTetrahedra) and recurse on the halves.  If no cut works we fall
+// back to the component's tetrahedra.
+//------------------------------------------------------------------------------
+template<typename VA>
+inline
+void
+convexDecompositionImpl(ConvexDecomposition<VA>& decomposition,
+                        const std::vector<Vertex3d<VA>>& poly,
+                        const int depth) {
+  std::vector<std::vector<Vertex3d<VA>>> components;
+  std::vector<double> volumes;
+  std::vector<typename VA::VECTOR> centroids;
+  splitComponents(components, volumes, centroids, poly);
+  const auto ncomps = components.size();
+  std::vector<typename VA::VECTOR> points;
+  std::vector<Vertex3d<VA>> above, below;
+  for (auto icomp = 0u; icomp < ncomps; ++icomp) {
+    const auto& piece = components[icomp];
+    const auto n = piece.size();
+    if (n < 4u) continue;
+
+    // Tolerances from the size of the piece.
+    auto xmin = piece[0].position, xmax = piece[0].position;
+    for (const auto& v: piece) {
+      xmin = VA::Vector(std::min(VA::x(xmin), VA::x(v.position)), std::min(VA::y(xmin), VA::y(v.position)), std::min(VA::z(xmin), VA::z(v.position)));
+      xmax = VA::Vector(std::max(VA::x(xmax), VA::x(v.position)), std::max(VA::y(xmax), VA::y(v.position)), std::max(VA::z(xmax), VA::z(v.position)));
+    }
+    const auto length = VA::magnitude(VA::sub(xmax, xmin));
+    const auto voltol = 1.0e-12*length*length*length;
+    const auto lentol = 1.0e-10*length;
+    if (volumes[icomp] <= voltol) continue;
+
+    // Convex pieces are done.
+    const auto faces = extractFaces(piece);
+    std::vector<Plane<VA>> candidates;
+    const auto reflex = reflexEdgeCuts(candidates, piece, faces, std::vector<int>(n, 0), 0, lentol);
+    points.resize(n);
+    for (auto i = 0u; i < n; ++i) points[i] = piece[i].position;
+    if (not reflex and addConvexPart(decomposition, points, faces, lentol)) continue;
+
+    // Otherwise cut through a reflex edge.
+    auto split = false;
+    if (depth < 100) {
+      for (auto k = 0u; k < candidates.size() and not split; ++k) {
+        if (cleanSplit(above, below, piece, candidates[k], lentol, voltol)) {
+          convexDecompositionImpl(decomposition, above, depth + 1);
+          convexDecompositionImpl(decomposition, below, depth + 1);
+          split = true;
+        }
+      }
+    }
+
+    // Failing that, use the tetrahedra.
+    if (not split) {
+      const std::vector<std::vector<int>> tetFaces = {{0, 1, 2}, {0, 1, 3}, {0, 2, 3}, {1, 2, 3}};
+      std::vector<typename VA::VECTOR> tetPoints(4);
+      std::vector<int> tets;
+      splitIntoTetrahedra(points, tets, piece, voltol);
+      const auto ntets = tets.size()/4u;
+      for (auto k = 0u; k < ntets; ++k) {
+        for (auto j = 0u; j < 4u; ++j) tetPoints[j] = points[tets[4u*k + j]];
+        addConvexPart(decomposition, tetPoints, tetFaces, lentol);
+      }
+    }
+  }
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Break a polyhedron into convex parts by recursively cutting it through its
+// reflex edges.
+//------------------------------------------------------------------------------
+template<typename VA>
+void convexDecomposition(ConvexDecomposition<VA>& decomposition,
+                         const std::vector<Vertex3d<VA>>& poly) {
+  decomposition.parts.clear();
+  decomposition.xmin.clear();
+  decomposition.xmax.clear();
+  internal::convexDecompositionImpl(decomposition, poly, 0);
+}
+
+//------------------------------------------------------------------------------
+// Intersect a polyhedron with a convex decomposition.  Each convex part is an
+// independent clip of the polyhedron, skipped if the bounding boxes miss.
+//------------------------------------------------------------------------------
+template<typename VA>
+void intersect(std::vector<std::vector<Vertex3d<VA>>>& pieces,
+               const std::vector<Vertex3d<VA>>& poly,
+               const ConvexDecomposition<VA>& tool) {
+  pieces.clear();
+  if (poly.empty()) return;
+  auto xmin = poly[0].position, xmax = xmin;
+  for (const auto& v: poly) {
+    xmin = VA::Vector(std::min(VA::x(xmin), VA::x(v.position)), std::min(VA::y(xmin), VA::y(v.position)), std::min(VA::z(xmin), VA::z(v.position)));
+    xmax = VA::Vector(std::max(VA::x(xmax), VA::x(v.position)), std::max(VA::y(xmax), VA::y(v.position)), std::max(VA::z(xmax), VA::z(v.position)));
+  }
+  const auto nparts = tool.size();
+  std::vector<Vertex3d<VA>> piece;
+  for (auto k = 0u; k < nparts; ++k) {
+    if (VA::x(tool.xmin[k]) > VA::x(xmax) or VA::x(tool.xmax[k]) < VA::x(xmin) or
+        VA::y(tool.xmin[k]) > VA::y(xmax) or VA::y(tool.xmax[k]) < VA::y(xmin) or
+        VA::z(tool.xmin[k]) > VA::z(xmax) or VA::z(tool.xmax[k]) < VA::z(xmin)) continue;
+    piece = poly;
+    clipPolyhedron(piece, tool.parts[k]);
+    if (not piece.empty()) pieces.push_back(piece);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Intersect two polyhedra, decomposing the tool first.
+//------------------------------------------------------------------------------
+template<typename VA>
+void intersect(std::vector<std::vector<Vertex3d<VA>>>& pieces,
+               const std::vector<Vertex3d<VA>>& poly,
+               const std::vector<Vertex3d<VA>>& tool) {
+  ConvexDecomposition<VA> decomposition;
+  convexDecomposition(decomposition, tool);
+  intersect(pieces, poly, decomposition);
+}
+
+//------------------------------------------------------------------------------
+// Moments only version of intersect.
+//------------------------------------------------------------------------------
+template<typename VA>
+void intersectMoments(double& zerothMoment,
+                      typename VA::VECTOR& firstMoment,
+                      const std::vector<Vertex3d<VA>>& poly,
+                      const ConvexDecomposition<VA>& tool) {
+  zerothMoment = 0.0;
+  firstMoment = VA::Vector(0.0, 0.0, 0.0);
+  std::vector<std::vector<Vertex3d<VA>>> pieces;
+  intersect(pieces, poly, tool);
+  double volume;
+  typename VA::VECTOR centroid;
+  for (const auto& piece: pieces) {
+    moments(volume, centroid, piece);
+    zerothMoment += volume;
+    VA::iadd(firstMoment, VA::mul(centroid, volume));
+  }
+  if (zerothMoment != 0.0) VA::idiv(firstMoment, zerothMoment);
+}
+
+//------------------------------------------------------------------------------
+// Cache the face planes of a polyhedron.  Each face plane is labeled with the
+// index of the face in extractFaces, and zero area faces are skipped.  The
+// edge directions are kept once per set of parallel edges, since they only
+// serve as (cross product) separating axes.  The polyhedron is convex if every
+// vertex is above every face plane (to roundoff).
+//------------------------------------------------------------------------------
+template<typename VA>
+void facePlanes(FacePlanes<VA>& cell,
+                const std::vector<Vertex3d<VA>>& poly) {
+  cell.dimension = 3;
+  cell.points.clear();
+  cell.faces.clear();
+  cell.planes.clear();
+  cell.areas.clear();
+  cell.edges.clear();
+  cell.volume = 0.0;
+  cell.convex = true;
+  if (poly.empty()) return;
+  cell.xmin = poly[0].position;
+  cell.xmax = poly[0].position;
+  for (const auto& v: poly) {
+    cell.points.push_back(v.position);
+    VA::x(cell.xmin) = min(VA::x(cell.xmin), VA::x(v.position));
+    VA::y(cell.xmin) = min(VA::y(cell.xmin), VA::y(v.position));
+    VA::z(cell.xmin) = min(VA::z(cell.xmin), VA::z(v.position));
+    VA::x(cell.xmax) = max(VA::x(cell.xmax), VA::x(v.position));
+    VA::y(cell.xmax) = max(VA::y(cell.xmax), VA::y(v.position));
+    VA::z(cell.xmax) = max(VA::z(cell.xmax), VA::z(v.position));
+  }
+  cell.faces = extractFaces(poly);
+  const auto& faces = cell.faces;
+  const int nfaces = faces.size();
+  for (auto k = 0; k < nfaces; ++k) {
+    const auto& facet = faces[k];
+    const auto& p0 = poly[facet[0]].position;
+    auto areaVec = VA::Vector(0.0, 0.0, 0.0);
+    for (auto m = 1u; m + 1u < facet.size(); ++m) {
+      VA::iadd(areaVec, VA::cross(VA::sub(poly[facet[m]].position, p0),
+                                  VA::sub(poly[facet[m + 1u]].position, p0)));
+    }
+    const auto area = VA::magnitude(areaVec);
+    if (area == 0.0) continue;
+    cell.planes.push_back(Plane<VA>(p0, VA::div(areaVec, -area), k));
+    cell.areas.push_back(0.5*area);
+  }
+  const int nverts = poly.size();
+  for (auto i = 0; i < nverts; ++i) {
+    for (const auto j: poly[i].neighbors) {
+      if (j <= i) continue;
+      const auto edge = VA::sub(poly[j].position, poly[i].position);
+      const auto len = VA::magnitude(edge);
+      if (len == 0.0) continue;
+      const auto ehat = VA::div(edge, len);
+      if (std::none_of(cell.edges.begin(), cell.edges.end(),
+                       [&](const typename VA::VECTOR& e) { return VA::magnitude(VA::cross(e, ehat)) < 1.0e-10; })) cell.edges.push_back(ehat);
+    }
+  }
+  const auto tol = 1.0e-10*VA::magnitude(VA::sub(cell.xmax, cell.xmin));
+  for (const auto& plane: cell.planes) {
+    for (const auto& p: cell.points) cell.convex = cell.convex and plane.dist + VA::dot(plane.normal, p) >= -tol;
+  }
+  typename VA::VECTOR centroid;
+  moments(cell.volume, centroid, poly);
+}
+
+//------------------------------------------------------------------------------
+// Build the piecewise cubic volume response of a polyhedron for a fixed normal,
+// sweeping the signed tetrahedra of the moments decomposition.
+//------------------------------------------------------------------------------
+template<typename VA>
+VolumeResponse
+volumeResponse(const std::vector<Vertex3d<VA>>& poly,
+               const typename VA::VECTOR& normal) {
+
+  VolumeResponse result;
+  result.degree = 3;
+  if (poly.size() < 4) return result;
+
+  // Heights of the signed tetrahedra relative to the first vertex.
+  vector<double> heights, volumes;
+  internal::tetrahedronHeights(heights, volumes, poly, normal);
+  result.offset = VA::dot(normal, poly[0].position);
+
+  // The sorted unique vertex heights are the breakpoints of the volume function.
+  auto& breaks = result.breaks;
+  breaks.reserve(poly.size());
+  for (const auto& v: poly) breaks.push_back(VA::dot(normal, VA::sub(v.position, poly[0].position)));
+  std::sort(breaks.begin(), breaks.end());
+  breaks.erase(std::unique(breaks.begin(), breaks.end()), breaks.end());
+  const auto n = result.size();
+  if (n == 0u) {
+    breaks.clear();
     return result;
   }
 
-  // PolyClipper::splitIntoTetrahedra ERROR: non-convex polyhedra not supported yet:\n" + polyhedron2string(poly)
-  PCASSERT(false);
+  // Sweep the tetrahedra.
+  internal::sweepVolumeResponse(result, heights, volumes,
+                                [](double* c, const double* h, const int piece, const double h0) {
+                                  internal::tetrahedronFractionAbovePolynomial(c, h[0], h[1], h[2], h[3], piece, h0);
+                                });
+  return result;
+}
+
+//------------------------------------------------------------------------------
+// Compute the flux volumes swept by the faces of a polyhedron, intersected with
+// a set of convex donor cells.
+// Each swept volume is bounded by the displaced face (fanned from its vertex
+// average), and the bilinear side faces swept by its edges (each split into
+// four triangles about its center, so neighboring faces share the same side
+// surface).  Coning these triangles to the vertex average of the original face
+// gives signed tetrahedra, which we clip positively oriented and weight by
+// their sign.  Non-convex (e.g., twisted) swept shapes are therefore handled
+// by cancellation.
+//------------------------------------------------------------------------------
+template<typename VA>
+void fluxVolumes(std::vector<double>& zerothMoments,
+                 std::vector<typename VA::VECTOR>& firstMoments,
+                 const std::vector<Vertex3d<VA>>& poly,
+                 const std::vector<typename VA::VECTOR>& displacements,
+                 const std::vector<std::vector<Plane<VA>>>& donors) {
+  using Vector = typename VA::VECTOR;
+
+  // Pre-conditions.
+  PCASSERT(displacements.size() == poly.size());
+  const auto faces = extractFaces(poly);
+  const auto nfaces = faces.size();
+  const auto ndonors = donors.size();
+  zerothMoments.assign(nfaces*ndonors, 0.0);
+  firstMoments.assign(nfaces*ndonors, VA::Vector(0.0, 0.0, 0.0));
+
+  // Faces are independent, and write disjoint parts of the result.
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+  for (int f = 0; f < int(nfaces); ++f) {
+    const auto& face = faces[f];
+    const auto n = face.size();
+
+    // Find the apex (original face center) and displaced face center.
+    auto apex = VA::Vector(0.0, 0.0, 0.0);
+    auto top = VA::Vector(0.0, 0.0, 0.0);
+    for (const auto i: face) {
+      VA::iadd(apex, poly[i].position);
+      VA::iadd(top, VA::add(poly[i].position, displacements[i]));
+    }
+    VA::idiv(apex, double(n));
+    VA::idiv(top, double(n));
+
+    // The triangles bounding the swept volume (outward oriented), excluding
+    // the original face which has no volume relative to the apex.
+    std::vector<Vector> triangles;
+    for (auto k = 0u; k < n; ++k) {
+      const auto i = face[k], j = face[(k + 1u) % n];
+      const auto& u = poly[i].position;
+      const auto& v = poly[j].position;
+      const auto U = VA::add(u, displacements[i]);
+      const auto V = VA::add(v, displacements[j]);
+      const auto m = VA::mul(VA::add(VA::add(u, v), VA::add(U, V)), 0.25);
+      const Vector tris[15] = {u, v, m,
+                               v, V, m,
+                               V, U, m,
+                               U, u, m,
+                               top, U, V};
+      triangles.insert(triangles.end(), tris, tris + 15);
+    }
+
+    // Clip the signed tetrahedra against each donor.
+    std::vector<Vertex3d<VA>> tet;
+    const auto ntris = triangles.size()/3u;
+    for (auto t = 0u; t < ntris; ++t) {
+      const auto vol = internal::initializeTetrahedron(tet, apex, triangles[3*t], triangles[3*t + 1], triangles[3*t + 2]);
+      if (vol != 0.0) {
+        const auto sgn = (vol > 0.0 ? 1.0 : -1.0);
+        for (auto k = 0u; k < ndonors; ++k) {
+          auto chunk = tet;
+          clipPolyhedron(chunk, donors[k]);
+          if (not chunk.empty()) {
+            double V1;
+            Vector C1;
+            moments(V1, C1, chunk);
+            zerothMoments[f*ndonors + k] += sgn*V1;
+            VA::iadd(firstMoments[f*ndonors + k], VA::mul(C1, sgn*V1));
+          }
+        }
+      }
+    }
+    for (auto k = 0u; k < ndonors; ++k) {
+      VA::imul(firstMoments[f*ndonors + k], internal::safeInv(zerothMoments[f*ndonors + k]));
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+// Integrate a function over a polyhedron.
+//------------------------------------------------------------------------------
+template<typename VA, typename Integrand>
+double integrate(const std::vector<Vertex3d<VA>>& poly,
+                 Integrand&& integrand,
+                 const QuadratureRule& rule,
+                 QuadratureBatch& batch) {
+  batch.clear();
+  internal::appendQuadraturePoints(batch, poly, rule);
+  const auto n = batch.size();
+  batch.offsets.push_back(n);
+  batch.values.resize(n);
+  if (n == 0u) return 0.0;
+  integrand(batch.x, batch.y, batch.z, batch.values);
+  double result = 0.0;
+  for (auto i = 0u; i < n; ++i) result += batch.weights[i]*batch.values[i];
+  return result;
+}
+
+//------------------------------------------------------------------------------
+// Integrate a function over a set of polyhedra, with one integrand call.
+//------------------------------------------------------------------------------
+template<typename VA, typename Integrand>
+void integrate(std::vector<double>& results,
+               const std::vector<std::vector<Vertex3d<VA>>>& polys,
+               Integrand&& integrand,
+               const QuadratureRule& rule,
+               QuadratureBatch& batch) {
+  const auto npolys = polys.size();
+  results.assign(npolys, 0.0);
+  batch.clear();
+  for (const auto& poly: polys) internal::appendQuadraturePoints(batch, poly, rule);
+  const auto n = batch.size();
+  batch.offsets.push_back(n);
+  batch.values.resize(n);
+  if (n == 0u) return;
+  integrand(batch.x, batch.y, batch.z, batch.values);
+  for (auto k = 0u; k < npolys; ++k) {
+    for (auto i = batch.offsets[k]; i < batch.offsets[k + 1u]; ++i) results[k] += batch.weights[i]*batch.values[i];
+  }
 }
 
 }
@@ -0,0 +1,354 @@
+//------------------------------------------------------------------------------
+// FacePlanes
+//
+// The face planes (edges in 2D) of a polygon/polyhedron, cached along with the
+// vertices, faces, face areas, and edge directions, so a cell can be compared
+// against many others (or located against many points) without extracting its
+// faces again.  The planes are a half-space representation of the cell when it
+// is convex.
+//
+// Built by facePlanes in polyclipper2d.hh/polyclipper3d.hh.
+//------------------------------------------------------------------------------
+#ifndef __PolyClipper_FacePlanes__
+#define __PolyClipper_FacePlanes__
+
+#include "polyclipper_utilities.hh"
+#include "polyclipper_plane.hh"
+
+#include <vector>
+#include <array>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+
+namespace PolyClipper {
+
+template<typename VA>
+struct FacePlanes {
+  using Vector = typename VA::VECTOR;
+  int dimension;                     // 2 => polygon, 3 => polyhedron
+  std::vector<Vector> points;        // Vertex positions
+  std::vector<std::vector<int>> faces; // Vertex loops of the faces, as from extractFaces
+  std::vector<Plane<VA>> planes;     // Face planes (normals inward, IDs the extractFaces index)
+  std::vector<double> areas;         // Face areas (edge lengths in 2D)
+  std::vector<Vector> edges;         // Unit edge directions, one per set of parallel edges (3D only)
+  Vector xmin, xmax;                 // Bounding box
+  double volume;                     // Volume (area in 2D)
+  bool convex;                       // Whether every vertex is above every face plane
+  FacePlanes()                       : dimension(0), points(), faces(), planes(), areas(), edges(), xmin(), xmax(), volume(0.0), convex(true) {}
+
+  // Number of faces.
+  size_t size() const                { return planes.size(); }
+
+  // Range of the vertices projected onto an axis.
+  void project(double& smin, double& smax, const Vector& axis) const {
+    smin = std::numeric_limits<double>::max();
+    smax = std::numeric_limits<double>::lowest();
+    for (const auto& p: points) {
+      const auto s = VA::dot(axis, p);
+      smin = std::min(smin, s);
+      smax = std::max(smax, s);
+    }
+  }
+
+  // Area (length in 2D) of the shadow of a convex cell across a unit axis,
+  // which bounds the area of any of its cross-sections normal to the axis.
+  double shadow(const Vector& axis) const {
+    double result = 0.0;
+    const auto n = planes.size();
+    for (auto k = 0u; k < n; ++k) result += areas[k]*std::abs(VA::dot(axis, planes[k].normal));
+    return 0.5*result;
+  }
+};
+
+//------------------------------------------------------------------------------
+// Test two convex polygons/polyhedra for overlap (with non-zero volume) by
+// separating axes: the bounding box axes, the face normals of either cell, and
+// (in 3D) the cross products of their edge directions.  Overlaps thinner than
+// 1e-10 of the cells' extent count as separated.  volumeBound is set to an
+// upper bound on the volume of the intersection (zero if separated).  Along
+// each face normal the intersection lies in a slab as wide as the overlap of
+// the projections, and its cross-sections are no bigger than the shadow of
+// either cell, which with the box overlap and the smaller cell volume gives a
+// cheap bound.
+//------------------------------------------------------------------------------
+template<typename VA>
+inline
+bool
+convexOverlap(double& volumeBound,
+              const FacePlanes<VA>& a,
+              const FacePlanes<VA>& b) {
+  PCASSERT(a.dimension == b.dimension);
+  volumeBound = 0.0;
+  if (a.points.empty() or b.points.empty()) return false;
+  const auto dim = a.dimension;
+  const auto amin = VA::get_triple(a.xmin), amax = VA::get_triple(a.xmax);
+  const auto bmin = VA::get_triple(b.xmin), bmax = VA::get_triple(b.xmax);
+  auto extent = 0.0;
+  for (auto j = 0; j < dim; ++j) extent = std::max(extent, std::max(amax[j] - amin[j], bmax[j] - bmin[j]));
+  const auto tol = 1.0e-10*extent;
+
+  // Bounding boxes.
+  auto bound = std::min(a.volume, b.volume);
+  auto boxVolume = 1.0;
+  for (auto j = 0; j < dim; ++j) {
+    const auto w = std::min(amax[j], bmax[j]) - std::max(amin[j], bmin[j]);
+    if (w <= tol) return false;
+    boxVolume *= w;
+  }
+  bound = std::min(bound, boxVolume);
+
+  // Face normals.
+  double smina, smaxa, sminb, smaxb;
+  for (const auto* cell: {&a, &b}) {
+    for (const auto& plane: cell->planes) {
+      a.project(smina, smaxa, plane.normal);
+      b.project(sminb, smaxb, plane.normal);
+      const auto w = std::min(smaxa, smaxb) - std::max(smina, sminb);
+      if (w <= tol) return false;
+      bound = std::min(bound, w*std::min(a.shadow(plane.normal), b.shadow(plane.normal)));
+    }
+  }
+
+  // Edge cross products (only 3D cells have edges).  We go through triples, as
+  // the 2D vectors have no cross product.
+  auto axis = a.xmin;
+  for (const auto& ea: a.edges) {
+    const auto u = VA::get_triple(ea);
+    for (const auto& eb: b.edges) {
+      const auto v = VA::get_triple(eb);
+      VA::set_triple(axis, {u[1]*v[2] - u[2]*v[1], u[2]*v[0] - u[0]*v[2], u[0]*v[1] - u[1]*v[0]});
+      const auto mag = VA::magnitude(axis);
+      if (mag < 1.0e-10) continue;
+      a.project(smina, smaxa, axis);
+      b.project(sminb, smaxb, axis);
+      if (std::min(smaxa, smaxb) - std::max(smina, sminb) <= tol*mag) return false;
+    }
+  }
+  volumeBound = bound;
+  return true;
+}
+
+namespace internal {
+
+//------------------------------------------------------------------------------
+// Contribution of the directed edge a->b to the winding number of q, in the
+// plane of the coordinates (i0, i1).  Upward edges count +1 with q on their
+// left, downward edges -1 with q on their right.
+//------------------------------------------------------------------------------
+inline
+int
+edgeWinding(const std::array<double, 3>& a,
+            const std::array<double, 3>& b,
+            const std::array<double, 3>& q,
+            const int i0,
+            const int i1) {
+  const auto side = (b[i0] - a[i0])*(q[i1] - a[i1]) - (q[i0] - a[i0])*(b[i1] - a[i1]);
+  if (a[i1] <= q[i1]) return (b[i1] > q[i1] and side > 0.0) ? 1 : 0;
+  return (b[i1] <= q[i1] and side < 0.0) ? -1 : 0;
+}
+
+//------------------------------------------------------------------------------
+// Solid angle of the triangle (a, b, c) seen from q (Van Oosterom & Strackee),
+// positive when the triangle runs counter-clockwise viewed from beyond it.
+//------------------------------------------------------------------------------
+inline
+double
+triangleSolidAngle(const std::array<double, 3>& a,
+                   const std::array<double, 3>& b,
+                   const std::array<double, 3>& c,
+                   const std::array<double, 3>& q) {
+  const double u[3] = {a[0] - q[0], a[1] - q[1], a[2] - q[2]};
+  const double v[3] = {b[0] - q[0], b[1] - q[1], b[2] - q[2]};
+  const double w[3] = {c[0] - q[0], c[1] - q[1], c[2] - q[2]};
+  const auto lu = std::sqrt(u[0]*u[0] + u[1]*u[1] + u[2]*u[2]);
+  const auto lv = std::sqrt(v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
+  const auto lw = std::sqrt(w[0]*w[0] + w[1]*w[1] + w[2]*w[2]);
+  const auto det = (u[0]*(v[1]*w[2] - v[2]*w[1]) +
+                    u[1]*(v[2]*w[0] - v[0]*w[2]) +
+                    u[2]*(v[0]*w[1] - v[1]*w[0]));
+  const auto denom = (lu*lv*lw +
+                      (u[0]*v[0] + u[1]*v[1] + u[2]*v[2])*lw +
+                      (u[0]*w[0] + u[1]*w[1] + u[2]*w[2])*lv +
+                      (v[0]*w[0] + v[1]*w[1] + v[2]*w[2])*lu);
+  return 2.0*std::atan2(det, denom);
+}
+
+//------------------------------------------------------------------------------
+// Check whether a point is inside a (possibly non-convex) cell by its winding
+// number: in 2D from the signed crossings of the edges, and in 3D from the
+// solid angles of the faces (fanned into triangles), which avoids the
+// degenerate cases of casting a ray.
+//------------------------------------------------------------------------------
+template<typename VA>
+inline
+bool
+windingContains(const FacePlanes<VA>& cell,
+                const std::array<double, 3>& q) {
+  if (cell.dimension == 2) {
+    auto winding = 0;
+    for (const auto& face: cell.faces) winding += edgeWinding(VA::get_triple(cell.points[face[0]]), VA::get_triple(cell.points[face[1]]), q, 0, 1);
+    return winding != 0;
+  }
+  auto omega = 0.0;
+  for (const auto& face: cell.faces) {
+    const auto a = VA::get_triple(cell.points[face[0]]);
+    for (auto m = 1u; m + 1u < face.size(); ++m) {
+      omega += triangleSolidAngle(a, VA::get_triple(cell.points[face[m]]), VA::get_triple(cell.points[face[m + 1u]]), q);
+    }
+  }
+  return omega > 2.0*std::acos(-1.0);
+}
+
+//------------------------------------------------------------------------------
+// Distance from a point to the boundary of a cell.  In 2D this is the nearest
+// edge, while in 3D a face is as near as its plane if the point projects inside
+// the face, and otherwise as near as its nearest edge.
+//------------------------------------------------------------------------------
+template<typename VA>
+inline
+double
+boundaryDistance(const FacePlanes<VA>& cell,
+                 const typename VA::VECTOR& q) {
+  auto segment2 = [&](const typename VA::VECTOR& a, const typename VA::VECTOR& b) {
+    const auto ab = VA::sub(b, a);
+    const auto len2 = VA::magnitude2(ab);
+    const auto t = len2 > 0.0 ? std::max(0.0, std::min(1.0, VA::dot(VA::sub(q, a), ab)/len2)) : 0.0;
+    return VA::magnitude2(VA::sub(q, VA::add(a, VA::mul(ab, t))));
+  };
+  auto result2 = std::numeric_limits<double>::max();
+  if (cell.dimension == 2) {
+    for (const auto& face: cell.faces) result2 = std::min(result2, segment2(cell.points[face[0]], cell.points[face[1]]));
+    return std::sqrt(result2);
+  }
+  for (const auto& plane: cell.planes) {
+    const auto& face = cell.faces[plane.ID];
+    const auto h = plane.dist + VA::dot(plane.normal, q);
+    if (h*h >= result2) continue;
+
+    // Check the foot of the point in the plane against the face, dropping the
+    // dominant axis of the normal.
+    const auto foot = VA::get_triple(VA::sub(q, VA::mul(plane.normal, h)));
+    const auto nt = VA::get_triple(plane.normal);
+    const auto k = (std::abs(nt[0]) > std::abs(nt[1]) ?
+                    (std::abs(nt[0]) > std::abs(nt[2]) ? 0 : 2) :
+                    (std::abs(nt[1]) > std::abs(nt[2]) ? 1 : 2));
+    const auto n = face.size();
+    auto winding = 0;
+    for (auto m = 0u; m < n; ++m) winding += edgeWinding(VA::get_triple(cell.points[face[m]]), VA::get_triple(cell.points[face[(m + 1u) % n]]), foot, (k + 1) % 3, (k + 2) % 3);
+    if (winding != 0) {
+      result2 = h*h;
+    } else {
+      for (auto m = 0u; m < n; ++m) result2 = std::min(result2, segment2(cell.points[face[m]], cell.points[face[(m + 1u) % n]]));
+    }
+  }
+  return std::sqrt(result2);
+}
+
+//------------------------------------------------------------------------------
+// The smallest signed distance of each point in a batch above the face planes.
+// We sweep the batch once per plane so the inner loop runs over contiguous
+// coordinates, which vectorizes.
+//------------------------------------------------------------------------------
+template<typename VA>
+inline
+void
+minPlaneDistances(std::vector<double>& result,
+                  const FacePlanes<VA>& cell,
+                  const std::vector<double>& x,
+                  const std::vector<double>& y,
+                  const std::vector<double>& z) {
+  const auto npoints = x.size();
+  PCASSERT(y.size() == npoints);
+  PCASSERT(cell.dimension == 2 or z.size() == npoints);
+  result.assign(npoints, std::numeric_limits<double>::max());
+  double* r = result.data();
+  const double* px = x.data();
+  const double* py = y.data();
+  const double* pz = z.data();
+  for (const auto& plane: cell.planes) {
+    const auto n = VA::get_triple(plane.normal);
+    const auto d = plane.dist;
+    if (cell.dimension == 2) {
+      for (auto i = 0u; i < npoints; ++i) r[i] = std::min(r[i], d + n[0]*px[i] + n[1]*py[i]);
+    } else {
+      for (auto i = 0u; i < npoints; ++i) r[i] = std::min(r[i], d + n[0]*px[i] + n[1]*py[i] + n[2]*pz[i]);
+    }
+  }
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Check whether each of a batch of points (given by coordinate arrays, with z
+// unused in 2D) lies in a cell, setting inside[i] to 1 or 0.  Points of a convex
+// cell need only be above every face plane, while a non-convex cell uses the
+// winding number of each point inside its bounding box.  Points on the
+// boundary of a convex cell count as inside, and may go either way for a
+// non-convex cell.
+//------------------------------------------------------------------------------
+template<typename VA>
+inline
+void
+containsPoints(std::vector<int>& inside,
+               const FacePlanes<VA>& cell,
+               const std::vector<double>& x,
+               const std::vector<double>& y,
+               const std::vector<double>& z) {
+  const auto npoints = x.size();
+  inside.assign(npoints, 0);
+  if (cell.points.empty()) return;
+  if (cell.convex) {
+    std::vector<double> dist;
+    internal::minPlaneDistances(dist, cell, x, y, z);
+    for (auto i = 0u; i < npoints; ++i) inside[i] = (dist[i] >= 0.0 ? 1 : 0);
+    return;
+  }
+  const auto xmin = VA::get_triple(cell.xmin), xmax = VA::get_triple(cell.xmax);
+  std::array<double, 3> q = {0.0, 0.0, 0.0};
+  for (auto i = 0u; i < npoints; ++i) {
+    q[0] = x[i];
+    q[1] = y[i];
+    if (cell.dimension == 3) q[2] = z[i];
+    auto inBox = true;
+    for (auto j = 0; j < cell.dimension; ++j) inBox = inBox and q[j] >= xmin[j] and q[j] <= xmax[j];
+    if (inBox) inside[i] = internal::windingContains(cell, q) ? 1 : 0;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Compute the signed distance of each of a batch of points (given by
+// coordinate arrays, with z unused in 2D) to the boundary of a cell, positive
+// inside (the same sign convention as the planes).  Inside a convex cell this
+// is just the smallest plane distance; otherwise we find the nearest face.
+//------------------------------------------------------------------------------
+template<typename VA>
+inline
+void
+signedDistances(std::vector<double>& distances,
+                const FacePlanes<VA>& cell,
+                const std::vector<double>& x,
+                const std::vector<double>& y,
+                const std::vector<double>& z) {
+  const auto npoints = x.size();
+  if (cell.points.empty()) {
+    distances.assign(npoints, -std::numeric_limits<double>::max());
+    return;
+  }
+  internal::minPlaneDistances(distances, cell, x, y, z);
+  auto q = cell.xmin;
+  std::array<double, 3> qt = {0.0, 0.0, 0.0};
+  for (auto i = 0u; i < npoints; ++i) {
+    if (cell.convex and distances[i] >= 0.0) continue;
+    qt[0] = x[i];
+    qt[1] = y[i];
+    if (cell.dimension == 3) qt[2] = z[i];
+    VA::set_triple(q, qt);
+    const auto d = internal::boundaryDistance(cell, q);
+    distances[i] = (cell.convex or not internal::windingContains(cell, qt)) ? -d : d;
+  }
+}
+
+}
+
+#endif
@@ -5,6 +5,7 @@
 #define __PolyClipper_Plane__
 
 #include <limits>
+#include <vector>
 
 namespace PolyClipper {
 
@@ -27,6 +28,63 @@ struct Plane {
   bool operator> (const Plane& rhs) const                  { return (dist > rhs.dist); }
 };
 
+//------------------------------------------------------------------------------
+// The face (edge in 2D) created by a clipping plane, as it survives on the
+// final clipped polyhedron (polygon).  The loops index vertices of the clipped
+// result; a convex cut yields a single loop, while a non-convex cut may yield
+// several.  In 2D each loop is a single cut edge (pair of vertices).
+//------------------------------------------------------------------------------
+template<typename VA>
+struct CutFace {
+  using Vector = typename VA::VECTOR;
+  std::vector<std::vector<int>> loops; // Vertex loops of the face
+  double area;                         // Face area (length in 2D)
+  Vector centroid;                     // Face centroid
+  CutFace()                                                : loops(), area(0.0), centroid() {}
+};
+
+//------------------------------------------------------------------------------
+// A (possibly non-convex) polygon/polyhedron broken into convex parts, each
+// stored as the set of planes bounding it plus its bounding box.  Build it
+// once with convexDecomposition and reuse it to intersect many targets.
+//------------------------------------------------------------------------------
+template<typename VA>
+struct ConvexDecomposition {
+  using Vector = typename VA::VECTOR;
+  std::vector<std::vector<Plane<VA>>> parts; // Bounding planes of each convex part
+  std::vector<Vector> xmin, xmax;            // Bounding box of each convex part
+  ConvexDecomposition()                                    : parts(), xmin(), xmax() {}
+
+  // Number of convex parts.
+  size_t size() const                                      { return parts.size(); }
+};
+
+//------------------------------------------------------------------------------
+// A conforming mesh assembled from independent cells (polygons/polyhedra), with
+// shared vertices and faces (edges in 2D).  Connectivity is stored in
+// compressed sparse row form: the entries of item i run from offsets[i] to
+// offsets[i + 1].  Each face is oriented outward from its first cell, and the
+// cells list the faces they own as f and those they don't as ~f (= -f - 1).
+//------------------------------------------------------------------------------
+template<typename VA>
+struct ConformingMesh {
+  using Vector = typename VA::VECTOR;
+  std::vector<Vector> points;                  // Unique vertex positions
+  std::vector<int> cellVertexOffsets;          // CSR offsets into cellVertices
+  std::vector<int> cellVertices;               // Vertex IDs of each cell, in the cell's vertex order
+  std::vector<int> cellFaceOffsets;            // CSR offsets into cellFaces
+  std::vector<int> cellFaces;                  // Face IDs of each cell (~f for faces oriented inward)
+  std::vector<int> faceVertexOffsets;          // CSR offsets into faceVertices
+  std::vector<int> faceVertices;               // Vertex loop of each face
+  std::vector<int> faceCells;                  // Pairs of (first, second) cells per face, second = -1 on the boundary
+  ConformingMesh()                                         : points(), cellVertexOffsets(), cellVertices(), cellFaceOffsets(), cellFaces(),
+                                                             faceVertexOffsets(), faceVertices(), faceCells() {}
+
+  // Numbers of cells and faces.
+  size_t numCells() const                                  { return cellVertexOffsets.empty() ? 0u : cellVertexOffsets.size() - 1u; }
+  size_t numFaces() const                                  { return faceCells.size()/2u; }
+};
+
 }
 
 #endif
@@ -0,0 +1,140 @@
+//------------------------------------------------------------------------------
+// Quadrature
+//
+// Quadrature rules on the reference simplex (triangle or tetrahedron), and a
+// reusable batch of physical quadrature points in structure-of-arrays form.
+// The integrate methods in polyclipper2d.hh/polyclipper3d.hh map a rule onto
+// the simplex decomposition of a polygon/polyhedron, fill a batch, and hand the
+// whole batch to a vectorized integrand in one call.
+//
+// Rules of arbitrary degree are built as collapsed (Duffy) products of
+// Gauss-Legendre rules, so all weights are positive.
+//------------------------------------------------------------------------------
+#ifndef __PolyClipper_Quadrature__
+#define __PolyClipper_Quadrature__
+
+#include "polyclipper_utilities.hh"
+
+#include <vector>
+#include <cmath>
+
+namespace PolyClipper {
+
+struct QuadratureRule {
+  int dimension;                     // 2 => triangle, 3 => tetrahedron
+  int degree;                        // Polynomial degree integrated exactly
+  std::vector<double> barycentric;   // (dimension + 1) barycentric coordinates per point
+  std::vector<double> weights;       // Weights per point, summing to one
+  QuadratureRule()                   : dimension(0), degree(0), barycentric(), weights() {}
+
+  // Number of points.
+  size_t size() const                { return weights.size(); }
+};
+
+struct QuadratureBatch {
+  std::vector<double> x, y, z;       // Point coordinates (z unused in 2D)
+  std::vector<double> weights;       // Physical weights (signed volume/area included)
+  std::vector<double> values;        // Integrand values, filled by the integrand
+  std::vector<size_t> offsets;       // Start of each polytope's points (plus the end)
+  QuadratureBatch()                  : x(), y(), z(), weights(), values(), offsets() {}
+
+  // Number of points.
+  size_t size() const                { return weights.size(); }
+
+  // Empty the batch, keeping the allocated storage for reuse.
+  void clear()                       { x.clear(); y.clear(); z.clear(); weights.clear(); values.clear(); offsets.clear(); }
+};
+
+namespace internal {
+
+//------------------------------------------------------------------------------
+// Gauss-Legendre nodes and weights on [0, 1] (Newton iteration on P_n).
+//------------------------------------------------------------------------------
+inline
+void
+gaussLegendre01(std::vector<double>& nodes,
+                std::vector<double>& weights,
+                const int n) {
+  const double pi = std::acos(-1.0);
+  nodes.resize(n);
+  weights.resize(n);
+  for (auto i = 0; i < (n + 1)/2; ++i) {
+    auto x = std::cos(pi*(i + 0.75)/(n + 0.5));
+    double dp = 1.0;
+    for (auto iter = 0; iter < 100; ++iter) {
+      double p0 = 1.0, p1 = 0.0;
+      for (auto j = 1; j <= n; ++j) {
+        const auto p2 = p1;
+        p1 = p0;
+        p0 = ((2.0*j - 1.0)*x*p1 - (j - 1.0)*p2)/j;
+      }
+      dp = n*(x*p0 - p1)/(x*x - 1.0);
+      const auto dx = p0/dp;
+      x -= dx;
+      if (std::abs(dx) < 1.0e-15) break;
+    }
+    const auto w = 1.0/((1.0 - x*x)*dp*dp);
+    nodes[i] = 0.5*(1.0 - x);
+    nodes[n - 1 - i] = 0.5*(1.0 + x);
+    weights[i] = w;
+    weights[n - 1 - i] = w;
+  }
+}
+
+}
+
+//------------------------------------------------------------------------------
+// Build a quadrature rule on the reference triangle (dimension = 2) or
+// tetrahedron (dimension = 3) exact for polynomials of the given degree.
+//------------------------------------------------------------------------------
+inline
+QuadratureRule
+simplexQuadratureRule(const int dimension,
+                      const int degree) {
+  PCASSERT(dimension == 2 or dimension == 3);
+  QuadratureRule result;
+  result.dimension = dimension;
+  result.degree = degree;
+
+  // The centroid handles linear functions.
+  if (degree <= 1) {
+    result.barycentric.assign(dimension + 1, 1.0/(dimension + 1));
+    result.weights.assign(1, 1.0);
+    return result;
+  }
+
+  // Otherwise collapse a tensor product of Gauss rules, where the Jacobian of
+  // the collapse raises the degree in the leading directions.
+  const auto n = (degree + dimension + 1)/2;
+  std::vector<double> u, w;
+  internal::gaussLegendre01(u, w, n);
+  if (dimension == 2) {
+    for (auto i = 0; i < n; ++i) {
+      for (auto j = 0; j < n; ++j) {
+        const auto xi = u[i];
+        const auto eta = u[j]*(1.0 - u[i]);
+        const double b[3] = {1.0 - xi - eta, xi, eta};
+        result.barycentric.insert(result.barycentric.end(), b, b + 3);
+        result.weights.push_back(2.0*w[i]*w[j]*(1.0 - u[i]));
+      }
+    }
+  } else {
+    for (auto i = 0; i < n; ++i) {
+      for (auto j = 0; j < n; ++j) {
+        for (auto k = 0; k < n; ++k) {
+          const auto xi = u[i];
+          const auto eta = u[j]*(1.0 - u[i]);
+          const auto zeta = u[k]*(1.0 - u[i])*(1.0 - u[j]);
+          const double b[4] = {1.0 - xi - eta - zeta, xi, eta, zeta};
+          result.barycentric.insert(result.barycentric.end(), b, b + 4);
+          result.weights.push_back(6.0*w[i]*w[j]*w[k]*(1.0 - u[i])*(1.0 - u[i])*(1.0 - u[j]));
+        }
+      }
+    }
+  }
+  return result;
+}
+
+}
+
+#endif
@@ -0,0 +1,160 @@
+//------------------------------------------------------------------------------
+// VolumeResponse
+//
+// The volume (area in 2D) retained by clipping a polyhedron (polygon) with a
+// plane of fixed normal, as a function of the plane distance.  Between the
+// sorted heights of the vertices along the normal this is a polynomial (cubic
+// in 3D, quadratic in 2D), which we store per interval in a local coordinate
+// so evaluation and inversion are just a binary search and a Horner sum.
+//
+// Built by volumeResponse in polyclipper2d.hh/polyclipper3d.hh.
+//------------------------------------------------------------------------------
+#ifndef __PolyClipper_VolumeResponse__
+#define __PolyClipper_VolumeResponse__
+
+#include "polyclipper_utilities.hh"
+
+#include <vector>
+#include <algorithm>
+
+namespace PolyClipper {
+
+struct VolumeResponse {
+  int degree;                        // Polynomial degree (2 => polygon, 3 => polyhedron)
+  double offset;                     // Height of the reference point along the normal
+  std::vector<double> breaks;        // Sorted vertex heights relative to offset
+  std::vector<double> coeffs;        // (degree + 1) coefficients per interval in x = h - breaks[k]
+  VolumeResponse()                   : degree(0), offset(0.0), breaks(), coeffs() {}
+
+  // Number of polynomial intervals.
+  size_t size() const                { return breaks.size() > 1u ? breaks.size() - 1u : 0u; }
+
+  // The full volume (plane below every vertex).
+  double totalVolume() const         { return this->size() > 0u ? coeffs[0] : 0.0; }
+
+  // Volume retained above the plane with distance dist.
+  double volume(const double dist) const {
+    double deriv;
+    return this->evaluate(deriv, -dist - offset);
+  }
+
+  // Derivative of the retained volume with respect to the plane distance, i.e.,
+  // the area of the cut face.
+  double derivative(const double dist) const {
+    double deriv;
+    this->evaluate(deriv, -dist - offset);
+    return -deriv;
+  }
+
+  // Plane distance which retains the volume vol.
+  double inverse(const double vol) const {
+    const auto n = this->size();
+    if (n == 0u) return -offset;
+    if (vol >= this->totalVolume()) return -(breaks.front() + offset);
+    if (vol <= 0.0) return -(breaks.back() + offset);
+
+    // Interval values are non-increasing in height, so bisect on the leading coefficients.
+    size_t ilo = 0u, ihi = n;
+    while (ihi - ilo > 1u) {
+      const auto imid = (ilo + ihi)/2u;
+      if (coeffs[imid*(degree + 1)] >= vol) {
+        ilo = imid;
+      } else {
+        ihi = imid;
+      }
+    }
+    return -(breaks[ilo] + internal::monotonePolynomialRoot(&coeffs[ilo*(degree + 1)], degree, vol, 0.0, breaks[ilo + 1] - breaks[ilo]) + offset);
+  }
+
+  // Volume above the (relative) height h, and its derivative with respect to h.
+  double evaluate(double& deriv, const double h) const {
+    deriv = 0.0;
+    const auto n = this->size();
+    if (n == 0u or h >= breaks.back()) return 0.0;
+    if (h <= breaks.front()) return this->totalVolume();
+    const auto k = size_t(std::upper_bound(breaks.begin(), breaks.end(), h) - breaks.begin()) - 1u;
+    return internal::evaluatePolynomial(deriv, &coeffs[k*(degree + 1)], degree, h - breaks[k]);
+  }
+};
+
+namespace internal {
+
+//------------------------------------------------------------------------------
+// Fill in the coefficients of a response whose breaks (and degree) are set,
+// from the signed simplices of the moments decomposition: heights holds the
+// sorted relative heights of each simplex (degree + 1 per simplex) and
+// weights their signed measures.  piece(c, h, p, h0) returns the polynomial
+// (in x = t - h0) of the fraction of simplex h above t between its p'th and
+// (p + 1)'th heights.
+// Rather than expanding every simplex on each interval it spans, each piece
+// between two of its knots is added where it starts and subtracted where it
+// ends, and a single sweep up the breaks carries the running polynomial from
+// one interval to the next.  A piece shorter than a tenth of the breaks' range
+// is added directly to the intervals it spans instead, since its large
+// coefficients would not cancel cleanly further up the sweep.
+//------------------------------------------------------------------------------
+template<typename PiecePolynomial>
+inline
+void
+sweepVolumeResponse(VolumeResponse& result,
+                    const std::vector<double>& heights,
+                    const std::vector<double>& weights,
+                    PiecePolynomial piece) {
+  const auto& breaks = result.breaks;
+  const auto n = result.size();
+  const auto degree = result.degree;
+  const auto m = size_t(degree + 1);
+  PCASSERT(n > 0u and degree <= 3);
+  auto& coeffs = result.coeffs;
+  coeffs.assign(m*n, 0.0);
+
+  // The jump in the polynomial at each break, in x = t - breaks[i].  Each
+  // simplex contributes its full measure below its lowest vertex.
+  std::vector<double> deltas(m*(n + 1u), 0.0);
+  const auto shortSpan = 0.1*(breaks.back() - breaks.front());
+  double c[4];
+  const auto nsimplices = weights.size();
+  for (auto k = 0u; k < nsimplices; ++k) {
+    const auto* h = &heights[m*k];
+    const auto w = weights[k];
+    auto lo = size_t(std::lower_bound(breaks.begin(), breaks.end(), h[0]) - breaks.begin());
+    deltas[0] += w;
+    deltas[m*lo] -= w;
+    for (auto p = 0; p < degree; ++p) {
+      const auto hi = size_t(std::lower_bound(breaks.begin() + lo, breaks.end(), h[p + 1]) - breaks.begin());
+      if (hi == lo + 1u or (hi > lo and h[p + 1] - h[p] < shortSpan)) {
+        for (auto i = lo; i < hi; ++i) {
+          piece(c, h, p, breaks[i]);
+          for (auto j = 0u; j < m; ++j) coeffs[m*i + j] += w*c[j];
+        }
+      } else if (hi > lo) {
+        piece(c, h, p, breaks[lo]);
+        for (auto j = 0u; j < m; ++j) deltas[m*lo + j] += w*c[j];
+        piece(c, h, p, breaks[hi]);
+        for (auto j = 0u; j < m; ++j) deltas[m*hi + j] -= w*c[j];
+      }
+      lo = hi;
+    }
+  }
+
+  // Sweep up the breaks, shifting the running polynomial to each new interval.
+  double running[4] = {0.0, 0.0, 0.0, 0.0};
+  for (auto i = 0u; i < n; ++i) {
+    if (i > 0u) {
+      const auto dx = breaks[i] - breaks[i - 1u];
+      for (auto j = 0; j < degree; ++j) {
+        for (auto l = degree - 1; l >= j; --l) running[l] += dx*running[l + 1];
+      }
+    }
+    for (auto j = 0u; j < m; ++j) {
+      running[j] += deltas[m*i + j];
+      coeffs[m*i + j] += running[j];
+    }
+  }
+}
+
+}
+
+}
+
+#endif
@@ -19,6 +19,10 @@
 #include <exception>
 #include <stdexcept>
 #include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <array>
+#include <cmath>
 
 namespace PolyClipper {
 //------------------------------------------------------------------------------
@@ -178,6 +182,28 @@ removeElements(std::vector<Value>& vec,
   }
 }
 
+//------------------------------------------------------------------------------
+// Compare a signed distance (or field value) with zero.
+//------------------------------------------------------------------------------
+inline
+int compare(const double sgndist) {
+  if (std::abs(sgndist) < 1.0e-10) return 0;
+  return sgn0(sgndist);
+}
+
+//------------------------------------------------------------------------------
+// Check whether a field has values (distinctly) above and below zero.
+//------------------------------------------------------------------------------
+inline
+bool fieldChangesSign(const std::vector<double>& field) {
+  auto above = false, below = false;
+  for (const auto x: field) {
+    above = above or compare(x) == 1;
+    below = below or compare(x) == -1;
+  }
+  return above and below;
+}
+
 //------------------------------------------------------------------------------
 // Compare a plane and point.
 //------------------------------------------------------------------------------
@@ -185,9 +211,118 @@ template<typename VA>
 inline
 int compare(const Plane<VA>& plane,
             const typename VA::VECTOR& point) {
-  const auto sgndist = plane.dist + VA::dot(plane.normal, point);
-  if (std::abs(sgndist) < 1.0e-10) return 0;
-  return sgn0(sgndist);
+  return compare(plane.dist + VA::dot(plane.normal, point));
+}
+
+//------------------------------------------------------------------------------
+// Find where a field varying linearly along a line-segment crosses zero.
+//------------------------------------------------------------------------------
+template<typename VA>
+inline
+typename VA::VECTOR
+segmentFieldIntersection(const typename VA::VECTOR& a,         // line-segment begin
+                         const typename VA::VECTOR& b,         // line-segment end
+                         const double afield,                  // field value at a
+                         const double bfield) {                // field value at b
+  PCASSERT(afield != bfield);
+  return VA::div(VA::sub(VA::mul(a, bfield), VA::mul(b, afield)), bfield - afield);
+}
+
+//------------------------------------------------------------------------------
+// The state shared by the cells of a mesh as they are clipped by one plane.
+// Each mesh point has its signed distance from the plane, and the point on
+// each crossing edge is computed the first time a cell asks for it, appended
+// to the mesh points, and cached by the (clipped, surviving) pair of global
+// IDs.  ids holds the global IDs of the vertices of the cell being clipped.
+//------------------------------------------------------------------------------
+template<typename VA>
+struct MeshCut {
+  std::vector<typename VA::VECTOR>& points;
+  const std::vector<double>& dist;
+  std::map<std::pair<int, int>, int> edgePoints;
+  std::vector<int> ids;
+
+  MeshCut(std::vector<typename VA::VECTOR>& pts, const std::vector<double>& d): points(pts), dist(d), edgePoints(), ids() {}
+
+  // The global ID of the point on the edge from clipped point a to surviving
+  // point b.
+  int edgePoint(const int a, const int b) {
+    const auto key = std::make_pair(a, b);
+    auto itr = edgePoints.find(key);
+    if (itr == edgePoints.end()) {
+      itr = edgePoints.insert(std::make_pair(key, int(points.size()))).first;
+      points.push_back(segmentFieldIntersection<VA>(points[a], points[b], dist[a], dist[b]));
+    }
+    return itr->second;
+  }
+};
+
+//------------------------------------------------------------------------------
+// Fit a linear function to a field sampled at the vertices of a polygon or
+// polyhedron, by least squares about their mean position.  Returns false (and
+// a zero gradient) unless the field is linear to a small tolerance relative to
+// its magnitude, i.e., it is the signed distance to some plane up to scaling.
+//------------------------------------------------------------------------------
+template<typename VA, typename VertexType>
+inline
+bool
+linearFieldGradient(typename VA::VECTOR& gradient,
+                    const std::vector<VertexType>& poly,
+                    const std::vector<double>& field,
+                    const int dimension) {
+  const int n = poly.size();
+  const auto d = dimension;
+  PCASSERT(int(field.size()) == n);
+  std::array<double, 3> xmean = {0.0, 0.0, 0.0}, g = {0.0, 0.0, 0.0};
+  VA::set_triple(gradient, g);
+  if (n <= d) return false;
+  auto fmean = 0.0, fmax = 0.0;
+  for (auto i = 0; i < n; ++i) {
+    const auto xi = VA::get_triple(poly[i].position);
+    for (auto j = 0; j < d; ++j) xmean[j] += xi[j]/n;
+    fmean += field[i]/n;
+    fmax = std::max(fmax, std::abs(field[i]));
+  }
+
+  // Normal equations (A | b), solved by Gaussian elimination with pivoting.
+  double A[3][4] = {{0.0}};
+  for (auto i = 0; i < n; ++i) {
+    auto xi = VA::get_triple(poly[i].position);
+    for (auto j = 0; j < d; ++j) xi[j] -= xmean[j];
+    for (auto j = 0; j < d; ++j) {
+      for (auto k = 0; k < d; ++k) A[j][k] += xi[j]*xi[k];
+      A[j][d] += xi[j]*(field[i] - fmean);
+    }
+  }
+  auto scale = 0.0;
+  for (auto j = 0; j < d; ++j) scale += A[j][j];
+  for (auto j = 0; j < d; ++j) {
+    auto p = j;
+    for (auto k = j + 1; k < d; ++k) {
+      if (std::abs(A[k][j]) > std::abs(A[p][j])) p = k;
+    }
+    if (std::abs(A[p][j]) <= 1.0e-12*scale) return false;
+    std::swap(A[j], A[p]);
+    for (auto k = j + 1; k < d; ++k) {
+      const auto f = A[k][j]/A[j][j];
+      for (auto m = j; m <= d; ++m) A[k][m] -= f*A[j][m];
+    }
+  }
+  for (auto j = d - 1; j >= 0; --j) {
+    g[j] = A[j][d];
+    for (auto k = j + 1; k < d; ++k) g[j] -= A[j][k]*g[k];
+    g[j] /= A[j][j];
+  }
+
+  // Check the residuals.
+  for (auto i = 0; i < n; ++i) {
+    const auto xi = VA::get_triple(poly[i].position);
+    auto fi = fmean;
+    for (auto j = 0; j < d; ++j) fi += g[j]*(xi[j] - xmean[j]);
+    if (std::abs(fi - field[i]) > 1.0e-10*fmax) return false;
+  }
+  VA::set_triple(gradient, g);
+  return true;
 }
 
 //------------------------------------------------------------------------------
@@ -199,10 +334,486 @@ typename VA::VECTOR
 segmentPlaneIntersection(const typename VA::VECTOR& a,         // line-segment begin
                          const typename VA::VECTOR& b,         // line-segment end
                          const Plane<VA>& plane) { // plane
-  const auto asgndist = plane.dist + VA::dot(plane.normal, a);
-  const auto bsgndist = plane.dist + VA::dot(plane.normal, b);
-  PCASSERT(asgndist != bsgndist);
-  return VA::div(VA::sub(VA::mul(a, bsgndist), VA::mul(b, asgndist)), bsgndist - asgndist);
+  return segmentFieldIntersection<VA>(a, b,
+                                      plane.dist + VA::dot(plane.normal, a),
+                                      plane.dist + VA::dot(plane.normal, b));
+}
+
+//------------------------------------------------------------------------------
+// Evaluate a polynomial (degree + 1 coefficients in ascending order) and its
+// derivative at x using Horner's rule.
+//------------------------------------------------------------------------------
+inline
+double
+evaluatePolynomial(double& deriv,
+                   const double* coeffs,
+                   const int degree,
+                   const double x) {
+  double val = 0.0;
+  deriv = 0.0;
+  for (auto k = degree; k >= 0; --k) {
+    deriv = deriv*x + val;
+    val = val*x + coeffs[k];
+  }
+  return val;
+}
+
+//------------------------------------------------------------------------------
+// Return the coefficients (ascending order) of q(x) = p(x + s).
+//------------------------------------------------------------------------------
+inline
+std::vector<double>
+shiftPolynomial(const std::vector<double>& coeffs,
+                const double s) {
+  std::vector<double> result(coeffs);
+  const auto n = int(result.size());
+  for (auto j = 0; j < n - 1; ++j) {
+    for (auto i = n - 2; i >= j; --i) result[i] += s*result[i+1];
+  }
+  return result;
+}
+
+//------------------------------------------------------------------------------
+// Solve p(x) = y for x in [x0, x1], where p is monotone on the interval and
+// p(x0), p(x1) bracket y.  Newton iteration safeguarded by bisection.
+//------------------------------------------------------------------------------
+inline
+double
+monotonePolynomialRoot(const double* coeffs,
+                       const int degree,
+                       const double y,
+                       double x0,
+                       double x1,
+                       const double tol = 1.0e-15,
+                       const unsigned maxIterations = 100u) {
+  double dp, x = 0.5*(x0 + x1);
+  const auto f0 = evaluatePolynomial(dp, coeffs, degree, x0) - y;
+  if (f0 == 0.0) return x0;
+  const auto s0 = sgn(f0);
+  auto iter = 0u;
+  while (iter++ < maxIterations and (x1 - x0) > tol*std::max(1.0, std::abs(x0) + std::abs(x1))) {
+    const auto f = evaluatePolynomial(dp, coeffs, degree, x) - y;
+    if (f == 0.0) return x;
+    if (sgn(f) == s0) {
+      x0 = x;
+    } else {
+      x1 = x;
+    }
+    const auto xnew = (dp != 0.0 ? x - f/dp : x0 - 1.0);
+    if (xnew > x0 and xnew < x1) {
+      if (std::abs(xnew - x) <= tol*std::max(1.0, std::abs(x))) return xnew;
+      x = xnew;
+    } else {
+      x = 0.5*(x0 + x1);
+    }
+  }
+  return x;
+}
+
+//------------------------------------------------------------------------------
+// Clip a loop of vertex indices (a cut face being tracked through clipPolygon
+// or clipPolyhedron) against the current plane, using the vertex comp flags.
+// edgeVertices maps each straddling edge (lower index, higher index) to the
+// vertex inserted on it.  Open loops (2D cut edges) don't wrap around.
+//------------------------------------------------------------------------------
+template<typename VertexType>
+inline
+void
+clipVertexLoop(std::vector<int>& loop,
+               const std::vector<VertexType>& poly,
+               const std::map<std::pair<int, int>, int>& edgeVertices,
+               const bool closed) {
+  std::vector<int> result;
+  const auto n = loop.size();
+  const auto nedges = closed ? n : n - 1u;
+  for (auto k = 0u; k < n; ++k) {
+    const auto a = loop[k];
+    if (poly[a].comp >= 0) result.push_back(a);
+    if (k < nedges) {
+      const auto b = loop[(k + 1u) % n];
+      if (poly[a].comp*poly[b].comp == -1) {
+        const auto itr = edgeVertices.find(std::make_pair(std::min(a, b), std::max(a, b)));
+        PCASSERT(itr != edgeVertices.end());
+        result.push_back(itr->second);
+      }
+    }
+  }
+  loop = result;
+}
+
+//------------------------------------------------------------------------------
+// Triangulate a simple loop by ear clipping, given the planar coordinates of
+// its vertices in loop order (xy = [x0, y0, x1, y1, ...]).  The triangles are
+// appended to tris as triples of loop positions, running the same way round as
+// the loop so they keep its orientation.  Collinear vertices are clipped as
+// zero area ears, and coincident vertices (such as the two sides of a bridge
+// to a hole) never block an ear.  If roundoff leaves no valid ear we clip the
+// most convex vertex, so this always terminates with n - 2 triangles.
+//------------------------------------------------------------------------------
+inline
+void
+earClipLoop(std::vector<int>& tris,
+            const std::vector<double>& xy) {
+  const int n = xy.size()/2;
+  if (n < 3) return;
+
+  // Work counterclockwise regardless of the loop orientation.
+  double area2 = 0.0;
+  for (auto i = 0; i < n; ++i) {
+    const auto j = (i + 1) % n;
+    area2 += xy[2*i]*xy[2*j + 1] - xy[2*j]*xy[2*i + 1];
+  }
+  const auto orient = (area2 >= 0.0 ? 1.0 : -1.0);
+  auto cross = [&](const int a, const int b, const int c) {
+    return orient*((xy[2*b] - xy[2*a])*(xy[2*c + 1] - xy[2*a + 1]) -
+                   (xy[2*b + 1] - xy[2*a + 1])*(xy[2*c] - xy[2*a]));
+  };
+
+  // Roundoff scale for the cross products, so vertices lying on an edge of a
+  // candidate ear (as clipping leaves along the cut line) reliably block it.
+  auto xmin = xy[0], xmax = xy[0], ymin = xy[1], ymax = xy[1];
+  for (auto i = 1; i < n; ++i) {
+    xmin = std::min(xmin, xy[2*i]);
+    xmax = std::max(xmax, xy[2*i]);
+    ymin = std::min(ymin, xy[2*i + 1]);
+    ymax = std::max(ymax, xy[2*i + 1]);
+  }
+  const auto eps = 1.0e-12*((xmax - xmin)*(xmax - xmin) + (ymax - ymin)*(ymax - ymin));
+  auto coincident = [&](const int a, const int b) {
+    return xy[2*a] == xy[2*b] and xy[2*a + 1] == xy[2*b + 1];
+  };
+
+  // Does vertex j block the ear (a, b, c)?
+  auto blocks = [&](const int a, const int b, const int c, const int j) {
+    if (coincident(j, a) or coincident(j, b) or coincident(j, c)) return false;
+    if (cross(a, b, j) < -eps or cross(b, c, j) < -eps or cross(c, a, j) < -eps) return false;
+    return (xy[2*j]     >= std::min(xy[2*a],     std::min(xy[2*b],     xy[2*c])) and
+            xy[2*j]     <= std::max(xy[2*a],     std::max(xy[2*b],     xy[2*c])) and
+            xy[2*j + 1] >= std::min(xy[2*a + 1], std::min(xy[2*b + 1], xy[2*c + 1])) and
+            xy[2*j + 1] <= std::max(xy[2*a + 1], std::max(xy[2*b + 1], xy[2*c + 1])));
+  };
+
+  std::vector<int> prev(n), next(n);
+  for (auto i = 0; i < n; ++i) {
+    prev[i] = (i + n - 1) % n;
+    next[i] = (i + 1) % n;
+  }
+  auto remaining = n;
+  auto i = 0;
+  auto misses = 0;
+  while (remaining > 3) {
+    auto a = prev[i], c = next[i];
+    auto ear = (cross(a, i, c) >= -eps);
+    for (auto j = next[c]; ear and j != a; j = next[j]) ear = not blocks(a, i, c, j);
+    if (not ear and ++misses > remaining) {
+      // No clean ear: take the most convex vertex.
+      auto best = i;
+      for (auto j = next[i]; j != i; j = next[j]) {
+        if (cross(prev[j], j, next[j]) > cross(prev[best], best, next[best])) best = j;
+      }
+      i = best;
+      a = prev[i];
+      c = next[i];
+      ear = true;
+    }
+    if (ear) {
+      tris.push_back(a);
+      tris.push_back(i);
+      tris.push_back(c);
+      next[a] = c;
+      prev[c] = a;
+      --remaining;
+      misses = 0;
+      i = a;
+    } else {
+      i = c;
+    }
+  }
+  tris.push_back(prev[i]);
+  tris.push_back(i);
+  tris.push_back(next[i]);
+}
+
+//------------------------------------------------------------------------------
+// Union-find (disjoint set) over the indices of parent, which should start out
+// as the identity.  Find uses path halving so the trees stay shallow.
+//------------------------------------------------------------------------------
+inline
+int
+unionFindRoot(std::vector<int>& parent, int i) {
+  while (parent[i] != i) {
+    parent[i] = parent[parent[i]];
+    i = parent[i];
+  }
+  return i;
+}
+
+inline
+void
+unionFindJoin(std::vector<int>& parent, const int i, const int j) {
+  const auto ri = unionFindRoot(parent, i), rj = unionFindRoot(parent, j);
+  if (ri < rj) {
+    parent[rj] = ri;
+  } else if (rj < ri) {
+    parent[ri] = rj;
+  }
+}
+
+// Number the sets 0, 1, ... in order of their lowest index, returning the
+// number of sets.
+inline
+int
+unionFindLabels(std::vector<int>& labels, std::vector<int>& parent) {
+  const int n = parent.size();
+  labels.assign(n, -1);
+  auto nsets = 0;
+  for (auto i = 0; i < n; ++i) {
+    const auto r = unionFindRoot(parent, i);
+    if (labels[r] == -1) labels[r] = nsets++;
+    labels[i] = labels[r];
+  }
+  return nsets;
+}
+
+//------------------------------------------------------------------------------
+// Weld the points closer than tol to the representative of a class, labeling
+// each point with its class and setting the representative of each class to
+// its first point.  The points are taken in order, each joining the class of
+// the nearest representative within tol or else starting a new class, so
+// welding does not chain along a run of points each within tol of the next:
+// every point ends up within tol of its representative.  The representatives
+// are hashed into cells of size tol, so each point only needs checking
+// against those in its own and the adjacent cells.  Classes are numbered in
+// order of their first point.  Returns the number of classes.
+//------------------------------------------------------------------------------
+struct SpatialHashKey {
+  size_t operator()(const std::array<long long, 3>& cell) const {
+    return (size_t(cell[0])*73856093u) ^ (size_t(cell[1])*19349663u) ^ (size_t(cell[2])*83492791u);
+  }
+};
+
+template<typename VA>
+inline
+int
+weldPoints(std::vector<int>& labels,
+           std::vector<typename VA::VECTOR>& representatives,
+           const std::vector<typename VA::VECTOR>& points,
+           const double tol) {
+  PCASSERT(tol > 0.0);
+  using Cell = std::array<long long, 3>;
+  std::unordered_map<Cell, std::vector<int>, SpatialHashKey> cells;
+  const int n = points.size();
+  labels.assign(n, -1);
+  representatives.clear();
+  const auto tol2 = tol*tol;
+  Cell key, cell;
+  for (auto i = 0; i < n; ++i) {
+    const auto xyz = VA::get_triple(points[i]);
+    for (auto k = 0; k < 3; ++k) key[k] = (long long)(std::floor(xyz[k]/tol));
+    auto dmin2 = tol2;
+    for (auto dx = -1; dx <= 1; ++dx) {
+      for (auto dy = -1; dy <= 1; ++dy) {
+        for (auto dz = -1; dz <= 1; ++dz) {
+          cell = {key[0] + dx, key[1] + dy, key[2] + dz};
+          const auto itr = cells.find(cell);
+          if (itr == cells.end()) continue;
+          for (const auto j: itr->second) {
+            const auto d2 = VA::magnitude2(VA::sub(points[i], representatives[j]));
+            if (d2 < dmin2) {
+              dmin2 = d2;
+              labels[i] = j;
+            }
+          }
+        }
+      }
+    }
+    if (labels[i] == -1) {
+      labels[i] = representatives.size();
+      representatives.push_back(points[i]);
+      cells[key].push_back(labels[i]);
+    }
+  }
+  return representatives.size();
+}
+
+//------------------------------------------------------------------------------
+// Maximize c.y over y in the box [-bound, bound]^d subject to the constraints
+// a_k.y <= b_k, using Seidel's randomized incremental algorithm (expected
+// O(d! n) time, so shuffle the constraints first).  The constraints are packed
+// in rows (a_k0, ..., a_k(d-1), b_k).  When the optimum so far violates a
+// constraint, the optimum with it lies on its boundary, so we eliminate one
+// variable there and recurse in d - 1 dimensions.  Returns false if the
+// constraints are infeasible, and otherwise leaves an optimal point in y.
+//------------------------------------------------------------------------------
+inline
+bool
+seidelLP(std::vector<double>& y,
+         const std::vector<double>& c,
+         const std::vector<double>& constraints,
+         const double bound,
+         const double tol) {
+  const int d = c.size();
+  const int n = constraints.size()/(d + 1);
+  y.resize(d);
+  for (auto j = 0; j < d; ++j) y[j] = (c[j] >= 0.0 ? bound : -bound);
+  std::vector<double> subConstraints, subc, suby;
+  for (auto i = 0; i < n; ++i) {
+    const auto* ai = &constraints[i*(d + 1)];
+    auto ay = 0.0;
+    for (auto j = 0; j < d; ++j) ay += ai[j]*y[j];
+    if (ay <= ai[d] + tol) continue;
+
+    // Solve a_i.y = b_i for the variable with the largest coefficient.
+    auto m = 0;
+    for (auto j = 1; j < d; ++j) {
+      if (std::abs(ai[j]) > std::abs(ai[m])) m = j;
+    }
+    if (d == 0 or std::abs(ai[m]) <= tol) return false;
+    auto project = [&](const double* ak) {
+      const auto f = ak[m]/ai[m];
+      for (auto j = 0; j <= d; ++j) {
+        if (j != m) subConstraints.push_back(ak[j] - f*ai[j]);
+      }
+    };
+    subConstraints.clear();
+    std::vector<double> boxRow(d + 1, 0.0);
+    boxRow[d] = bound;
+    boxRow[m] = 1.0;
+    project(&boxRow[0]);
+    boxRow[m] = -1.0;
+    project(&boxRow[0]);
+    for (auto k = 0; k < i; ++k) project(&constraints[k*(d + 1)]);
+    subc.clear();
+    for (auto j = 0; j < d; ++j) {
+      if (j != m) subc.push_back(c[j] - c[m]*ai[j]/ai[m]);
+    }
+    if (not seidelLP(suby, subc, subConstraints, bound, tol)) return false;
+    auto rhs = ai[d];
+    for (auto j = 0, jj = 0; j < d; ++j) {
+      if (j != m) {
+        y[j] = suby[jj++];
+        rhs -= ai[j]*y[j];
+      }
+    }
+    y[m] = rhs/ai[m];
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Find the largest ball above a set of planes (with unit normals) inside the
+// cube of the given half-width about center, by maximizing the smallest signed
+// distance t over (x, t) with seidelLP.  We work relative to the cube so the LP
+// is well scaled.  Returns false if the region is empty.
+//------------------------------------------------------------------------------
+template<typename VA>
+inline
+bool
+inscribedBall(typename VA::VECTOR& x,
+              double& radius,
+              const std::vector<Plane<VA>>& planes,
+              const typename VA::VECTOR& center,
+              const double halfWidth,
+              const int dimension) {
+  PCASSERT(halfWidth > 0.0);
+  const int n = planes.size();
+  const auto d = dimension + 1;
+  std::vector<int> order(n);
+  for (auto k = 0; k < n; ++k) order[k] = k;
+  std::minstd_rand generator(n);
+  std::shuffle(order.begin(), order.end(), generator);
+  std::vector<double> constraints;
+  constraints.reserve(n*(d + 1));
+  for (const auto k: order) {
+    const auto nhat = VA::get_triple(planes[k].normal);
+    for (auto j = 0; j < dimension; ++j) constraints.push_back(-nhat[j]);
+    constraints.push_back(1.0);
+    constraints.push_back((planes[k].dist + VA::dot(planes[k].normal, center))/halfWidth);
+  }
+  std::vector<double> c(d, 0.0), y;
+  c[dimension] = 1.0;
+  if (not seidelLP(y, c, constraints, 1.0, 1.0e-13)) return false;
+  auto xi = VA::get_triple(center);
+  for (auto j = 0; j < dimension; ++j) xi[j] += y[j]*halfWidth;
+  VA::set_triple(x, xi);
+  radius = y[dimension]*halfWidth;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Check whether the region above a set of planes (with unit normals) holds a
+// ball of radius above tol inside the cube of the given half-width about
+// center.
+//------------------------------------------------------------------------------
+template<typename VA>
+inline
+bool
+planesEncloseVolume(const std::vector<Plane<VA>>& planes,
+                    const typename VA::VECTOR& center,
+                    const double halfWidth,
+                    const int dimension,
+                    const double tol) {
+  auto x = center;
+  double radius;
+  return (inscribedBall(x, radius, planes, center, halfWidth, dimension) and
+          radius > tol);
+}
+
+//------------------------------------------------------------------------------
+// Flag the planes which are redundant for the region above a set of bounding
+// planes (all with unit normals): plane k is redundant if the smallest signed
+// distance to it over the region above the bounds and the other unflagged
+// planes is at least -tol.  Each test is a seidelLP in the cube of the given
+// half-width about center, which should contain the bounded region.  Entries
+// already set in redundant are skipped.  Returns false if the region is empty.
+//------------------------------------------------------------------------------
+template<typename VA>
+inline
+bool
+flagRedundantPlanes(std::vector<int>& redundant,
+                    const std::vector<Plane<VA>>& planes,
+                    const std::vector<Plane<VA>>& bounds,
+                    const typename VA::VECTOR& center,
+                    const double halfWidth,
+                    const int dimension,
+                    const double tol) {
+  PCASSERT(halfWidth > 0.0);
+  const int n = planes.size();
+  const int nbounds = bounds.size();
+  const auto d = dimension;
+  PCASSERT(int(redundant.size()) == n);
+
+  // Constraint rows -n.y <= (dist + n.center)/halfWidth for y = (x - center)/halfWidth,
+  // with the bounds numbered after the planes.
+  std::vector<double> rows((n + nbounds)*(d + 1));
+  auto addRow = [&](const int i, const Plane<VA>& plane) {
+    const auto nhat = VA::get_triple(plane.normal);
+    for (auto j = 0; j < d; ++j) rows[i*(d + 1) + j] = -nhat[j];
+    rows[i*(d + 1) + d] = (plane.dist + VA::dot(plane.normal, center))/halfWidth;
+  };
+  for (auto k = 0; k < n; ++k) addRow(k, planes[k]);
+  for (auto k = 0; k < nbounds; ++k) addRow(n + k, bounds[k]);
+  std::vector<int> order(n + nbounds);
+  for (auto k = 0; k < n + nbounds; ++k) order[k] = k;
+  std::minstd_rand generator(n + nbounds);
+  std::shuffle(order.begin(), order.end(), generator);
+
+  // Minimize the distance to each plane in turn over the others.
+  std::vector<double> constraints, c(d), y;
+  constraints.reserve((n + nbounds)*(d + 1));
+  for (auto k = 0; k < n; ++k) {
+    if (redundant[k]) continue;
+    constraints.clear();
+    for (const auto i: order) {
+      if (i != k and (i >= n or not redundant[i])) constraints.insert(constraints.end(), &rows[i*(d + 1)], &rows[(i + 1)*(d + 1)]);
+    }
+    for (auto j = 0; j < d; ++j) c[j] = rows[k*(d + 1) + j];
+    if (not seidelLP(y, c, constraints, 1.0, 1.0e-13)) return false;
+    auto hmin = rows[k*(d + 1) + d];
+    for (auto j = 0; j < d; ++j) hmin -= c[j]*y[j];
+    if (hmin*halfWidth >= -tol) redundant[k] = 1;
+  }
+  return true;
 }
 
 //------------------------------------------------------------------------------
@@ -167,13 +167,52 @@ class TestPolyClipper2d(unittest.TestCase):
         initializePolygon(poly0, degenerate_square_points, vertexNeighbors(degenerate_square_points))
         assert len(poly0) == len(degenerate_square_points)
         poly1 = Polygon(poly0)
-        collapseDegenerates(poly1, 1.0e-10)
+        vertexMap = collapseDegenerates(poly1, 1.0e-10)
         assert len(poly1) == 4
+        assert list(vertexMap) == [0, 1, 1, 2, 3, 3]
         vol0, centroid0 = moments(poly0)
         vol1, centroid1 = moments(poly1)
         assert vol1 == vol0
         assert centroid1 == centroid0
 
+    #---------------------------------------------------------------------------
+    # collapseDegenerates thins a finely sampled circle rather than removing it
+    #---------------------------------------------------------------------------
+    def test_collapseDegeneratesCircle(self):
+        n = 200
+        points = [Vector2d(cos(2.0*pi*i/n), sin(2.0*pi*i/n)) for i in xrange(n)]
+        poly0 = Polygon()
+        initializePolygon(poly0, points, vertexNeighbors(points))
+        vol0, centroid0 = moments(poly0)
+        tol = 3.0*sin(pi/n)          # 1.5 times the edge length
+        poly1 = Polygon(poly0)
+        vertexMap = collapseDegenerates(poly1, tol)
+        vol1, centroid1 = moments(poly1)
+        self.failUnless(len(poly1) == n/2, "Wrong number of vertices: %i != %i" % (len(poly1), n/2))
+        self.failUnless(fuzzyEqual(vol1, vol0, 1.0e-2), "Area comparison failure: %g != %g" % (vol1, vol0))
+        for i in xrange(n):
+            self.failUnless(vertexMap[i] >= 0 and (poly1[vertexMap[i]].position - poly0[i].position).magnitude() < tol,
+                            "Vertex %i merged too far: %s" % (i, poly1[vertexMap[i]].position))
+
+    #---------------------------------------------------------------------------
+    # collapseDegenerates after clipping near a vertex
+    #---------------------------------------------------------------------------
+    def test_collapseDegeneratesNearVertex(self):
+        tol = 1.0e-5
+        for i in xrange(self.ntests):
+            poly = Polygon()
+            initializePolygon(poly, notched_points, vertexNeighbors(notched_points))
+            phat = Vector2d(rangen.uniform(-1.0, 1.0),
+                            rangen.uniform(-1.0, 1.0)).unitVector()
+            p0 = notched_points[rangen.randint(0, len(notched_points) - 1)] + rangen.uniform(-tol, tol)*phat
+            clipPolygon(poly, [Plane2d(p0, phat)])
+            collapseDegenerates(poly, tol)
+            self.failUnless(len(poly) == 0 or len(poly) >= 3, "Degenerate polygon: %s" % poly)
+            for j in xrange(len(poly)):
+                v = poly[j]
+                self.failUnless(v.neighbors[0] != v.neighbors[1] and j not in v.neighbors,
+                                "Degenerate vertex: %s" % v)
+
     #---------------------------------------------------------------------------
     # Clip with a single plane along y = 0
     #---------------------------------------------------------------------------
@@ -491,6 +530,53 @@ class TestPolyClipper2d(unittest.TestCase):
             assert abs(volTris - vol0) < 1.0e-20
             assert (centroidTris - centroid0).magnitude() < 1.0e-20
 
+    #---------------------------------------------------------------------------
+    # splitIntoTriangles (non-convex)
+    #---------------------------------------------------------------------------
+    def testSplitIntoTrianglesNonconvex(self):
+        for points in self.nonconvexPointSets:
+            poly = Polygon()
+            initializePolygon(poly, points, vertexNeighbors(points))
+            tris = splitIntoTriangles(poly)
+            vol0, centroid0 = moments(poly)
+            volTris = 0.0
+            for inds in tris:
+                self.failUnless(len(inds) == 3, "Bad triangle: %s" % str(inds))
+                a = 0.5*(poly[inds[1]].position - poly[inds[0]].position).crossmag(poly[inds[2]].position - poly[inds[0]].position)
+                self.failUnless(a >= 0.0, "Inverted triangle: %g" % a)
+                volTris += a
+            self.failUnless(fuzzyEqual(volTris, vol0),
+                            "Area mismatch: %g != %g" % (volTris, vol0))
+
+        # A square with a square hole.
+        poly = Polygon()
+        initializePolygon(poly,
+                          [Vector2d(0,0), Vector2d(4,0), Vector2d(4,4), Vector2d(0,4),
+                           Vector2d(1,1), Vector2d(1,3), Vector2d(3,3), Vector2d(3,1)],
+                          [[3,1], [0,2], [1,3], [2,0],
+                           [7,5], [4,6], [5,7], [6,4]])
+        tris = splitIntoTriangles(poly)
+        self.failUnless(len(tris) == 8, "Expected 8 triangles, got %i" % len(tris))
+        volTris = sum([0.5*(poly[inds[1]].position - poly[inds[0]].position).crossmag(poly[inds[2]].position - poly[inds[0]].position)
+                       for inds in tris])
+        self.failUnless(fuzzyEqual(volTris, 12.0),
+                        "Area mismatch: %g != 12" % volTris)
+
+        # Two disjoint unit squares: each loop is locally convex, but the pair
+        # must not be fanned as a single polygon.
+        poly = Polygon()
+        initializePolygon(poly,
+                          [Vector2d(0,0), Vector2d(1,0), Vector2d(1,1), Vector2d(0,1),
+                           Vector2d(2,0), Vector2d(3,0), Vector2d(3,1), Vector2d(2,1)],
+                          [[3,1], [0,2], [1,3], [2,0],
+                           [7,5], [4,6], [5,7], [6,4]])
+        tris = splitIntoTriangles(poly)
+        self.failUnless(len(tris) == 4, "Expected 4 triangles, got %i" % len(tris))
+        volTris = sum([0.5*(poly[inds[1]].position - poly[inds[0]].position).crossmag(poly[inds[2]].position - poly[inds[0]].position)
+                       for inds in tris])
+        self.failUnless(fuzzyEqual(volTris, 2.0),
+                        "Area mismatch: %g != 2" % volTris)
+
     #---------------------------------------------------------------------------
     # extractFaces
     #---------------------------------------------------------------------------
@@ -558,6 +644,51 @@ class TestPolyClipper2d(unittest.TestCase):
                     for iclip in clip:
                         assert iclip in (10, 20)
 
+    #---------------------------------------------------------------------------
+    # Clipping across the notch of a non-convex polygon leaves separate pieces
+    #---------------------------------------------------------------------------
+    def testClipAcrossNotch(self):
+        poly = Polygon()
+        initializePolygon(poly, notched_points, vertexNeighbors(notched_points))
+        vol0, centroid0 = moments(poly)
+        self.failUnless(fuzzyEqual(vol0, 7.0), "Volume mismatch: %g != 7" % vol0)
+
+        # Horizontal cuts: each piece above the cut runs from its outer edge to
+        # a notch wall, 3 - y wide.
+        for i in xrange(self.ntests):
+            y = rangen.uniform(1.05, 1.95)
+            answer = 2.0*(3.0*(2.0 - y) - 0.5*(4.0 - y*y))
+            chunk = Polygon(poly)
+            clipPolygon(chunk, [Plane2d(Vector2d(0.0, y), Vector2d(0.0, 1.0))])
+            self.failUnless(len(splitComponents(chunk)[0]) == 2, "Expected two pieces above y=%g" % y)
+            self.failUnless(fuzzyEqual(moments(chunk)[0], answer),
+                            "Volume mismatch above y=%g: %g != %g" % (y, moments(chunk)[0], answer))
+            chunk = Polygon(poly)
+            clipPolygon(chunk, [Plane2d(Vector2d(0.0, y), Vector2d(0.0, -1.0))])
+            self.failUnless(len(splitComponents(chunk)[0]) == 1, "Expected one piece below y=%g" % y)
+            self.failUnless(fuzzyEqual(moments(chunk)[0], 7.0 - answer),
+                            "Volume mismatch below y=%g: %g != %g" % (y, moments(chunk)[0], 7.0 - answer))
+
+        # A second plane trims the right hand piece.
+        chunk = Polygon(poly)
+        clipPolygon(chunk, [Plane2d(Vector2d(0.0, 1.5), Vector2d(0.0, 1.0)),
+                            Plane2d(Vector2d(3.5, 0.0), Vector2d(-1.0, 0.0))])
+        self.failUnless(len(splitComponents(chunk)[0]) == 2, "Expected two pieces")
+        self.failUnless(fuzzyEqual(moments(chunk)[0], 1.0), "Volume mismatch: %g != 1" % moments(chunk)[0])
+
+        # Tilted cuts still pass between the notch tip and the top corners.
+        for i in xrange(self.ntests):
+            p0 = Vector2d(2.0, rangen.uniform(1.25, 1.75))
+            phat = Vector2d(rangen.uniform(-0.2, 0.2), 1.0).unitVector()
+            above = Polygon(poly)
+            clipPolygon(above, [Plane2d(p0, phat)])
+            below = Polygon(poly)
+            clipPolygon(below, [Plane2d(p0, -phat)])
+            self.failUnless(len(splitComponents(above)[0]) == 2 and len(splitComponents(below)[0]) == 1,
+                            "Bad pieces cutting with %s" % Plane2d(p0, phat))
+            self.failUnless(fuzzyEqual(moments(above)[0] + moments(below)[0], vol0),
+                            "Volume mismatch: %g + %g != %g" % (moments(above)[0], moments(below)[0], vol0))
+
     #---------------------------------------------------------------------------
     # Pathological degeneracy reported by Branson
     #---------------------------------------------------------------------------
@@ -578,5 +709,660 @@ class TestPolyClipper2d(unittest.TestCase):
         self.failUnless(vol1 == 0 and centroid1 == Vector2d(0,0),
                         "Degenerate test 1 failed: %s %s %s %s" % (vol0, centroid0, vol1, centroid1))
 
+    #---------------------------------------------------------------------------
+    # findPlaneForVolumeFraction
+    #---------------------------------------------------------------------------
+    def testFindPlaneForVolumeFraction(self):
+        for points in self.pointSets:
+            poly = Polygon()
+            initializePolygon(poly, points, vertexNeighbors(points))
+            v0, c0 = moments(poly)
+            for i in xrange(self.ntests):
+                phat = Vector2d(rangen.uniform(-1.0, 1.0), 
+                                rangen.uniform(-1.0, 1.0)).unitVector()
+                frac = rangen.uniform(0.0, 1.0)
+                d = findPlaneForVolumeFraction(poly, phat, frac)
+                chunk = Polygon(poly)
+                clipPolygon(chunk, [Plane2d(d, phat)])
+                v1, c1 = moments(chunk)
+                self.failUnless(fuzzyEqual(v1, frac*v0, 1.0e-10),
+                                "Volume fraction plane failure: %s != %s" % (v1, frac*v0))
+
+    #---------------------------------------------------------------------------
+    # nestedDissection
+    #---------------------------------------------------------------------------
+    def testNestedDissection(self):
+        for points in self.pointSets:
+            poly = Polygon()
+            initializePolygon(poly, points, vertexNeighbors(points))
+            v0, c0 = moments(poly)
+            for i in xrange(100):
+                nmat = rangen.randint(2, 4)
+                normals = [Vector2d(rangen.uniform(-1.0, 1.0), 
+                                    rangen.uniform(-1.0, 1.0)).unitVector() for j in xrange(nmat)]
+                fractions = [rangen.uniform(0.1, 1.0) for j in xrange(nmat)]
+                fractions = [x/sum(fractions) for x in fractions]
+                order = range(nmat)
+                rangen.shuffle(order)
+                pieces = nestedDissection(poly, order, normals, fractions)
+                vols, centroids = nestedDissectionMoments(poly, order, normals, fractions)
+                assert len(pieces) == nmat
+                for m in xrange(nmat):
+                    v1, c1 = moments(pieces[m])
+                    self.failUnless(fuzzyEqual(v1, fractions[m]*v0, 1.0e-10),
+                                    "Nested dissection volume failure: %s != %s" % (v1, fractions[m]*v0))
+                    self.failUnless(fuzzyEqual(vols[m], v1, 1.0e-10),
+                                    "Nested dissection moments failure: %s != %s" % (vols[m], v1))
+
+    #---------------------------------------------------------------------------
+    # volumeResponse
+    #---------------------------------------------------------------------------
+    def testVolumeResponse(self):
+        for points in self.pointSets:
+            poly = Polygon()
+            initializePolygon(poly, points, vertexNeighbors(points))
+            v0, c0 = moments(poly)
+            for i in xrange(100):
+                phat = Vector2d(rangen.uniform(-1.0, 1.0), 
+                                rangen.uniform(-1.0, 1.0)).unitVector()
+                response = volumeResponse(poly, phat)
+                self.failUnless(fuzzyEqual(response.totalVolume(), v0, 1.0e-10),
+                                "Volume response total failure: %s != %s" % (response.totalVolume(), v0))
+                for j in xrange(10):
+                    d = rangen.uniform(-20.0, 20.0)
+                    chunk = Polygon(poly)
+                    clipPolygon(chunk, [Plane2d(d, phat)])
+                    v1, c1 = moments(chunk)
+                    self.failUnless(fuzzyEqual(response.volume(d), v1, 1.0e-10),
+                                    "Volume response failure: %s != %s" % (response.volume(d), v1))
+                    vtarget = rangen.uniform(0.0, v0)
+                    self.failUnless(fuzzyEqual(response.volume(response.inverse(vtarget)), vtarget, 1.0e-10),
+                                    "Volume response inverse failure: %s != %s" % (response.volume(response.inverse(vtarget)), vtarget))
+
+    #---------------------------------------------------------------------------
+    # clippedMomentsWithGradient (check the distance derivative by differencing)
+    #---------------------------------------------------------------------------
+    def testClippedMomentsWithGradient(self):
+        for points in self.pointSets:
+            poly = Polygon()
+            initializePolygon(poly, points, vertexNeighbors(points))
+            for i in xrange(100):
+                p0 = Vector2d(rangen.uniform(0.0, 1.0),
+                              rangen.uniform(0.0, 1.0))
+                phat = Vector2d(rangen.uniform(-1.0, 1.0), 
+                                rangen.uniform(-1.0, 1.0)).unitVector()
+                planes = [Plane2d(p0, phat)]
+                v0, c0, dVdd, dVdn, dCdd, dCdn = clippedMomentsWithGradient(poly, planes)
+                chunk = Polygon(poly)
+                clipPolygon(chunk, planes)
+                v1, c1 = moments(chunk)
+                self.failUnless(fuzzyEqual(v0, v1, 1.0e-10),
+                                "Gradient moments failure: %s != %s" % (v0, v1))
+                dd = 1.0e-6
+                chunkp, chunkm = Polygon(poly), Polygon(poly)
+                clipPolygon(chunkp, [Plane2d(planes[0].dist + dd, phat)])
+                clipPolygon(chunkm, [Plane2d(planes[0].dist - dd, phat)])
+                vp, cp = moments(chunkp)
+                vm, cm = moments(chunkm)
+                self.failUnless(fuzzyEqual(dVdd[0], (vp - vm)/(2.0*dd), 1.0e-4),
+                                "Gradient dV/dd failure: %s != %s" % (dVdd[0], (vp - vm)/(2.0*dd)))
+
+    #---------------------------------------------------------------------------
+    # Clip returning the cut faces (the edge length is dV/ddist)
+    #---------------------------------------------------------------------------
+    def testClipCutFaces(self):
+        for points in self.pointSets:
+            poly = Polygon()
+            initializePolygon(poly, points, vertexNeighbors(points))
+            for i in xrange(100):
+                p0 = Vector2d(rangen.uniform(0.0, 1.0),
+                              rangen.uniform(0.0, 1.0))
+                phat = Vector2d(rangen.uniform(-1.0, 1.0), 
+                                rangen.uniform(-1.0, 1.0)).unitVector()
+                plane = Plane2d(p0, phat)
+                response = volumeResponse(poly, phat)
+                chunk = Polygon(poly)
+                cutFaces = clipPolygonCutFaces(chunk, [plane])
+                self.failUnless(len(cutFaces) == 1, "Wrong number of cut faces: %i" % len(cutFaces))
+                self.failUnless(fuzzyEqual(cutFaces[0].area, response.derivative(plane.dist), 1.0e-10),
+                                "Cut face area failure: %s != %s" % (cutFaces[0].area, response.derivative(plane.dist)))
+                for loop in cutFaces[0].loops:
+                    for j in loop:
+                        self.failUnless(abs(plane.dist + chunk[j].position.dot(phat)) < 1.0e-8,
+                                        "Cut face vertex not in plane: %s" % chunk[j].position)
+
+    #---------------------------------------------------------------------------
+    # fluxVolumes (a uniform dilation sweeps out the change in volume)
+    #---------------------------------------------------------------------------
+    def testFluxVolumes(self):
+        donor = [Plane2d(1.0e3, Vector2d(-1.0, 0.0)), Plane2d(1.0e3, Vector2d(1.0, 0.0)),
+                      Plane2d(1.0e3, Vector2d(0.0, -1.0)), Plane2d(1.0e3, Vector2d(0.0, 1.0))]
+        for points in self.pointSets:
+            poly = Polygon()
+            initializePolygon(poly, points, vertexNeighbors(points))
+            v0, c0 = moments(poly)
+            for i in xrange(10):
+                eps = rangen.uniform(-0.1, 0.1)
+                displacements = [(v.position - c0)*eps for v in poly]
+                fluxes, centroids = fluxVolumes(poly, displacements, [donor])
+                self.failUnless(len(fluxes) == len(extractFaces(poly)),
+                                "Wrong number of fluxes: %i" % len(fluxes))
+                dv = sum(fluxes)
+                dv0 = v0*((1.0 + eps)**2 - 1.0)
+                self.failUnless(fuzzyEqual(dv, dv0, 1.0e-10),
+                                "Flux volume failure: %s != %s" % (dv, dv0))
+
+    #---------------------------------------------------------------------------
+    # rzMoments (check Pappus's theorem, and that clipped halves sum)
+    #---------------------------------------------------------------------------
+    def testRZMoments(self):
+        for points in self.pointSets:
+            delta = Vector2d(rangen.uniform(-1.0, 1.0), rangen.uniform(1.0, 2.0))
+            points1 = [p + delta for p in points]
+            poly = Polygon()
+            initializePolygon(poly, points1, vertexNeighbors(points1))
+            area, centroid = moments(poly)
+            vol, rzcentroid = rzMoments(poly)
+            self.failUnless(fuzzyEqual(vol, 2.0*pi*area*centroid.y, 1.0e-10),
+                            "RZ volume failure: %s != %s" % (vol, 2.0*pi*area*centroid.y))
+            for i in xrange(100):
+                p0 = Vector2d(rangen.uniform(0.0, 1.0),
+                              rangen.uniform(0.0, 1.0)) + delta
+                phat = Vector2d(rangen.uniform(-1.0, 1.0), 
+                                rangen.uniform(-1.0, 1.0)).unitVector()
+                vols, rzcentroids = clippedRZMoments(poly, [[Plane2d(p0, phat)], [Plane2d(p0, -phat)]])
+                self.failUnless(fuzzyEqual(vols[0] + vols[1], vol, 1.0e-10),
+                                "RZ clipped volume failure: %s != %s" % (vols[0] + vols[1], vol))
+                rc = (rzcentroids[0]*vols[0] + rzcentroids[1]*vols[1])/vol
+                self.failUnless(fuzzyEqual((rc - rzcentroid).magnitude(), 0.0, 1.0e-10),
+                                "RZ clipped centroid failure: %s != %s" % (rc, rzcentroid))
+
+    #---------------------------------------------------------------------------
+    # surfaceMoments
+    #---------------------------------------------------------------------------
+    def testSurfaceMoments(self):
+        for points in self.pointSets:
+            poly = Polygon()
+            initializePolygon(poly, points, vertexNeighbors(points))
+            vol0, centroid0 = moments(poly)
+            vol, centroid, perimeter, lengths, centroids, normals = surfaceMoments(poly)
+            self.failUnless(fuzzyEqual(vol, vol0) and fuzzyEqual((centroid - centroid0).magnitude(), 0.0),
+                            "Fused moments failure: %s != %s" % ((vol, centroid), (vol0, centroid0)))
+            faces = extractFaces(poly)
+            self.failUnless(len(lengths) == len(faces), "Wrong number of edges: %i" % len(lengths))
+            self.failUnless(fuzzyEqual(perimeter, sum(lengths)), "Perimeter failure: %s != %s" % (perimeter, sum(lengths)))
+            # The divergence theorem: sum(L*n) = 0, and sum(L*n.x*x) = area
+            sumn = Vector2d(0.0, 0.0)
+            flux = 0.0
+            for L, c, n in zip(lengths, centroids, normals):
+                sumn += n*L
+                flux += L*n.x*c.x
+            self.failUnless(fuzzyEqual(sumn.magnitude(), 0.0, 1.0e-10), "Closure failure: %s" % sumn)
+            self.failUnless(fuzzyEqual(flux, vol0, 1.0e-10), "Divergence failure: %s != %s" % (flux, vol0))
+
+    #---------------------------------------------------------------------------
+    # integrate (simplex quadrature of polynomials against moments)
+    #---------------------------------------------------------------------------
+    def testIntegrate(self):
+        polys = []
+        for points in self.pointSets:
+            poly = Polygon()
+            initializePolygon(poly, points, vertexNeighbors(points))
+            polys.append(poly)
+            vol0, centroid0 = moments(poly)
+            vol = integrate(poly, lambda x, y: [1.0]*len(x), 0)
+            self.failUnless(fuzzyEqual(vol, vol0), "Volume integral failure: %s != %s" % (vol, vol0))
+            xvol = integrate(poly, lambda x, y: x, 1)
+            self.failUnless(fuzzyEqual(xvol, vol0*centroid0.x), "First moment integral failure: %s != %s" % (xvol, vol0*centroid0.x))
+            # Rules of different degree agree on polynomials they both integrate exactly
+            f = lambda x, y: [xi*xi*yi - 2.0*yi*yi for xi, yi in zip(x, y)]
+            I3 = integrate(poly, f, 3)
+            I5 = integrate(poly, f, 5)
+            self.failUnless(fuzzyEqual(I3, I5, 1.0e-10), "Cubic integral failure: %s != %s" % (I3, I5))
+        results = integrate(polys, lambda x, y: x, 1)
+        for poly, result in zip(polys, results):
+            self.failUnless(fuzzyEqual(result, integrate(poly, lambda x, y: x, 1)), "Batched integral failure")
+
+    #---------------------------------------------------------------------------
+    # splitComponents on convex polygons and clipped notched shapes
+    #---------------------------------------------------------------------------
+    def testSplitComponents(self):
+        # A single convex polygon is one component.
+        for points in self.convexPointSets:
+            poly = Polygon()
+            initializePolygon(poly, points, vertexNeighbors(points))
+            polys, vols, centroids = splitComponents(poly)
+            vol0, centroid0 = moments(poly)
+            self.failUnless(len(polys) == 1 and len(polys[0]) == len(poly), "Expected one component")
+            self.failUnless(fuzzyEqual(vols[0], vol0), "Volume mismatch: %g != %g" % (vols[0], vol0))
+
+        # Cutting across the notch leaves two pieces.
+        poly = Polygon()
+        initializePolygon(poly, notched_points, vertexNeighbors(notched_points))
+        clipPolygon(poly, [Plane2d(Vector2d(0, 1.5), Vector2d(0, 1))])
+        polys, vols, centroids = splitComponents(poly)
+        self.failUnless(len(polys) == 2, "Expected two components, got %i" % len(polys))
+        for piece, vol, centroid in zip(polys, vols, centroids):
+            self.failUnless(fuzzyEqual(vol, 0.625), "Volume mismatch: %g != 0.625" % vol)
+            vol1, centroid1 = moments(piece)
+            self.failUnless(fuzzyEqual(vol1, vol) and (centroid1 - centroid).magnitude() < 1.0e-10,
+                            "Moment mismatch: (%g, %s) != (%g, %s)" % (vol1, centroid1, vol, centroid))
+            for v in piece:
+                self.failUnless(poly[v.ID].position == v.position, "Bad vertex ID: %i" % v.ID)
+
+    #---------------------------------------------------------------------------
+    # subtractConvex pieces sum with the clipped part to the whole
+    #---------------------------------------------------------------------------
+    def testSubtractConvex(self):
+        for points in self.pointSets:
+            poly = Polygon()
+            initializePolygon(poly, points, vertexNeighbors(points))
+            vol0, centroid0 = moments(poly)
+            planes = [Plane2d(centroid0 - Vector2d(0.1, 0.1), Vector2d(1, 0)),
+                      Plane2d(centroid0 + Vector2d(0.1, 0.1), Vector2d(-1, 0)),
+                      Plane2d(centroid0 - Vector2d(0.1, 0.1), Vector2d(0, 1)),
+                      Plane2d(centroid0 + Vector2d(0.1, 0.1), Vector2d(0, -1))]
+            pieces = subtractConvex(poly, planes)
+            vols, centroids = subtractConvexMoments(poly, planes)
+            self.failUnless(len(pieces) == len(planes), "Expected one piece per plane")
+            inside = Polygon(poly)
+            clipPolygon(inside, planes)
+            voltot, centroidtot = moments(inside)
+            centroidtot *= voltot
+            for piece, vol, centroid in zip(pieces, vols, centroids):
+                vol1, centroid1 = moments(piece)
+                self.failUnless(fuzzyEqual(vol1, vol), "Moment mismatch: %g != %g" % (vol1, vol))
+                voltot += vol
+                centroidtot += vol*centroid
+            centroidtot /= voltot
+            self.failUnless(fuzzyEqual(voltot, vol0), "Volume mismatch: %g != %g" % (voltot, vol0))
+            self.failUnless((centroidtot - centroid0).magnitude() < 1.0e-10,
+                            "Centroid mismatch: %s != %s" % (centroidtot, centroid0))
+
+    #---------------------------------------------------------------------------
+    # intersect with a non-convex tool
+    #---------------------------------------------------------------------------
+    def testIntersect(self):
+        notched = Polygon()
+        initializePolygon(notched, notched_points, vertexNeighbors(notched_points))
+        tool = convexDecomposition(notched)
+        self.failUnless(tool.size() > 1, "Expected several convex parts")
+        for points in self.pointSets:
+            poly = Polygon()
+            initializePolygon(poly, points, vertexNeighbors(points))
+            vol0, centroid0 = moments(poly)
+
+            # The tool's parts cover the whole of a non-convex shape.
+            xmin = Vector2d(min([v.position.x for v in poly]) - 1.0, min([v.position.y for v in poly]) - 1.0)
+            box = Polygon()
+            initializePolygon(box, [xmin + 20.0*Vector2d(*c) for c in [(0,0), (1,0), (1,1), (0,1)]], vertexNeighbors(square_points))
+            pieces = intersect(box, convexDecomposition(poly))
+            vol1 = sum([moments(piece)[0] for piece in pieces])
+            self.failUnless(fuzzyEqual(vol1, vol0), "Volume mismatch: %g != %g" % (vol1, vol0))
+
+            # Intersection is symmetric.
+            pieces = intersect(poly, tool)
+            vol1 = sum([moments(piece)[0] for piece in pieces])
+            vol2 = sum([moments(piece)[0] for piece in intersect(notched, poly)])
+            vol3, centroid3 = intersectMoments(poly, tool)
+            self.failUnless(fuzzyEqual(vol1, vol2), "Intersection mismatch: %g != %g" % (vol1, vol2))
+            self.failUnless(fuzzyEqual(vol1, vol3), "Moment mismatch: %g != %g" % (vol1, vol3))
+
+    #---------------------------------------------------------------------------
+    # clipByVertexField
+    #---------------------------------------------------------------------------
+    def testClipByVertexField(self):
+        for points in self.pointSets:
+            poly = Polygon()
+            initializePolygon(poly, points, vertexNeighbors(points))
+            v0, c0 = moments(poly)
+            for i in xrange(100):
+                p0 = Vector2d(rangen.uniform(0.0, 1.0),
+                              rangen.uniform(0.0, 1.0))
+                phat = Vector2d(rangen.uniform(-1.0, 1.0),
+                                rangen.uniform(-1.0, 1.0)).unitVector()
+                plane = Plane2d(p0, phat)
+                field = [plane.dist + phat.dot(v.position) for v in poly]
+
+                # A linear field reproduces clipping by its zero plane.
+                chunk1 = Polygon(poly)
+                chunk2 = Polygon(poly)
+                clipPolygon(chunk1, [plane])
+                clipByVertexField(chunk2, field)
+                v1, c1 = moments(chunk1)
+                v2, c2 = moments(chunk2)
+                self.failUnless(fuzzyEqual(v1, v2), "Field clipping mismatch: %g != %g" % (v1, v2))
+
+                # The two sides of the field sum to the whole.
+                chunk3 = Polygon(poly)
+                clipByVertexField(chunk3, [-x for x in field])
+                v3, c3 = moments(chunk3)
+                self.failUnless(fuzzyEqual(v2 + v3, v0), "Field clipping summing to wrong volumes: %g + %g != %g" % (v2, v3, v0))
+
+    #---------------------------------------------------------------------------
+    # clipByVertexField (nonlinear fields on convex polygons)
+    #---------------------------------------------------------------------------
+    def testClipByVertexFieldNonlinear(self):
+        for points in self.convexPointSets:
+            poly = Polygon()
+            initializePolygon(poly, points, vertexNeighbors(points))
+            v0, c0 = moments(poly)
+            xmin = min([min(p.x, p.y) for p in points])
+            xmax = max([max(p.x, p.y) for p in points])
+            for i in xrange(100):
+                p0 = Vector2d(rangen.uniform(xmin, xmax),
+                              rangen.uniform(xmin, xmax))
+                r = rangen.uniform(0.0, xmax - xmin)
+
+                # A circle, and a saddle which can cut a face more than once.
+                for field in ([r*r - (v.position - p0).magnitude2() for v in poly],
+                              [(v.position - p0).x*(v.position - p0).y - 0.1*r*r for v in poly]):
+                    chunk1 = Polygon(poly)
+                    chunk2 = Polygon(poly)
+                    clipByVertexField(chunk1, field)
+                    clipByVertexField(chunk2, [-x for x in field])
+                    v1, c1 = moments(chunk1)
+                    v2, c2 = moments(chunk2)
+                    self.failUnless(v1 <= v0*(1.0 + 1.0e-10) and v2 <= v0*(1.0 + 1.0e-10),
+                                    "Field clipping grew the polygon: %g %g > %g" % (v1, v2, v0))
+                    self.failUnless(fuzzyEqual(v1 + v2, v0), "Field clipping summing to wrong volumes: %g + %g != %g" % (v1, v2, v0))
+
+    #---------------------------------------------------------------------------
+    # clipMesh
+    #---------------------------------------------------------------------------
+    def testClipMesh(self):
+        # Two squares sharing the edge (1, 4).
+        points = [Vector2d(*coords) for coords in [(0,0), (10,0), (20,0), (0,10), (10,10), (20,10)]]
+        cellVertices = [[0, 1, 4, 3], [1, 2, 5, 4]]
+        cells = []
+        for ids in cellVertices:
+            cell = Polygon()
+            initializePolygon(cell, [points[i] for i in ids], vertexNeighbors(square_points))
+            cells.append(cell)
+        for i in xrange(100):
+            p0 = Vector2d(rangen.uniform(0.0, 20.0),
+                          rangen.uniform(0.0, 10.0))
+            phat = Vector2d(rangen.uniform(-1.0, 1.0),
+                            rangen.uniform(-1.0, 1.0)).unitVector()
+            plane = Plane2d(p0, phat)
+            clipped, ids, newPoints = clipMesh(cells, cellVertices, points, plane)
+            vol0 = 0.0
+            for cell in cells:
+                chunk = Polygon(cell)
+                clipPolygon(chunk, [plane])
+                vol0 += moments(chunk)[0]
+            vol1 = sum([moments(cell)[0] for cell in clipped])
+            self.failUnless(fuzzyEqual(vol1, vol0), "Volume mismatch: %g != %g" % (vol1, vol0))
+
+            # Every vertex sits exactly on its shared global point.
+            for cell, cellIDs in zip(clipped, ids):
+                self.failUnless(len(cell) == len(cellIDs), "Bad vertex IDs")
+                for v, j in zip(cell, cellIDs):
+                    self.failUnless(v.position == newPoints[j], "Vertex mismatch: %s != %s" % (v.position, newPoints[j]))
+
+        # A non-convex cell cut across its notch splits the same way as clipPolygon.
+        poly = Polygon()
+        initializePolygon(poly, notched_points, vertexNeighbors(notched_points))
+        for i in xrange(100):
+            plane = Plane2d(Vector2d(rangen.uniform(0.0, 4.0), 1.5),
+                            Vector2d(rangen.uniform(-0.2, 0.2), 1.0).unitVector())
+            clipped, ids, newPoints = clipMesh([poly], [range(len(notched_points))], notched_points, plane)
+            chunk = Polygon(poly)
+            clipPolygon(chunk, [plane])
+            self.failUnless(len(splitComponents(clipped[0])[0]) == len(splitComponents(chunk)[0]),
+                            "Component mismatch cutting notch with %s" % plane)
+
+        # A cell with two coincident vertices clips the same as clipPolygon.
+        points = [Vector2d(*coords) for coords in [(0,0), (1,0), (1,0), (1,1), (0,1)]]
+        poly = Polygon()
+        initializePolygon(poly, points, vertexNeighbors(points))
+        plane = Plane2d(Vector2d(0.5, 0.0), Vector2d(1.0, 0.0))
+        clipped, ids, newPoints = clipMesh([poly], [range(len(points))], points, plane)
+        chunk = Polygon(poly)
+        clipPolygon(chunk, [plane])
+        self.failUnless(fuzzyEqual(moments(clipped[0])[0], 0.5) and fuzzyEqual(moments(chunk)[0], 0.5),
+                        "Area mismatch: %g %g" % (moments(clipped[0])[0], moments(chunk)[0]))
+        self.failUnless(len(clipped[0]) == len(ids[0]) == len(chunk), "Bad vertex IDs: %s" % list(ids[0]))
+        for v, j in zip(clipped[0], ids[0]):
+            self.failUnless(v.position == newPoints[j], "Vertex mismatch: %s != %s" % (v.position, newPoints[j]))
+
+    #---------------------------------------------------------------------------
+    # assembleMesh matches the shared edge of independently clipped cells
+    #---------------------------------------------------------------------------
+    def testAssembleMesh(self):
+        # Two squares sharing the edge (10,0)-(10,10), each cut independently
+        # by the same horizontal plane.
+        points = [Vector2d(*coords) for coords in [(0,0), (10,0), (20,0), (0,10), (10,10), (20,10)]]
+        cells0 = []
+        for ids in [[0, 1, 4, 3], [1, 2, 5, 4]]:
+            cell = Polygon()
+            initializePolygon(cell, [points[i] for i in ids], vertexNeighbors(square_points))
+            cells0.append(cell)
+        for i in xrange(100):
+            plane = Plane2d(Vector2d(0.0, rangen.uniform(1.0, 9.0)), Vector2d(0.0, 1.0))
+            cells = []
+            for cell in cells0:
+                chunk = Polygon(cell)
+                clipPolygon(chunk, [plane])
+                cells.append(chunk)
+            mesh = assembleMesh(cells, 1.0e-8)
+            self.failUnless(mesh.numCells() == 2, "Bad number of cells: %i" % mesh.numCells())
+            self.failUnless(len(mesh.points) == 6, "Bad number of points: %i" % len(mesh.points))
+            self.failUnless(mesh.numFaces() == 7, "Bad number of faces: %i" % mesh.numFaces())
+            interior = [f for f in xrange(mesh.numFaces()) if mesh.faceCells[2*f + 1] != -1]
+            self.failUnless(len(interior) == 1, "Bad number of interior faces: %i" % len(interior))
+            f = interior[0]
+            self.failUnless(mesh.faceCells[2*f] == 0 and mesh.faceCells[2*f + 1] == 1,
+                            "Bad interior face cells: %s" % list(mesh.faceCells[2*f:2*f + 2]))
+            self.failUnless(~f in mesh.cellFaces[mesh.cellFaceOffsets[1]:mesh.cellFaceOffsets[2]],
+                            "Interior face not shared")
+
+    #---------------------------------------------------------------------------
+    # weldVertices makes shared vertices with roundoff bit-identical
+    #---------------------------------------------------------------------------
+    def testWeldVertices(self):
+        # Two squares sharing an edge, with roundoff in the shared vertices.
+        points = [Vector2d(*coords) for coords in [(0,0), (10,0), (20,0), (0,10), (10,10), (20,10)]]
+        for i in xrange(100):
+            polys = []
+            for ids in [[0, 1, 4, 3], [1, 2, 5, 4]]:
+                poly = Polygon()
+                initializePolygon(poly, [points[j] + Vector2d(rangen.uniform(-1.0e-12, 1.0e-12),
+                                                              rangen.uniform(-1.0e-12, 1.0e-12)) for j in ids],
+                                  vertexNeighbors(square_points))
+                polys.append(poly)
+            welded, classes = weldVertices(polys, 1.0e-8)
+            self.failUnless(len(set(classes[0] + classes[1])) == 6, "Bad vertex classes: %s" % classes)
+            self.failUnless(classes[0][1] == classes[1][0] and classes[0][2] == classes[1][3],
+                            "Shared vertices not welded: %s" % classes)
+            self.failUnless(welded[0][1].position == welded[1][0].position and
+                            welded[0][2].position == welded[1][3].position,
+                            "Shared positions not identical")
+
+    #---------------------------------------------------------------------------
+    # weldVertices does not chain a run of vertices each within tol of the next
+    #---------------------------------------------------------------------------
+    def testWeldVerticesNoChaining(self):
+        tol = 1.0e-8
+        polys = []
+        for i in xrange(10):
+            poly = Polygon()
+            initializePolygon(poly, [p + Vector2d(0.6*tol*i, 0.0) for p in square_points],
+                              vertexNeighbors(square_points))
+            polys.append(poly)
+        welded, classes = weldVertices(polys, tol)
+        for i in xrange(10):
+            for j in xrange(len(square_points)):
+                self.failUnless((welded[i][j].position - polys[i][j].position).magnitude() < tol,
+                                "Vertex moved too far: %s -> %s" % (polys[i][j].position, welded[i][j].position))
+        self.failUnless(len(set(sum(classes, []))) > len(square_points),
+                        "Vertices chained into too few classes: %s" % classes)
+
+    #---------------------------------------------------------------------------
+    # simplifyPlanes merges near duplicates and drops missing planes
+    #---------------------------------------------------------------------------
+    def testSimplifyPlanes(self):
+        poly = Polygon()
+        initializePolygon(poly, square_points, vertexNeighbors(square_points))
+        for i in xrange(100):
+            # Random planes, with a near duplicate of each and one plane that
+            # misses the square.
+            planes = []
+            for j in xrange(5):
+                p0 = Vector2d(rangen.uniform(0.0, 10.0),
+                              rangen.uniform(0.0, 10.0))
+                phat = Vector2d(rangen.uniform(-1.0, 1.0),
+                                rangen.uniform(-1.0, 1.0)).unitVector()
+                planes.append(Plane2d(p0, phat, j))
+                planes.append(Plane2d(p0 + 1.0e-12*phat, phat, 10 + j))
+            planes.append(Plane2d(Vector2d(-1.0, 0.0), Vector2d(1.0, 0.0), 20))
+            result, planeMap = simplifyPlanes(poly, planes, 1.0e-8)
+            self.failUnless(len(planeMap) == len(planes), "Bad plane map size")
+            self.failUnless(len(result) <= 5, "Too many planes: %i" % len(result))
+            self.failUnless(planeMap[-1] == -1, "Redundant plane kept")
+            for j in xrange(5):
+                self.failUnless(planeMap[2*j] == planeMap[2*j + 1], "Coplanar planes not merged")
+            chunk0 = Polygon(poly)
+            clipPolygon(chunk0, planes)
+            chunk1 = Polygon(poly)
+            clipPolygon(chunk1, result)
+            vol0, vol1 = moments(chunk0)[0], moments(chunk1)[0]
+            if vol0 > 0.0:
+                self.failUnless(fuzzyEqual(vol1, vol0), "Volume mismatch: %g != %g" % (vol1, vol0))
+
+    #---------------------------------------------------------------------------
+    # intersectsHalfspaces agrees with clipping
+    #---------------------------------------------------------------------------
+    def testIntersectsHalfspaces(self):
+        poly = Polygon()
+        initializePolygon(poly, square_points, vertexNeighbors(square_points))
+        for i in xrange(1000):
+            planes = []
+            for j in xrange(1 + i % 4):
+                p0 = Vector2d(rangen.uniform(-5.0, 15.0),
+                              rangen.uniform(-5.0, 15.0))
+                phat = Vector2d(rangen.uniform(-1.0, 1.0),
+                                rangen.uniform(-1.0, 1.0)).unitVector()
+                planes.append(Plane2d(p0, phat, j))
+            chunk = Polygon(poly)
+            clipPolygon(chunk, planes)
+            vol = moments(chunk)[0]
+            if vol == 0.0 or vol > 1.0e-6:
+                self.failUnless(intersectsHalfspaces(poly, planes) == (vol > 0.0),
+                                "Bad intersection test for %s: %g" % (planes, vol))
+
+    #---------------------------------------------------------------------------
+    # convexOverlap agrees with clipping one convex polygon by the other
+    #---------------------------------------------------------------------------
+    def testConvexOverlap(self):
+        poly = Polygon()
+        initializePolygon(poly, square_points, vertexNeighbors(square_points))
+        a = facePlanes(poly)
+        for i in xrange(1000):
+            # A randomly shifted copy of the cell, clipped by a random plane.
+            delta = Vector2d(rangen.uniform(-15.0, 15.0),
+                             rangen.uniform(-15.0, 15.0))
+            other = Polygon()
+            initializePolygon(other, [p + delta for p in square_points], vertexNeighbors(square_points))
+            p0 = Vector2d(rangen.uniform(0.0, 10.0),
+                          rangen.uniform(0.0, 10.0)) + delta
+            phat = Vector2d(rangen.uniform(-1.0, 1.0),
+                            rangen.uniform(-1.0, 1.0)).unitVector()
+            clipPolygon(other, [Plane2d(p0, phat)])
+            if len(other) == 0:
+                continue
+            b = facePlanes(other)
+            overlap, bound = convexOverlap(a, b)
+            chunk = Polygon(poly)
+            clipPolygon(chunk, b.planes)
+            vol = moments(chunk)[0]
+            self.failUnless(bound >= vol*(1.0 - 1.0e-10), "Bad volume bound: %g < %g" % (bound, vol))
+            if vol == 0.0 or vol > 1.0e-6:
+                self.failUnless(overlap == (vol > 0.0),
+                                "Bad overlap test: %s != %g" % (overlap, vol))
+
+    #---------------------------------------------------------------------------
+    # containsPoints and signedDistances on the notched polygon
+    #---------------------------------------------------------------------------
+    def testContainsPoints(self):
+        # The notched polygon is inside 0 < x < 4, 0 < y < 2, below the notch.
+        def insideNotched(x, y):
+            return 0.0 < x < 4.0 and 0.0 < y < min(2.0, abs(x - 2.0) + 1.0)
+        poly = Polygon()
+        initializePolygon(poly, notched_points, vertexNeighbors(notched_points))
+        cell = facePlanes(poly)
+        self.failUnless(not cell.convex, "Notched polygon should not be convex")
+        x = [rangen.uniform(-1.0, 5.0) for i in xrange(1000)]
+        y = [rangen.uniform(-1.0, 3.0) for i in xrange(1000)]
+        inside = containsPoints(cell, x, y)
+        dist = signedDistances(cell, x, y)
+        for i in xrange(1000):
+            if abs(dist[i]) > 1.0e-8:
+                self.failUnless(bool(inside[i]) == insideNotched(x[i], y[i]),
+                                "Bad containment for (%g, %g)" % (x[i], y[i]))
+                self.failUnless((dist[i] > 0.0) == insideNotched(x[i], y[i]),
+                                "Bad distance sign for (%g, %g): %g" % (x[i], y[i], dist[i]))
+
+        # Inside the square the distance is to the nearest side.
+        poly = Polygon()
+        initializePolygon(poly, square_points, vertexNeighbors(square_points))
+        cell = facePlanes(poly)
+        self.failUnless(cell.convex, "Square should be convex")
+        x = [rangen.uniform(0.0, 10.0) for i in xrange(1000)]
+        y = [rangen.uniform(0.0, 10.0) for i in xrange(1000)]
+        dist = signedDistances(cell, x, y)
+        for i in xrange(1000):
+            answer = min(x[i], 10.0 - x[i], y[i], 10.0 - y[i])
+            self.failUnless(fuzzyEqual(dist[i], answer, 1.0e-10),
+                            "Distance mismatch: %g != %g" % (dist[i], answer))
+
+    #---------------------------------------------------------------------------
+    # polygonFromHalfspaces matches clipping the bounding square
+    #---------------------------------------------------------------------------
+    def testPolygonFromHalfspaces(self):
+        # Bisector planes of random neighbors around a point, like a Voronoi
+        # cell, bounded by the square.
+        box = Polygon()
+        initializePolygon(box, square_points, vertexNeighbors(square_points))
+        boxPlanes = [Plane2d(Vector2d(0, 0), Vector2d(1, 0), 100),
+                     Plane2d(Vector2d(10, 0), Vector2d(-1, 0), 101),
+                     Plane2d(Vector2d(0, 0), Vector2d(0, 1), 102),
+                     Plane2d(Vector2d(0, 10), Vector2d(0, -1), 103)]
+        for i in xrange(100):
+            p0 = Vector2d(rangen.uniform(2.0, 8.0),
+                          rangen.uniform(2.0, 8.0))
+            planes = list(boxPlanes)
+            for j in xrange(50):
+                pj = p0 + rangen.uniform(0.5, 5.0)*Vector2d(rangen.uniform(-1.0, 1.0),
+                                                            rangen.uniform(-1.0, 1.0)).unitVector()
+                planes.append(Plane2d(0.5*(p0 + pj), (p0 - pj).unitVector(), j))
+            poly = Polygon()
+            polygonFromHalfspaces(poly, planes, p0)
+            chunk = Polygon(box)
+            clipPolygon(chunk, planes)
+            vol0, centroid0 = moments(chunk)
+            vol1, centroid1 = moments(poly)
+            self.failUnless(fuzzyEqual(vol1, vol0), "Volume mismatch: %g != %g" % (vol1, vol0))
+            self.failUnless(fuzzyEqual((centroid1 - centroid0).magnitude(), 0.0),
+                            "Centroid mismatch: %s != %s" % (centroid1, centroid0))
+            for v in poly:
+                self.failUnless(len(v.clips) == 2, "Bad clips: %s" % list(v.clips))
+
+    #---------------------------------------------------------------------------
+    # convexHull of random points in the square
+    #---------------------------------------------------------------------------
+    def testConvexHull(self):
+        for i in xrange(100):
+            # Random points in the square, plus its corners.
+            points = [Vector2d(rangen.uniform(0.0, 10.0),
+                               rangen.uniform(0.0, 10.0)) for j in xrange(100)] + square_points
+            poly = Polygon()
+            convexHull(poly, points)
+            self.failUnless(len(poly) == 4, "Bad number of hull vertices: %i" % len(poly))
+            vol, centroid = moments(poly)
+            self.failUnless(fuzzyEqual(vol, 100.0), "Volume mismatch: %g != 100" % vol)
+            for v in poly:
+                self.failUnless(v.position == points[v.ID], "Bad vertex ID: %i" % v.ID)
+
 if __name__ == "__main__":
     unittest.main()
@@ -225,16 +225,20 @@ class TestPolyhedronClipping(unittest.TestCase):
     # collapseDegenerates
     #---------------------------------------------------------------------------
     def test_collapseDegenerates(self):
-        for points, neighbors, facets in self.degeneratePolyData:
+        vertexMaps = [[0, 1, 2, 3, 4, 4, 4, 4],
+                      [0, 1, 2, 2, 3, 4, 2, 2]]
+        for (points, neighbors, facets), vertexMap0 in zip(self.degeneratePolyData, vertexMaps):
             poly0 = Polyhedron()
             initializePolyhedron(poly0, points, neighbors)
             assert len(poly0) == len(points)
             #writePolyOBJ(poly0, "poly0.obj")
             poly1 = Polyhedron(poly0)
             #writePolyOBJ(poly1, "poly1_initial.obj")
-            collapseDegenerates(poly1, 1.0e-10)
+            vertexMap = collapseDegenerates(poly1, 1.0e-10)
             #writePolyOBJ(poly1, "poly1_collapse.obj")
             assert len(poly1) == 5
+            self.failUnless(list(vertexMap) == vertexMap0,
+                            "Vertex map failure: %s != %s" % (list(vertexMap), vertexMap0))
             vol0, centroid0 = moments(poly0)
             vol1, centroid1 = moments(poly1)
             #writePolyOBJ(poly1, "poly1_collapse.obj")
@@ -243,6 +247,46 @@ class TestPolyhedronClipping(unittest.TestCase):
             self.failUnless(fuzzyEqual((centroid1 - centroid0).magnitude(), 0.0),
                             "Centroid comparison failure: %s != %s" % (centroid1, centroid0))
 
+    #---------------------------------------------------------------------------
+    # collapseDegenerates thins a finely sampled cylinder rather than removing it
+    #---------------------------------------------------------------------------
+    def test_collapseDegeneratesCylinder(self):
+        n = 200
+        points = [Vector3d(cos(2.0*pi*i/n), sin(2.0*pi*i/n), z) for z in (0.0, 1.0) for i in xrange(n)]
+        neighbors = ([[(i + 1) % n, i + n, (i - 1) % n] for i in xrange(n)] +
+                     [[(i + 1) % n + n, (i - 1) % n + n, i] for i in xrange(n)])
+        poly0 = Polyhedron()
+        initializePolyhedron(poly0, points, neighbors)
+        vol0, centroid0 = moments(poly0)
+        tol = 3.0*sin(pi/n)          # 1.5 times the edge length
+        poly1 = Polyhedron(poly0)
+        vertexMap = collapseDegenerates(poly1, tol)
+        vol1, centroid1 = moments(poly1)
+        self.failUnless(len(poly1) == n, "Wrong number of vertices: %i != %i" % (len(poly1), n))
+        self.failUnless(fuzzyEqual(vol1, vol0, 1.0e-2), "Volume comparison failure: %g != %g" % (vol1, vol0))
+        for i in xrange(2*n):
+            self.failUnless(vertexMap[i] >= 0 and (poly1[vertexMap[i]].position - poly0[i].position).magnitude() < tol,
+                            "Vertex %i merged too far: %s" % (i, poly1[vertexMap[i]].position))
+
+    #---------------------------------------------------------------------------
+    # collapseDegenerates after clipping near a vertex
+    #---------------------------------------------------------------------------
+    def test_collapseDegeneratesNearVertex(self):
+        tol = 1.0e-5
+        for i in xrange(self.ntests):
+            poly = Polyhedron()
+            initializePolyhedron(poly, notched_points, notched_neighbors)
+            phat = Vector3d(rangen.uniform(-1.0, 1.0),
+                            rangen.uniform(-1.0, 1.0),
+                            rangen.uniform(-1.0, 1.0)).unitVector()
+            p0 = notched_points[rangen.randint(0, len(notched_points) - 1)] + rangen.uniform(-tol, tol)*phat
+            clipPolyhedron(poly, [Plane3d(p0, phat)])
+            collapseDegenerates(poly, tol)
+            self.failUnless(len(poly) == 0 or len(poly) >= 4, "Degenerate polyhedron: %s" % poly)
+            for v in poly:
+                self.failUnless(len(v.neighbors) >= 2, "Dangling vertex: %s" % v)
+            faces = extractFaces(poly)
+
     #---------------------------------------------------------------------------
     # Clip with planes passing through the polyhedron.
     #---------------------------------------------------------------------------
@@ -486,6 +530,58 @@ class TestPolyhedronClipping(unittest.TestCase):
             assert abs(volTets - vol0) < 1.0e-20
             assert (centroidTets - centroid0).magnitude() < 1.0e-20
 
+    #---------------------------------------------------------------------------
+    # splitIntoTetrahedra (general polyhedra)
+    #---------------------------------------------------------------------------
+    def testSplitIntoTetrahedraWithPoints(self):
+        for points, neighbors, facets in self.polyData:
+            poly = Polyhedron()
+            initializePolyhedron(poly, points, neighbors)
+            tetPoints, tets = splitIntoTetrahedraWithPoints(poly)
+            self.failUnless(len(tetPoints) >= len(poly) and len(tets) % 4 == 0,
+                            "Bad sizes: %i %i" % (len(tetPoints), len(tets)))
+            for i in xrange(len(poly)):
+                self.failUnless(tetPoints[i] == poly[i].position,
+                                "Point mismatch: %s != %s" % (tetPoints[i], poly[i].position))
+            vol0, centroid0 = moments(poly)
+            volTets = 0.0
+            for k in xrange(len(tets)/4):
+                v0, v1, v2, v3 = [tetPoints[j] for j in tets[4*k:4*k + 4]]
+                V = (v1 - v0).dot((v2 - v0).cross(v3 - v0))/6.0
+                self.failUnless(V >= 0.0, "Inverted tetrahedron: %g" % V)
+                volTets += V
+            self.failUnless(fuzzyEqual(volTets, vol0),
+                            "Volume mismatch: %g != %g" % (volTets, vol0))
+
+        # The notched polyhedron has a star vertex, so the original interface works too.
+        poly = Polyhedron()
+        initializePolyhedron(poly, notched_points, notched_neighbors)
+        tets = splitIntoTetrahedra(poly)
+        vol0, centroid0 = moments(poly)
+        volTets = 0.0
+        for inds in tets:
+            v0, v1, v2, v3 = [poly[j].position for j in inds]
+            V = (v1 - v0).dot((v2 - v0).cross(v3 - v0))/6.0
+            self.failUnless(V >= 0.0, "Inverted tetrahedron: %g" % V)
+            volTets += V
+        self.failUnless(fuzzyEqual(volTets, vol0),
+                        "Volume mismatch: %g != %g" % (volTets, vol0))
+
+        # Clipping the notched polyhedron can leave pieces the first vertex
+        # doesn't see, which must not be fanned from it.
+        for i in xrange(self.ntests):
+            chunk = Polyhedron(poly)
+            plane = Plane3d(Vector3d(rangen.uniform(0.0, 4.0), rangen.uniform(0.0, 2.0), rangen.uniform(0.0, 1.0)),
+                            Vector3d(rangen.uniform(-1.0, 1.0), rangen.uniform(-1.0, 1.0), rangen.uniform(-1.0, 1.0)).unitVector())
+            clipPolyhedron(chunk, [plane])
+            vol0, centroid0 = moments(chunk)
+            volTets = 0.0
+            for inds in splitIntoTetrahedra(chunk):
+                v0, v1, v2, v3 = [chunk[j].position for j in inds]
+                volTets += (v1 - v0).dot((v2 - v0).cross(v3 - v0))/6.0
+            self.failUnless(fuzzyEqual(volTets, vol0, 1.0e-10),
+                            "Volume mismatch clipping with %s: %g != %g" % (plane, volTets, vol0))
+
     #---------------------------------------------------------------------------
     # extractFaces
     #---------------------------------------------------------------------------
@@ -561,5 +657,711 @@ class TestPolyhedronClipping(unittest.TestCase):
                     for iclip in clip:
                         assert iclip in (10, 20)
 
+    #---------------------------------------------------------------------------
+    # Clipping across the notch of a non-convex polyhedron leaves separate pieces
+    #---------------------------------------------------------------------------
+    def testClipAcrossNotch(self):
+        poly = Polyhedron()
+        initializePolyhedron(poly, notched_points, notched_neighbors)
+        vol0, centroid0 = moments(poly)
+        self.failUnless(fuzzyEqual(vol0, 7.0), "Volume mismatch: %g != 7" % vol0)
+
+        # Horizontal cuts: each piece above the cut runs from its outer face to
+        # a notch wall, 3 - y wide.
+        for i in xrange(self.ntests):
+            y = rangen.uniform(1.05, 1.95)
+            answer = 2.0*(3.0*(2.0 - y) - 0.5*(4.0 - y*y))
+            chunk = Polyhedron(poly)
+            clipPolyhedron(chunk, [Plane3d(Vector3d(0.0, y, 0.0), Vector3d(0.0, 1.0, 0.0))])
+            self.failUnless(len(splitComponents(chunk)[0]) == 2, "Expected two pieces above y=%g" % y)
+            self.failUnless(fuzzyEqual(moments(chunk)[0], answer),
+                            "Volume mismatch above y=%g: %g != %g" % (y, moments(chunk)[0], answer))
+            chunk = Polyhedron(poly)
+            clipPolyhedron(chunk, [Plane3d(Vector3d(0.0, y, 0.0), Vector3d(0.0, -1.0, 0.0))])
+            self.failUnless(len(splitComponents(chunk)[0]) == 1, "Expected one piece below y=%g" % y)
+            self.failUnless(fuzzyEqual(moments(chunk)[0], 7.0 - answer),
+                            "Volume mismatch below y=%g: %g != %g" % (y, moments(chunk)[0], 7.0 - answer))
+
+        # A second plane trims the right hand piece.
+        chunk = Polyhedron(poly)
+        clipPolyhedron(chunk, [Plane3d(Vector3d(0.0, 1.5, 0.0), Vector3d(0.0, 1.0, 0.0)),
+                               Plane3d(Vector3d(3.5, 0.0, 0.0), Vector3d(-1.0, 0.0, 0.0))])
+        self.failUnless(len(splitComponents(chunk)[0]) == 2, "Expected two pieces")
+        self.failUnless(fuzzyEqual(moments(chunk)[0], 1.0), "Volume mismatch: %g != 1" % moments(chunk)[0])
+
+        # Tilted cuts still pass between the notch edge and the top corners.
+        for i in xrange(self.ntests):
+            p0 = Vector3d(2.0, rangen.uniform(1.35, 1.65), 0.5)
+            phat = Vector3d(rangen.uniform(-0.2, 0.2), 1.0, rangen.uniform(-0.2, 0.2)).unitVector()
+            above = Polyhedron(poly)
+            clipPolyhedron(above, [Plane3d(p0, phat)])
+            below = Polyhedron(poly)
+            clipPolyhedron(below, [Plane3d(p0, -phat)])
+            self.failUnless(len(splitComponents(above)[0]) == 2 and len(splitComponents(below)[0]) == 1,
+                            "Bad pieces cutting with %s" % Plane3d(p0, phat))
+            self.failUnless(fuzzyEqual(moments(above)[0] + moments(below)[0], vol0),
+                            "Volume mismatch: %g + %g != %g" % (moments(above)[0], moments(below)[0], vol0))
+
+    #---------------------------------------------------------------------------
+    # findPlaneForVolumeFraction
+    #---------------------------------------------------------------------------
+    def testFindPlaneForVolumeFraction(self):
+        for points, neighbors, facets in self.polyData:
+            poly = Polyhedron()
+            initializePolyhedron(poly, points, neighbors)
+            v0, c0 = moments(poly)
+            for i in xrange(self.ntests):
+                phat = Vector3d(rangen.uniform(-1.0, 1.0), 
+                                rangen.uniform(-1.0, 1.0),
+                                rangen.uniform(-1.0, 1.0)).unitVector()
+                frac = rangen.uniform(0.0, 1.0)
+                d = findPlaneForVolumeFraction(poly, phat, frac)
+                chunk = Polyhedron(poly)
+                clipPolyhedron(chunk, [Plane3d(d, phat)])
+                v1, c1 = moments(chunk)
+                self.failUnless(fuzzyEqual(v1, frac*v0, 1.0e-10),
+                                "Volume fraction plane failure: %s != %s" % (v1, frac*v0))
+
+    #---------------------------------------------------------------------------
+    # nestedDissection
+    #---------------------------------------------------------------------------
+    def testNestedDissection(self):
+        for points, neighbors, facets in self.polyData:
+            poly = Polyhedron()
+            initializePolyhedron(poly, points, neighbors)
+            v0, c0 = moments(poly)
+            for i in xrange(100):
+                nmat = rangen.randint(2, 4)
+                normals = [Vector3d(rangen.uniform(-1.0, 1.0), 
+                                    rangen.uniform(-1.0, 1.0),
+                                    rangen.uniform(-1.0, 1.0)).unitVector() for j in xrange(nmat)]
+                fractions = [rangen.uniform(0.1, 1.0) for j in xrange(nmat)]
+                fractions = [x/sum(fractions) for x in fractions]
+                order = range(nmat)
+                rangen.shuffle(order)
+                pieces = nestedDissection(poly, order, normals, fractions)
+                vols, centroids = nestedDissectionMoments(poly, order, normals, fractions)
+                assert len(pieces) == nmat
+                for m in xrange(nmat):
+                    v1, c1 = moments(pieces[m])
+                    self.failUnless(fuzzyEqual(v1, fractions[m]*v0, 1.0e-10),
+                                    "Nested dissection volume failure: %s != %s" % (v1, fractions[m]*v0))
+                    self.failUnless(fuzzyEqual(vols[m], v1, 1.0e-10),
+                                    "Nested dissection moments failure: %s != %s" % (vols[m], v1))
+
+    #---------------------------------------------------------------------------
+    # volumeResponse
+    #---------------------------------------------------------------------------
+    def testVolumeResponse(self):
+        for points, neighbors, facets in self.polyData:
+            poly = Polyhedron()
+            initializePolyhedron(poly, points, neighbors)
+            v0, c0 = moments(poly)
+            for i in xrange(100):
+                phat = Vector3d(rangen.uniform(-1.0, 1.0), 
+                                rangen.uniform(-1.0, 1.0),
+                                rangen.uniform(-1.0, 1.0)).unitVector()
+                response = volumeResponse(poly, phat)
+                self.failUnless(fuzzyEqual(response.totalVolume(), v0, 1.0e-10),
+                                "Volume response total failure: %s != %s" % (response.totalVolume(), v0))
+                for j in xrange(10):
+                    d = rangen.uniform(-20.0, 20.0)
+                    chunk = Polyhedron(poly)
+                    clipPolyhedron(chunk, [Plane3d(d, phat)])
+                    v1, c1 = moments(chunk)
+                    self.failUnless(fuzzyEqual(response.volume(d), v1, 1.0e-10),
+                                    "Volume response failure: %s != %s" % (response.volume(d), v1))
+                    vtarget = rangen.uniform(0.0, v0)
+                    self.failUnless(fuzzyEqual(response.volume(response.inverse(vtarget)), vtarget, 1.0e-10),
+                                    "Volume response inverse failure: %s != %s" % (response.volume(response.inverse(vtarget)), vtarget))
+
+    #---------------------------------------------------------------------------
+    # clippedMomentsWithGradient (check the distance derivative by differencing)
+    #---------------------------------------------------------------------------
+    def testClippedMomentsWithGradient(self):
+        for points, neighbors, facets in self.polyData:
+            poly = Polyhedron()
+            initializePolyhedron(poly, points, neighbors)
+            for i in xrange(100):
+                p0 = Vector3d(rangen.uniform(0.0, 1.0),
+                              rangen.uniform(0.0, 1.0),
+                              rangen.uniform(0.0, 1.0))
+                phat = Vector3d(rangen.uniform(-1.0, 1.0), 
+                                rangen.uniform(-1.0, 1.0),
+                                rangen.uniform(-1.0, 1.0)).unitVector()
+                planes = [Plane3d(p0, phat)]
+                v0, c0, dVdd, dVdn, dCdd, dCdn = clippedMomentsWithGradient(poly, planes)
+                chunk = Polyhedron(poly)
+                clipPolyhedron(chunk, planes)
+                v1, c1 = moments(chunk)
+                self.failUnless(fuzzyEqual(v0, v1, 1.0e-10),
+                                "Gradient moments failure: %s != %s" % (v0, v1))
+                dd = 1.0e-6
+                chunkp, chunkm = Polyhedron(poly), Polyhedron(poly)
+                clipPolyhedron(chunkp, [Plane3d(planes[0].dist + dd, phat)])
+                clipPolyhedron(chunkm, [Plane3d(planes[0].dist - dd, phat)])
+                vp, cp = moments(chunkp)
+                vm, cm = moments(chunkm)
+                self.failUnless(fuzzyEqual(dVdd[0], (vp - vm)/(2.0*dd), 1.0e-4),
+                                "Gradient dV/dd failure: %s != %s" % (dVdd[0], (vp - vm)/(2.0*dd)))
+
+    #---------------------------------------------------------------------------
+    # Clip returning the cut faces (the face area is dV/ddist)
+    #---------------------------------------------------------------------------
+    def testClipCutFaces(self):
+        for points, neighbors, facets in self.polyData:
+            poly = Polyhedron()
+            initializePolyhedron(poly, points, neighbors)
+            for i in xrange(100):
+                p0 = Vector3d(rangen.uniform(0.0, 1.0),
+                              rangen.uniform(0.0, 1.0),
+                              rangen.uniform(0.0, 1.0))
+                phat = Vector3d(rangen.uniform(-1.0, 1.0), 
+                                rangen.uniform(-1.0, 1.0),
+                                rangen.uniform(-1.0, 1.0)).unitVector()
+                plane = Plane3d(p0, phat)
+                response = volumeResponse(poly, phat)
+                chunk = Polyhedron(poly)
+                cutFaces = clipPolyhedronCutFaces(chunk, [plane])
+                self.failUnless(len(cutFaces) == 1, "Wrong number of cut faces: %i" % len(cutFaces))
+                self.failUnless(fuzzyEqual(cutFaces[0].area, response.derivative(plane.dist), 1.0e-10),
+                                "Cut face area failure: %s != %s" % (cutFaces[0].area, response.derivative(plane.dist)))
+                for loop in cutFaces[0].loops:
+                    for j in loop:
+                        self.failUnless(abs(plane.dist + chunk[j].position.dot(phat)) < 1.0e-8,
+                                        "Cut face vertex not in plane: %s" % chunk[j].position)
+
+    #---------------------------------------------------------------------------
+    # fluxVolumes (a uniform dilation sweeps out the change in volume)
+    #---------------------------------------------------------------------------
+    def testFluxVolumes(self):
+        donor = [Plane3d(1.0e3, Vector3d(-1.0, 0.0, 0.0)), Plane3d(1.0e3, Vector3d(1.0, 0.0, 0.0)),
+                      Plane3d(1.0e3, Vector3d(0.0, -1.0, 0.0)), Plane3d(1.0e3, Vector3d(0.0, 1.0, 0.0)),
+                      Plane3d(1.0e3, Vector3d(0.0, 0.0, -1.0)), Plane3d(1.0e3, Vector3d(0.0, 0.0, 1.0))]
+        for points, neighbors, facets in self.polyData:
+            poly = Polyhedron()
+            initializePolyhedron(poly, points, neighbors)
+            v0, c0 = moments(poly)
+            for i in xrange(10):
+                eps = rangen.uniform(-0.1, 0.1)
+                displacements = [(v.position - c0)*eps for v in poly]
+                fluxes, centroids = fluxVolumes(poly, displacements, [donor])
+                self.failUnless(len(fluxes) == len(extractFaces(poly)),
+                                "Wrong number of fluxes: %i" % len(fluxes))
+                dv = sum(fluxes)
+                dv0 = v0*((1.0 + eps)**3 - 1.0)
+                self.failUnless(fuzzyEqual(dv, dv0, 1.0e-10),
+                                "Flux volume failure: %s != %s" % (dv, dv0))
+
+    #---------------------------------------------------------------------------
+    # surfaceMoments
+    #---------------------------------------------------------------------------
+    def testSurfaceMoments(self):
+        for points, neighbors, facets in self.polyData:
+            poly = Polyhedron()
+            initializePolyhedron(poly, points, neighbors)
+            vol0, centroid0 = moments(poly)
+            vol, centroid, area, areas, centroids, normals = surfaceMoments(poly)
+            self.failUnless(fuzzyEqual(vol, vol0) and fuzzyEqual((centroid - centroid0).magnitude(), 0.0),
+                            "Fused moments failure: %s != %s" % ((vol, centroid), (vol0, centroid0)))
+            faces = extractFaces(poly)
+            self.failUnless(len(areas) == len(faces), "Wrong number of faces: %i" % len(areas))
+            self.failUnless(fuzzyEqual(area, sum(areas)), "Area failure: %s != %s" % (area, sum(areas)))
+            # The divergence theorem: sum(A*n) = 0, and sum(A*n.x*x) = volume
+            sumn = Vector3d(0.0, 0.0, 0.0)
+            flux = 0.0
+            for A, c, n in zip(areas, centroids, normals):
+                sumn += n*A
+                flux += A*n.x*c.x
+            self.failUnless(fuzzyEqual(sumn.magnitude(), 0.0, 1.0e-10), "Closure failure: %s" % sumn)
+            self.failUnless(fuzzyEqual(flux, vol0, 1.0e-10), "Divergence failure: %s != %s" % (flux, vol0))
+
+    #---------------------------------------------------------------------------
+    # integrate (simplex quadrature of polynomials against moments)
+    #---------------------------------------------------------------------------
+    def testIntegrate(self):
+        polys = []
+        for points, neighbors, facets in self.polyData:
+            poly = Polyhedron()
+            initializePolyhedron(poly, points, neighbors)
+            polys.append(poly)
+            vol0, centroid0 = moments(poly)
+            vol = integrate(poly, lambda x, y, z: [1.0]*len(x), 0)
+            self.failUnless(fuzzyEqual(vol, vol0), "Volume integral failure: %s != %s" % (vol, vol0))
+            zvol = integrate(poly, lambda x, y, z: z, 1)
+            self.failUnless(fuzzyEqual(zvol, vol0*centroid0.z), "First moment integral failure: %s != %s" % (zvol, vol0*centroid0.z))
+            # Rules of different degree agree on polynomials they both integrate exactly
+            f = lambda x, y, z: [xi*yi*zi - 2.0*zi*zi for xi, yi, zi in zip(x, y, z)]
+            I3 = integrate(poly, f, 3)
+            I5 = integrate(poly, f, 5)
+            self.failUnless(fuzzyEqual(I3, I5, 1.0e-10), "Cubic integral failure: %s != %s" % (I3, I5))
+        results = integrate(polys, lambda x, y, z: z, 1)
+        for poly, result in zip(polys, results):
+            self.failUnless(fuzzyEqual(result, integrate(poly, lambda x, y, z: z, 1)), "Batched integral failure")
+
+    #---------------------------------------------------------------------------
+    # splitComponents on convex polyhedra and clipped notched shapes
+    #---------------------------------------------------------------------------
+    def testSplitComponents(self):
+        # A single convex polyhedron is one component.
+        for points, neighbors, facets in self.convexPolyData:
+            poly = Polyhedron()
+            initializePolyhedron(poly, points, neighbors)
+            polys, vols, centroids = splitComponents(poly)
+            vol0, centroid0 = moments(poly)
+            self.failUnless(len(polys) == 1 and len(polys[0]) == len(poly), "Expected one component")
+            self.failUnless(fuzzyEqual(vols[0], vol0), "Volume mismatch: %g != %g" % (vols[0], vol0))
+
+        # Cutting across the notch leaves two pieces.
+        poly = Polyhedron()
+        initializePolyhedron(poly, notched_points, notched_neighbors)
+        clipPolyhedron(poly, [Plane3d(Vector3d(0, 1.5, 0), Vector3d(0, 1, 0))])
+        polys, vols, centroids = splitComponents(poly)
+        self.failUnless(len(polys) == 2, "Expected two components, got %i" % len(polys))
+        for piece, vol, centroid in zip(polys, vols, centroids):
+            self.failUnless(fuzzyEqual(vol, 0.625), "Volume mismatch: %g != 0.625" % vol)
+            vol1, centroid1 = moments(piece)
+            self.failUnless(fuzzyEqual(vol1, vol) and (centroid1 - centroid).magnitude() < 1.0e-10,
+                            "Moment mismatch: (%g, %s) != (%g, %s)" % (vol1, centroid1, vol, centroid))
+            for v in piece:
+                self.failUnless(poly[v.ID].position == v.position, "Bad vertex ID: %i" % v.ID)
+
+    #---------------------------------------------------------------------------
+    # subtractConvex pieces sum with the clipped part to the whole
+    #---------------------------------------------------------------------------
+    def testSubtractConvex(self):
+        for points, neighbors, facets in self.polyData:
+            poly = Polyhedron()
+            initializePolyhedron(poly, points, neighbors)
+            vol0, centroid0 = moments(poly)
+            planes = []
+            for n in (Vector3d(1, 0, 0), Vector3d(0, 1, 0), Vector3d(0, 0, 1)):
+                planes += [Plane3d(centroid0 - 0.1*n, n),
+                           Plane3d(centroid0 + 0.1*n, -n)]
+            pieces = subtractConvex(poly, planes)
+            vols, centroids = subtractConvexMoments(poly, planes)
+            self.failUnless(len(pieces) == len(planes), "Expected one piece per plane")
+            inside = Polyhedron(poly)
+            clipPolyhedron(inside, planes)
+            voltot, centroidtot = moments(inside)
+            centroidtot *= voltot
+            for piece, vol, centroid in zip(pieces, vols, centroids):
+                vol1, centroid1 = moments(piece)
+                self.failUnless(fuzzyEqual(vol1, vol), "Moment mismatch: %g != %g" % (vol1, vol))
+                voltot += vol
+                centroidtot += vol*centroid
+            centroidtot /= voltot
+            self.failUnless(fuzzyEqual(voltot, vol0), "Volume mismatch: %g != %g" % (voltot, vol0))
+            self.failUnless((centroidtot - centroid0).magnitude() < 1.0e-10,
+                            "Centroid mismatch: %s != %s" % (centroidtot, centroid0))
+
+    #---------------------------------------------------------------------------
+    # intersect with a non-convex tool
+    #---------------------------------------------------------------------------
+    def testIntersect(self):
+        notched = Polyhedron()
+        initializePolyhedron(notched, notched_points, notched_neighbors)
+        tool = convexDecomposition(notched)
+        self.failUnless(tool.size() > 1, "Expected several convex parts")
+        for points, neighbors, facets in self.polyData:
+            poly = Polyhedron()
+            initializePolyhedron(poly, points, neighbors)
+            vol0, centroid0 = moments(poly)
+
+            # The tool's parts cover the whole of a non-convex shape.
+            xmin = Vector3d(min([v.position.x for v in poly]) - 1.0,
+                            min([v.position.y for v in poly]) - 1.0,
+                            min([v.position.z for v in poly]) - 1.0)
+            box = Polyhedron()
+            initializePolyhedron(box, [xmin + 2.0*p for p in cube_points], cube_neighbors)
+            pieces = intersect(box, convexDecomposition(poly))
+            vol1 = sum([moments(piece)[0] for piece in pieces])
+            self.failUnless(fuzzyEqual(vol1, vol0), "Volume mismatch: %g != %g" % (vol1, vol0))
+
+            # Intersection is symmetric.
+            pieces = intersect(poly, tool)
+            vol1 = sum([moments(piece)[0] for piece in pieces])
+            vol2 = sum([moments(piece)[0] for piece in intersect(notched, poly)])
+            vol3, centroid3 = intersectMoments(poly, tool)
+            self.failUnless(fuzzyEqual(vol1, vol2), "Intersection mismatch: %g != %g" % (vol1, vol2))
+            self.failUnless(fuzzyEqual(vol1, vol3), "Moment mismatch: %g != %g" % (vol1, vol3))
+
+    #---------------------------------------------------------------------------
+    # clipByVertexField
+    #---------------------------------------------------------------------------
+    def testClipByVertexField(self):
+        for points, neighbors, facets in self.polyData:
+            poly = Polyhedron()
+            initializePolyhedron(poly, points, neighbors)
+            v0, c0 = moments(poly)
+            for i in xrange(100):
+                p0 = Vector3d(rangen.uniform(0.0, 1.0),
+                              rangen.uniform(0.0, 1.0),
+                              rangen.uniform(0.0, 1.0))
+                phat = Vector3d(rangen.uniform(-1.0, 1.0),
+                                rangen.uniform(-1.0, 1.0),
+                                rangen.uniform(-1.0, 1.0)).unitVector()
+                plane = Plane3d(p0, phat)
+                field = [plane.dist + phat.dot(v.position) for v in poly]
+
+                # A linear field reproduces clipping by its zero plane.
+                chunk1 = Polyhedron(poly)
+                chunk2 = Polyhedron(poly)
+                clipPolyhedron(chunk1, [plane])
+                clipByVertexField(chunk2, field)
+                v1, c1 = moments(chunk1)
+                v2, c2 = moments(chunk2)
+                self.failUnless(fuzzyEqual(v1, v2), "Field clipping mismatch: %g != %g" % (v1, v2))
+
+                # The two sides of the field sum to the whole.
+                chunk3 = Polyhedron(poly)
+                clipByVertexField(chunk3, [-x for x in field])
+                v3, c3 = moments(chunk3)
+                self.failUnless(fuzzyEqual(v2 + v3, v0), "Field clipping summing to wrong volumes: %g + %g != %g" % (v2, v3, v0))
+
+    #---------------------------------------------------------------------------
+    # clipByVertexField (nonlinear fields on convex polyhedra)
+    #---------------------------------------------------------------------------
+    def testClipByVertexFieldNonlinear(self):
+        for points, neighbors, facets in self.convexPolyData:
+            poly = Polyhedron()
+            initializePolyhedron(poly, points, neighbors)
+            v0, c0 = moments(poly)
+            xmin = min([min(p.x, p.y, p.z) for p in points])
+            xmax = max([max(p.x, p.y, p.z) for p in points])
+            for i in xrange(100):
+                p0 = Vector3d(rangen.uniform(xmin, xmax),
+                              rangen.uniform(xmin, xmax),
+                              rangen.uniform(xmin, xmax))
+                r = rangen.uniform(0.0, xmax - xmin)
+
+                # A sphere, and a saddle which can cut a face more than once.
+                # Both leave curved cut faces.
+                for field in ([r*r - (v.position - p0).magnitude2() for v in poly],
+                              [(v.position - p0).x*(v.position - p0).y +
+                               (v.position - p0).y*(v.position - p0).z - 0.1*r*r for v in poly]):
+                    chunk1 = Polyhedron(poly)
+                    chunk2 = Polyhedron(poly)
+                    clipByVertexField(chunk1, field)
+                    clipByVertexField(chunk2, [-x for x in field])
+                    v1, c1 = moments(chunk1)
+                    v2, c2 = moments(chunk2)
+                    self.failUnless(v1 <= v0*(1.0 + 1.0e-10) and v2 <= v0*(1.0 + 1.0e-10),
+                                    "Field clipping grew the polyhedron: %g %g > %g" % (v1, v2, v0))
+                    self.failUnless(fuzzyEqual(v1 + v2, v0), "Field clipping summing to wrong volumes: %g + %g != %g" % (v1, v2, v0))
+
+    #---------------------------------------------------------------------------
+    # clipMesh
+    #---------------------------------------------------------------------------
+    def testClipMesh(self):
+        # Two cubes sharing the face x = 10.
+        points = cube_points + [p + Vector3d(10, 0, 0) for p in cube_points if p.x > 0.0]
+        cellVertices = [range(8), [1, 8, 9, 2, 5, 10, 11, 6]]
+        cells = []
+        for ids in cellVertices:
+            cell = Polyhedron()
+            initializePolyhedron(cell, [points[i] for i in ids], cube_neighbors)
+            cells.append(cell)
+        for i in xrange(100):
+            p0 = Vector3d(rangen.uniform(0.0, 20.0),
+                          rangen.uniform(0.0, 10.0),
+                          rangen.uniform(0.0, 10.0))
+            phat = Vector3d(rangen.uniform(-1.0, 1.0),
+                            rangen.uniform(-1.0, 1.0),
+                            rangen.uniform(-1.0, 1.0)).unitVector()
+            plane = Plane3d(p0, phat)
+            clipped, ids, newPoints = clipMesh(cells, cellVertices, points, plane)
+            vol0 = 0.0
+            for cell in cells:
+                chunk = Polyhedron(cell)
+                clipPolyhedron(chunk, [plane])
+                vol0 += moments(chunk)[0]
+            vol1 = sum([moments(cell)[0] for cell in clipped])
+            self.failUnless(fuzzyEqual(vol1, vol0), "Volume mismatch: %g != %g" % (vol1, vol0))
+
+            # Every vertex sits exactly on its shared global point.
+            for cell, cellIDs in zip(clipped, ids):
+                self.failUnless(len(cell) == len(cellIDs), "Bad vertex IDs")
+                for v, j in zip(cell, cellIDs):
+                    self.failUnless(v.position == newPoints[j], "Vertex mismatch: %s != %s" % (v.position, newPoints[j]))
+
+        # A non-convex cell cut across its notch splits the same way as clipPolyhedron.
+        poly = Polyhedron()
+        initializePolyhedron(poly, notched_points, notched_neighbors)
+        for i in xrange(100):
+            plane = Plane3d(Vector3d(rangen.uniform(0.0, 4.0), 1.5, 0.5),
+                            Vector3d(rangen.uniform(-0.2, 0.2), 1.0, rangen.uniform(-0.2, 0.2)).unitVector())
+            clipped, ids, newPoints = clipMesh([poly], [range(len(notched_points))], notched_points, plane)
+            chunk = Polyhedron(poly)
+            clipPolyhedron(chunk, [plane])
+            self.failUnless(len(splitComponents(clipped[0])[0]) == len(splitComponents(chunk)[0]),
+                            "Component mismatch cutting notch with %s" % plane)
+
+        # A cell with two coincident vertices (a unit cube with a doubled
+        # edge) clips the same as clipPolyhedron.
+        n = 5
+        points = [Vector3d(x, y, z) for z in (0.0, 1.0) for (x, y) in [(0,0), (1,0), (1,0), (1,1), (0,1)]]
+        neighbors = ([[(i + 1) % n, i + n, (i - 1) % n] for i in xrange(n)] +
+                     [[(i + 1) % n + n, (i - 1) % n + n, i] for i in xrange(n)])
+        poly = Polyhedron()
+        initializePolyhedron(poly, points, neighbors)
+        plane = Plane3d(Vector3d(0.5, 0.0, 0.0), Vector3d(1.0, 0.0, 0.0))
+        clipped, ids, newPoints = clipMesh([poly], [range(len(points))], points, plane)
+        chunk = Polyhedron(poly)
+        clipPolyhedron(chunk, [plane])
+        self.failUnless(fuzzyEqual(moments(clipped[0])[0], 0.5) and fuzzyEqual(moments(chunk)[0], 0.5),
+                        "Volume mismatch: %g %g" % (moments(clipped[0])[0], moments(chunk)[0]))
+        self.failUnless(len(clipped[0]) == len(ids[0]) == len(chunk), "Bad vertex IDs: %s" % list(ids[0]))
+        for v, j in zip(clipped[0], ids[0]):
+            self.failUnless(v.position == newPoints[j], "Vertex mismatch: %s != %s" % (v.position, newPoints[j]))
+
+    #---------------------------------------------------------------------------
+    # assembleMesh matches the shared face of independently clipped cells
+    #---------------------------------------------------------------------------
+    def testAssembleMesh(self):
+        # Two cubes sharing the face x = 10, each cut independently by the
+        # same plane.
+        cells0 = []
+        for x0 in (0.0, 10.0):
+            cell = Polyhedron()
+            initializePolyhedron(cell, [Vector3d(x0 + p.x, p.y, p.z) for p in cube_points], cube_neighbors)
+            cells0.append(cell)
+        for i in xrange(100):
+            plane = Plane3d(Vector3d(0.0, 0.0, rangen.uniform(1.0, 9.0)), Vector3d(0.0, 0.0, 1.0))
+            cells = []
+            for cell in cells0:
+                chunk = Polyhedron(cell)
+                clipPolyhedron(chunk, [plane])
+                cells.append(chunk)
+            mesh = assembleMesh(cells, 1.0e-8)
+            self.failUnless(mesh.numCells() == 2, "Bad number of cells: %i" % mesh.numCells())
+            self.failUnless(len(mesh.points) == 12, "Bad number of points: %i" % len(mesh.points))
+            self.failUnless(mesh.numFaces() == 11, "Bad number of faces: %i" % mesh.numFaces())
+            interior = [f for f in xrange(mesh.numFaces()) if mesh.faceCells[2*f + 1] != -1]
+            self.failUnless(len(interior) == 1, "Bad number of interior faces: %i" % len(interior))
+            f = interior[0]
+            self.failUnless(mesh.faceCells[2*f] == 0 and mesh.faceCells[2*f + 1] == 1,
+                            "Bad interior face cells: %s" % list(mesh.faceCells[2*f:2*f + 2]))
+            self.failUnless(~f in mesh.cellFaces[mesh.cellFaceOffsets[1]:mesh.cellFaceOffsets[2]],
+                            "Interior face not shared")
+
+    #---------------------------------------------------------------------------
+    # weldVertices makes shared vertices with roundoff bit-identical
+    #---------------------------------------------------------------------------
+    def testWeldVertices(self):
+        # Two cubes sharing the face x = 10, with roundoff in the second.
+        for i in xrange(100):
+            polys = []
+            for x0 in (0.0, 10.0):
+                poly = Polyhedron()
+                initializePolyhedron(poly, [Vector3d(x0 + p.x + rangen.uniform(-1.0e-12, 1.0e-12),
+                                                     p.y + rangen.uniform(-1.0e-12, 1.0e-12),
+                                                     p.z + rangen.uniform(-1.0e-12, 1.0e-12)) for p in cube_points],
+                                     cube_neighbors)
+                polys.append(poly)
+            welded, classes = weldVertices(polys, 1.0e-8)
+            self.failUnless(len(set(classes[0] + classes[1])) == 12, "Bad vertex classes: %s" % classes)
+            for j, k in [(1, 0), (2, 3), (5, 4), (6, 7)]:
+                self.failUnless(classes[0][j] == classes[1][k], "Shared vertices not welded: %s" % classes)
+                self.failUnless(welded[0][j].position == welded[1][k].position, "Shared positions not identical")
+
+    #---------------------------------------------------------------------------
+    # weldVertices does not chain a run of vertices each within tol of the next
+    #---------------------------------------------------------------------------
+    def testWeldVerticesNoChaining(self):
+        tol = 1.0e-8
+        polys = []
+        for i in xrange(10):
+            poly = Polyhedron()
+            initializePolyhedron(poly, [p + Vector3d(0.6*tol*i, 0.0, 0.0) for p in cube_points], cube_neighbors)
+            polys.append(poly)
+        welded, classes = weldVertices(polys, tol)
+        for i in xrange(10):
+            for j in xrange(len(cube_points)):
+                self.failUnless((welded[i][j].position - polys[i][j].position).magnitude() < tol,
+                                "Vertex moved too far: %s -> %s" % (polys[i][j].position, welded[i][j].position))
+        self.failUnless(len(set(sum(classes, []))) > len(cube_points),
+                        "Vertices chained into too few classes: %s" % classes)
+
+    #---------------------------------------------------------------------------
+    # simplifyPlanes merges near duplicates and drops missing planes
+    #---------------------------------------------------------------------------
+    def testSimplifyPlanes(self):
+        poly = Polyhedron()
+        initializePolyhedron(poly, cube_points, cube_neighbors)
+        for i in xrange(100):
+            # Random planes, with a near duplicate of each and one plane that
+            # misses the cube.
+            planes = []
+            for j in xrange(5):
+                p0 = Vector3d(rangen.uniform(0.0, 10.0),
+                              rangen.uniform(0.0, 10.0),
+                              rangen.uniform(0.0, 10.0))
+                phat = Vector3d(rangen.uniform(-1.0, 1.0),
+                                rangen.uniform(-1.0, 1.0),
+                                rangen.uniform(-1.0, 1.0)).unitVector()
+                planes.append(Plane3d(p0, phat, j))
+                planes.append(Plane3d(p0 + 1.0e-12*phat, phat, 10 + j))
+            planes.append(Plane3d(Vector3d(-1.0, 0.0, 0.0), Vector3d(1.0, 0.0, 0.0), 20))
+            result, planeMap = simplifyPlanes(poly, planes, 1.0e-8)
+            self.failUnless(len(planeMap) == len(planes), "Bad plane map size")
+            self.failUnless(len(result) <= 5, "Too many planes: %i" % len(result))
+            self.failUnless(planeMap[-1] == -1, "Redundant plane kept")
+            for j in xrange(5):
+                self.failUnless(planeMap[2*j] == planeMap[2*j + 1], "Coplanar planes not merged")
+            chunk0 = Polyhedron(poly)
+            clipPolyhedron(chunk0, planes)
+            chunk1 = Polyhedron(poly)
+            clipPolyhedron(chunk1, result)
+            vol0, vol1 = moments(chunk0)[0], moments(chunk1)[0]
+            if vol0 > 0.0:
+                self.failUnless(fuzzyEqual(vol1, vol0), "Volume mismatch: %g != %g" % (vol1, vol0))
+
+    #---------------------------------------------------------------------------
+    # intersectsHalfspaces agrees with clipping
+    #---------------------------------------------------------------------------
+    def testIntersectsHalfspaces(self):
+        poly = Polyhedron()
+        initializePolyhedron(poly, cube_points, cube_neighbors)
+        for i in xrange(1000):
+            planes = []
+            for j in xrange(1 + i % 4):
+                p0 = Vector3d(rangen.uniform(-5.0, 15.0),
+                              rangen.uniform(-5.0, 15.0),
+                              rangen.uniform(-5.0, 15.0))
+                phat = Vector3d(rangen.uniform(-1.0, 1.0),
+                                rangen.uniform(-1.0, 1.0),
+                                rangen.uniform(-1.0, 1.0)).unitVector()
+                planes.append(Plane3d(p0, phat, j))
+            chunk = Polyhedron(poly)
+            clipPolyhedron(chunk, planes)
+            vol = moments(chunk)[0]
+            if vol == 0.0 or vol > 1.0e-6:
+                self.failUnless(intersectsHalfspaces(poly, planes) == (vol > 0.0),
+                                "Bad intersection test for %s: %g" % (planes, vol))
+
+    #---------------------------------------------------------------------------
+    # convexOverlap agrees with clipping one convex polyhedron by the other
+    #---------------------------------------------------------------------------
+    def testConvexOverlap(self):
+        poly = Polyhedron()
+        initializePolyhedron(poly, cube_points, cube_neighbors)
+        a = facePlanes(poly)
+        for i in xrange(1000):
+            # A randomly shifted copy of the cell, clipped by a random plane.
+            delta = Vector3d(rangen.uniform(-15.0, 15.0),
+                             rangen.uniform(-15.0, 15.0),
+                             rangen.uniform(-15.0, 15.0))
+            other = Polyhedron()
+            initializePolyhedron(other, [p + delta for p in cube_points], cube_neighbors)
+            p0 = Vector3d(rangen.uniform(0.0, 10.0),
+                          rangen.uniform(0.0, 10.0),
+                          rangen.uniform(0.0, 10.0)) + delta
+            phat = Vector3d(rangen.uniform(-1.0, 1.0),
+                            rangen.uniform(-1.0, 1.0),
+                            rangen.uniform(-1.0, 1.0)).unitVector()
+            clipPolyhedron(other, [Plane3d(p0, phat)])
+            if len(other) == 0:
+                continue
+            b = facePlanes(other)
+            overlap, bound = convexOverlap(a, b)
+            chunk = Polyhedron(poly)
+            clipPolyhedron(chunk, b.planes)
+            vol = moments(chunk)[0]
+            self.failUnless(bound >= vol*(1.0 - 1.0e-10), "Bad volume bound: %g < %g" % (bound, vol))
+            if vol == 0.0 or vol > 1.0e-6:
+                self.failUnless(overlap == (vol > 0.0),
+                                "Bad overlap test: %s != %g" % (overlap, vol))
+
+    #---------------------------------------------------------------------------
+    # containsPoints and signedDistances on the notched polyhedron
+    #---------------------------------------------------------------------------
+    def testContainsPoints(self):
+        # The notched polyhedron is the notched polygon extruded 0 < z < 1.
+        def insideNotched(x, y, z):
+            return 0.0 < x < 4.0 and 0.0 < y < min(2.0, abs(x - 2.0) + 1.0) and 0.0 < z < 1.0
+        poly = Polyhedron()
+        initializePolyhedron(poly, notched_points, notched_neighbors)
+        cell = facePlanes(poly)
+        self.failUnless(not cell.convex, "Notched polyhedron should not be convex")
+        x = [rangen.uniform(-1.0, 5.0) for i in xrange(1000)]
+        y = [rangen.uniform(-1.0, 3.0) for i in xrange(1000)]
+        z = [rangen.uniform(-1.0, 2.0) for i in xrange(1000)]
+        inside = containsPoints(cell, x, y, z)
+        dist = signedDistances(cell, x, y, z)
+        for i in xrange(1000):
+            if abs(dist[i]) > 1.0e-8:
+                self.failUnless(bool(inside[i]) == insideNotched(x[i], y[i], z[i]),
+                                "Bad containment for (%g, %g, %g)" % (x[i], y[i], z[i]))
+                self.failUnless((dist[i] > 0.0) == insideNotched(x[i], y[i], z[i]),
+                                "Bad distance sign for (%g, %g, %g): %g" % (x[i], y[i], z[i], dist[i]))
+
+        # Outside the cube along an axis the distance is to the nearest face.
+        poly = Polyhedron()
+        initializePolyhedron(poly, cube_points, cube_neighbors)
+        cell = facePlanes(poly)
+        self.failUnless(cell.convex, "Cube should be convex")
+        x = [rangen.uniform(0.0, 10.0) for i in xrange(1000)]
+        y = [rangen.uniform(0.0, 10.0) for i in xrange(1000)]
+        z = [rangen.uniform(10.0, 20.0) for i in xrange(1000)]
+        dist = signedDistances(cell, x, y, z)
+        for i in xrange(1000):
+            self.failUnless(fuzzyEqual(dist[i], 10.0 - z[i], 1.0e-10),
+                            "Distance mismatch: %g != %g" % (dist[i], 10.0 - z[i]))
+
+    #---------------------------------------------------------------------------
+    # polyhedronFromHalfspaces matches clipping the bounding cube
+    #---------------------------------------------------------------------------
+    def testPolyhedronFromHalfspaces(self):
+        # Bisector planes of random neighbors around a point, like a Voronoi
+        # cell, bounded by the cube.
+        box = Polyhedron()
+        initializePolyhedron(box, cube_points, cube_neighbors)
+        boxPlanes = [Plane3d(Vector3d(0, 0, 0), Vector3d(1, 0, 0), 100),
+                     Plane3d(Vector3d(10, 0, 0), Vector3d(-1, 0, 0), 101),
+                     Plane3d(Vector3d(0, 0, 0), Vector3d(0, 1, 0), 102),
+                     Plane3d(Vector3d(0, 10, 0), Vector3d(0, -1, 0), 103),
+                     Plane3d(Vector3d(0, 0, 0), Vector3d(0, 0, 1), 104),
+                     Plane3d(Vector3d(0, 0, 10), Vector3d(0, 0, -1), 105)]
+        for i in xrange(100):
+            p0 = Vector3d(rangen.uniform(2.0, 8.0),
+                          rangen.uniform(2.0, 8.0),
+                          rangen.uniform(2.0, 8.0))
+            planes = list(boxPlanes)
+            for j in xrange(100):
+                pj = p0 + rangen.uniform(0.5, 5.0)*Vector3d(rangen.uniform(-1.0, 1.0),
+                                                            rangen.uniform(-1.0, 1.0),
+                                                            rangen.uniform(-1.0, 1.0)).unitVector()
+                planes.append(Plane3d(0.5*(p0 + pj), (p0 - pj).unitVector(), j))
+            poly = Polyhedron()
+            polyhedronFromHalfspaces(poly, planes, p0)
+            chunk = Polyhedron(box)
+            clipPolyhedron(chunk, planes)
+            vol0, centroid0 = moments(chunk)
+            vol1, centroid1 = moments(poly)
+            self.failUnless(fuzzyEqual(vol1, vol0), "Volume mismatch: %g != %g" % (vol1, vol0))
+            self.failUnless(fuzzyEqual((centroid1 - centroid0).magnitude(), 0.0),
+                            "Centroid mismatch: %s != %s" % (centroid1, centroid0))
+            for v in poly:
+                self.failUnless(len(v.clips) >= 3, "Bad clips: %s" % list(v.clips))
+
+    #---------------------------------------------------------------------------
+    # convexHull of random points in the cube
+    #---------------------------------------------------------------------------
+    def testConvexHull(self):
+        for i in xrange(100):
+            # Random points in the cube, plus its corners.
+            points = [Vector3d(rangen.uniform(0.0, 10.0),
+                               rangen.uniform(0.0, 10.0),
+                               rangen.uniform(0.0, 10.0)) for j in xrange(100)] + cube_points
+            poly = Polyhedron()
+            convexHull(poly, points)
+            self.failUnless(len(poly) == 8, "Bad number of hull vertices: %i" % len(poly))
+            vol, centroid = moments(poly)
+            self.failUnless(fuzzyEqual(vol, 1000.0), "Volume mismatch: %g != 1000" % vol)
+            self.failUnless(len(extractFaces(poly)) == 6, "Bad number of faces")
+            for v in poly:
+                self.failUnless(v.position == points[v.ID], "Bad vertex ID: %i" % v.ID)
+
 if __name__ == "__main__":
     unittest.main()